@@ -0,0 +1,396 @@
+/**
+ * A headless frame-time benchmark for `Cosmos` and `Plane`.
+ *
+ * No window system or GPU is required, the universe is created on SDL's `dummy` video driver,
+ *   whose "window" is nothing but a surface in memory rendered by the software renderer.
+ *
+ * Build it along with the library sources, say,
+ *   c++ -std=c++17 -O2 -D__lambda__= benchmark/frame.cpp <library sources> \
+ *       $(pkg-config --cflags --libs sdl2 SDL2_ttf SDL2_image SDL2_mixer) -o frame-benchmark
+ *
+ * Usage:
+ *   frame-benchmark [--frames 600] [--warmup 60] [--width 1200] [--height 800] [--fps 60]
+ *                   [--sprites 64] [--sheets 32] [--atlases 2] [--labels 32] [--shapes 64]
+ *
+ * The report is a JSON object written to stdout, times are in microseconds,
+ *   `draw` is the bare `Cosmos::draw()`, and `refresh` is the complete redraw-and-present.
+ */
+
+#include "../cosmos.hpp"
+#include "../plane.hpp"
+
+#include "../graphics/image.hpp"
+#include "../physics/color/names.hpp"
+#include "../matter/atlas.hpp"
+#include "../matter/sprite/folder.hpp"
+#include "../matter/sprite/sheet.hpp"
+#include "../matter/graphlet/shapelet.hpp"
+#include "../matter/graphlet/textlet.hpp"
+
+#include <atomic>
+#include <random>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <filesystem>
+#include <algorithm>
+
+using namespace Plteen;
+using namespace std::filesystem;
+
+/*************************************************************************************************/
+static std::atomic<uint64_t> allocation_count(0U);
+
+void* operator new(size_t size) {
+    void* ptr = std::malloc((size > 0U) ? size : 1U);
+
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    allocation_count.fetch_add(1U, std::memory_order_relaxed);
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, [[maybe_unused]] size_t size) noexcept { std::free(ptr); }
+
+/*************************************************************************************************/
+namespace {
+    struct BenchmarkConfig {
+        int frames = 600;
+        int warmup = 60;
+        int width = 1200;
+        int height = 800;
+        int fps = 60;
+        int sprites = 64;
+        int sheets = 32;
+        int atlases = 2;
+        int labels = 32;
+        int shapes = 64;
+        int glide_period = 45;
+
+        std::string costume_dir;
+        std::string sheet_png;
+    };
+
+    struct Samples {
+        std::vector<double> elapse;
+        std::vector<double> draw;
+        std::vector<double> refresh;
+        std::vector<double> allocations;
+    };
+
+    /*********************************************************************************************/
+    class BenchmarkAtlas : public GridAtlas {
+    public:
+        BenchmarkAtlas(const std::string& png, int map_row, int map_col) : GridAtlas(png, 4, 4) {
+            this->create_map_grid(map_row, map_col);
+        }
+
+    protected:
+        int get_atlas_tile_index(size_t map_idx, int& xoff, int& yoff) override {
+            return int(map_idx % this->atlas_tile_count());
+        }
+    };
+
+    class BenchmarkPlane : public Plane {
+    public:
+        BenchmarkPlane(const BenchmarkConfig* config) : Plane("Frame Benchmark"), config(config), prng(20240517U) {}
+
+    public:
+        void load(float width, float height) override {
+            for (int idx = 0; idx < this->config->atlases; idx ++) {
+                this->insert(new BenchmarkAtlas(this->config->sheet_png, 24, 32), this->random_position(width, height));
+            }
+
+            for (int idx = 0; idx < this->config->shapes; idx ++) {
+                if ((idx % 2) == 0) {
+                    this->shapes.push_back(this->insert(new Circlet(this->random_real(4.0F, 24.0F), this->random_color())));
+                } else {
+                    this->shapes.push_back(this->insert(new Rectanglet(this->random_real(8.0F, 48.0F), this->random_color(), BLACK)));
+                }
+            }
+
+            for (int idx = 0; idx < this->config->sprites; idx ++) {
+                this->sprites.push_back(this->insert(new Sprite(this->config->costume_dir)));
+            }
+
+            for (int idx = 0; idx < this->config->sheets; idx ++) {
+                this->sheets.push_back(this->insert(new SpriteGridSheet(this->config->sheet_png, 4, 4)));
+            }
+
+            for (int idx = 0; idx < this->config->labels; idx ++) {
+                this->labels.push_back(this->insert(new Labellet(GameFont::monospace(), GHOSTWHITE, "label %d", idx)));
+            }
+        }
+
+        void reflow(float width, float height) override {
+            for (IShapelet* shape : this->shapes) {
+                this->move_to(shape, this->random_position(width, height));
+            }
+
+            for (Sprite* sprite : this->sprites) {
+                this->move_to(sprite, this->random_position(width, height));
+            }
+
+            for (SpriteGridSheet* sheet : this->sheets) {
+                this->move_to(sheet, this->random_position(width, height));
+            }
+
+            for (size_t idx = 0; idx < this->labels.size(); idx ++) {
+                this->move_to(this->labels[idx], this->random_position(width, height));
+            }
+        }
+
+        void on_mission_start(float width, float height) override {
+            for (Sprite* sprite : this->sprites) {
+                sprite->set_border_strategy(BorderStrategy::BOUNCE);
+                sprite->set_velocity(this->random_real(1.0F, 4.0F), this->random_real(0.0F, 360.0F));
+                sprite->play_all();
+            }
+
+            for (size_t idx = 0; idx < this->shapes.size(); idx ++) {
+                if ((idx % 4) == 0) {
+                    this->shapes[idx]->set_border_strategy(BorderStrategy::BOUNCE);
+                    this->shapes[idx]->set_velocity(this->random_real(0.5F, 2.0F), this->random_real(0.0F, 360.0F));
+                }
+            }
+
+            for (SpriteGridSheet* sheet : this->sheets) {
+                sheet->play_all();
+            }
+        }
+
+        void update(uint64_t count, uint32_t interval, uint64_t uptime) override {
+            if ((count % uint64_t(this->config->glide_period)) == 1U) {
+                double sec = double(this->config->glide_period) / double(this->config->fps) * 0.8;
+
+                for (SpriteGridSheet* sheet : this->sheets) {
+                    this->glide_to_random_location(sec, sheet);
+                }
+            }
+
+            if (!this->labels.empty()) {
+                this->labels[0]->set_text(MatterPort::LT, "frame %llu", (unsigned long long)(count));
+            }
+        }
+
+    private:
+        Position random_position(float width, float height) {
+            return Position(this->random_real(0.0F, width * 0.9F), this->random_real(0.0F, height * 0.9F));
+        }
+
+        float random_real(float min, float max) {
+            return std::uniform_real_distribution<float>(min, max)(this->prng);
+        }
+
+        RGBA random_color() {
+            return RGBA(uint32_t(this->prng() & 0xFFFFFFU));
+        }
+
+    private:
+        std::vector<IShapelet*> shapes;
+        std::vector<Sprite*> sprites;
+        std::vector<SpriteGridSheet*> sheets;
+        std::vector<Labellet*> labels;
+
+    private:
+        const BenchmarkConfig* config;
+        std::mt19937 prng;
+    };
+
+    /*********************************************************************************************/
+    class FrameBenchmark : public Cosmos {
+    public:
+        FrameBenchmark(const BenchmarkConfig* config) : Cosmos(config->fps), config(config) {}
+
+    public:
+        void construct(int argc, char* argv[]) override {
+            this->push_plane(new BenchmarkPlane(this->config));
+        }
+
+        void run(Samples* samples) {
+            uint32_t interval = 1000U / uint32_t(this->config->fps);
+            uint64_t uptime = SDL_GetTicks64();
+            double frequency = double(SDL_GetPerformanceFrequency());
+            dc_t* dc = this->drawing_context();
+            int width, height;
+
+            /* what `big_bang()` does before entering the main loop */
+            this->set_window_size(this->config->width, this->config->height, false);
+            this->feed_window_size(&width, &height);
+            this->begin_update_sequence();
+            this->on_big_bang(width, height);
+            this->on_resize(width, height);
+            this->on_game_start();
+            this->notify_updated();
+            this->end_update_sequence();
+
+            for (int frame = 1; frame <= this->config->warmup + this->config->frames; frame ++) {
+                uint64_t alloc0 = allocation_count.load(std::memory_order_relaxed);
+                uint64_t t0, t1, t2, t3;
+
+                uptime += interval;
+
+                t0 = SDL_GetPerformanceCounter();
+                this->on_elapse(uint64_t(frame), interval, uptime);
+                t1 = SDL_GetPerformanceCounter();
+                dc->reset(this->get_foreground_color(), this->get_background_color());
+                this->draw(dc, 0, 0, width, height);
+                t2 = SDL_GetPerformanceCounter();
+                this->refresh();
+                t3 = SDL_GetPerformanceCounter();
+
+                if (frame > this->config->warmup) {
+                    samples->elapse.push_back(double(t1 - t0) * 1000000.0 / frequency);
+                    samples->draw.push_back(double(t2 - t1) * 1000000.0 / frequency);
+                    samples->refresh.push_back(double(t3 - t2) * 1000000.0 / frequency);
+                    samples->allocations.push_back(double(allocation_count.load(std::memory_order_relaxed) - alloc0));
+                }
+            }
+        }
+
+    private:
+        const BenchmarkConfig* config;
+    };
+}
+
+/*************************************************************************************************/
+static void parse_options(BenchmarkConfig* config, int argc, char* argv[]) {
+    for (int idx = 1; idx + 1 < argc; idx += 2) {
+        const char* opt = argv[idx];
+        int value = std::atoi(argv[idx + 1]);
+
+        if (strcmp(opt, "--frames") == 0) {
+            config->frames = std::max(value, 1);
+        } else if (strcmp(opt, "--warmup") == 0) {
+            config->warmup = std::max(value, 0);
+        } else if (strcmp(opt, "--width") == 0) {
+            config->width = std::max(value, 1);
+        } else if (strcmp(opt, "--height") == 0) {
+            config->height = std::max(value, 1);
+        } else if (strcmp(opt, "--fps") == 0) {
+            config->fps = std::max(value, 1);
+        } else if (strcmp(opt, "--sprites") == 0) {
+            config->sprites = std::max(value, 0);
+        } else if (strcmp(opt, "--sheets") == 0) {
+            config->sheets = std::max(value, 0);
+        } else if (strcmp(opt, "--atlases") == 0) {
+            config->atlases = std::max(value, 0);
+        } else if (strcmp(opt, "--labels") == 0) {
+            config->labels = std::max(value, 0);
+        } else if (strcmp(opt, "--shapes") == 0) {
+            config->shapes = std::max(value, 0);
+        } else {
+            fprintf(stderr, "ignored unknown option: %s\n", opt);
+        }
+    }
+}
+
+static void save_block_png(const std::string& pathname, int width, int height, int row, int col) {
+    SDL_Surface* png = game_formatted_surface(width, height, SDL_PIXELFORMAT_RGBA8888);
+    int tw = width / col;
+    int th = height / row;
+
+    for (int r = 0; r < row; r ++) {
+        for (int c = 0; c < col; c ++) {
+            SDL_Rect tile = { c * tw + 1, r * th + 1, tw - 2, th - 2 };
+            uint8_t shade = uint8_t(255 * (r * col + c + 1) / (row * col));
+
+            SDL_FillRect(png, &tile, SDL_MapRGBA(png->format, shade, uint8_t(255 - shade), 128, 255));
+        }
+    }
+
+    game_save_image(png, pathname);
+    SDL_FreeSurface(png);
+}
+
+/**
+ * Assets are generated on the fly, so that the benchmark depends on nothing in the disk.
+ */
+static void prepare_assets(BenchmarkConfig* config) {
+    path rootdir = temp_directory_path() / "plteen-frame-benchmark";
+    path costumes = rootdir / "costume";
+
+    create_directories(costumes);
+
+    for (int idx = 0; idx < 4; idx ++) {
+        save_block_png((costumes / ("c" + std::to_string(idx) + ".png")).string(), 48, 48, 1 + idx, 1 + idx);
+    }
+
+    config->costume_dir = costumes.string();
+    config->sheet_png = (rootdir / "sheet.png").string();
+    save_block_png(config->sheet_png, 128, 128, 4, 4);
+}
+
+static double percentile(std::vector<double>& samples, double p) {
+    double v = 0.0;
+
+    if (!samples.empty()) {
+        size_t rank = size_t(p * double(samples.size() - 1U) + 0.5);
+
+        std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+        v = samples[rank];
+    }
+
+    return v;
+}
+
+static double mean(const std::vector<double>& samples) {
+    double sum = 0.0;
+
+    for (double s : samples) {
+        sum += s;
+    }
+
+    return samples.empty() ? 0.0 : (sum / double(samples.size()));
+}
+
+static void report_stats(const char* name, std::vector<double>& samples, bool last) {
+    double avg = mean(samples);
+    double p50 = percentile(samples, 0.50);
+    double p95 = percentile(samples, 0.95);
+    double p99 = percentile(samples, 0.99);
+    double max = samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+
+    printf("    \"%s\": { \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f }%s\n",
+        name, avg, p50, p95, p99, max, (last ? "" : ","));
+}
+
+/*************************************************************************************************/
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    Samples samples;
+
+    parse_options(&config, argc, argv);
+
+    /* must be set before the universe initializes SDL */
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+
+    FrameBenchmark universe(&config);
+
+    prepare_assets(&config);
+    universe.construct(argc, argv);
+    universe.run(&samples);
+
+    printf("{\n");
+    printf("  \"config\": { \"frames\": %d, \"warmup\": %d, \"width\": %d, \"height\": %d, \"fps\": %d,"
+            " \"sprites\": %d, \"sheets\": %d, \"atlases\": %d, \"labels\": %d, \"shapes\": %d },\n",
+        config.frames, config.warmup, config.width, config.height, config.fps,
+        config.sprites, config.sheets, config.atlases, config.labels, config.shapes);
+    printf("  \"unit\": \"us\",\n");
+    printf("  \"stats\": {\n");
+    report_stats("on_elapse", samples.elapse, false);
+    report_stats("draw", samples.draw, false);
+    report_stats("refresh", samples.refresh, false);
+    report_stats("allocations_per_frame", samples.allocations, true);
+    printf("  }\n");
+    printf("}\n");
+
+    return 0;
+}
@@ -171,6 +171,30 @@ void Plteen::Cosmos::on_elapse(uint64_t count, uint32_t interval, uint64_t uptim
     this->end_update_sequence();
 }
 
+bool Plteen::Cosmos::is_quiescent(uint64_t uptime, uint64_t* wakeup) {
+    bool quiescent = true;
+
+    // NOTE: only the current plane is updated
+    
+    if (this->recent_plane != nullptr) {
+        quiescent = this->recent_plane->is_quiescent(uptime, wakeup);
+    }
+
+    return quiescent;
+}
+
+bool Plteen::Cosmos::notify_interpolated() {
+    bool moving = false;
+
+    // NOTE: only the current plane is updated
+    
+    if (this->recent_plane != nullptr) {
+        moving = this->recent_plane->notify_interpolated();
+    }
+
+    return moving;
+}
+
 void Plteen::Cosmos::draw(dc_t* dc, int x, int y, int width, int height) {
     float flx = float(x);
     float fly = float(y);
@@ -16,6 +16,8 @@ namespace Plteen {
         void draw(Plteen::dc_t* dc, int x, int y, int width, int height) override;
         bool has_current_mission_completed();
         bool can_exit() override;
+        bool is_quiescent(uint64_t uptime, uint64_t* wakeup) override;
+        bool notify_interpolated() override;
 
     public:
         void transfer(int delta_idx);
@@ -1,10 +1,30 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstdint>
+#include <string>
 
 namespace Plteen {
     template <typename T>
     inline void hash_combine (size_t& seed, const T& val) {
         seed ^= std::hash<T>()(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
+
+    /** NOTE
+     * FNV-1a, unlike `std::hash`, is stable among runs and platforms,
+     *   hence suitable for naming and checking files on disk.
+     */
+    inline uint64_t fnv1a_hash(const void* data, size_t size, uint64_t seed = 0xCBF29CE484222325ULL) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        for (size_t idx = 0U; idx < size; idx ++) {
+            seed = (seed ^ bytes[idx]) * 0x100000001B3ULL;
+        }
+
+        return seed;
+    }
+
+    inline uint64_t fnv1a_hash(const std::string& str, uint64_t seed = 0xCBF29CE484222325ULL) {
+        return fnv1a_hash(str.data(), str.size(), seed);
+    }
 }
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Plteen {
+    /** NOTE
+     * A hierarchical timing wheel of 4 levels, each of which has 64 slots,
+     *   an entry lives in the level whose block is the first one its due time differs from now,
+     *   and moves down level by level as time goes by, until it falls into the exact slot of level 0.
+     *
+     * Advancing jumps from an occupied slot to the next one,
+     *   so that it costs nothing even if the time goes far ahead, say, after sleeping for a long while.
+     * Entries that are too far away to fit in the wheel wait in an overflow list,
+     *   and are redistributed every time the top level rotates.
+     *
+     * Entries cannot be cancelled, clients are supposed to tell the stale ones themselves.
+     */
+    template<typename T>
+    class TimingWheel {
+    public:
+        TimingWheel(uint64_t now = 0U) : current(now) {}
+
+    public:
+        uint64_t now() const { return this->current; }
+        size_t size() const { return this->count; }
+        bool empty() const { return this->count == 0U; }
+
+        void clear() {
+            for (size_t l = 0U; l < LEVELS; l ++) {
+                for (size_t s = 0U; s < SLOTS; s ++) {
+                    this->slots[l][s].clear();
+                }
+
+                this->bitmaps[l] = 0U;
+            }
+
+            this->overflow.clear();
+            this->count = 0U;
+        }
+
+        void insert(uint64_t due, const T& datum) {
+            this->place(Entry { ((due < this->current) ? this->current : due), datum });
+            this->count += 1U;
+        }
+
+        /**
+         * Returns the time of the next thing to do, which is either firing entries or moving entries down,
+         *   or `UINT64_MAX` if the wheel is empty.
+         */
+        uint64_t next_expiry(size_t* level = nullptr) const {
+            uint64_t t = UINT64_MAX;
+            size_t found = LEVELS;
+
+            for (size_t l = 0U; (l < LEVELS) && (found == LEVELS); l ++) {
+                size_t shift = BITS * l;
+                size_t idx = size_t(this->current >> shift) & MASK;
+                uint64_t rest = (l == 0U) ? (~0ULL << idx) : ((idx == MASK) ? 0U : (~0ULL << (idx + 1U)));
+                uint64_t occupied = this->bitmaps[l] & rest;
+
+                if (occupied != 0U) {
+                    uint64_t block = (this->current >> (shift + BITS)) << (shift + BITS);
+
+                    t = block | (uint64_t(lowest_bit(occupied)) << shift);
+                    found = l;
+                }
+            }
+
+            if ((found == LEVELS) && !this->overflow.empty()) {
+                t = ((this->current >> SPAN) + 1U) << SPAN;
+            }
+
+            if (level != nullptr) {
+                (*level) = found;
+            }
+
+            return t;
+        }
+
+        /**
+         * Moves time forward to `to` inclusively, and appends all the entries due to `fired` in order of time.
+         */
+        void advance(uint64_t to, std::vector<T>& fired) {
+            size_t level = LEVELS;
+            uint64_t t = this->next_expiry(&level);
+
+            while ((this->count > 0U) && (t <= to)) {
+                this->current = t;
+
+                if (level == 0U) {
+                    std::vector<Entry>& slot = this->slots[0][size_t(t) & MASK];
+
+                    for (Entry& e : slot) {
+                        fired.push_back(e.datum);
+                    }
+
+                    this->count -= slot.size();
+                    slot.clear();
+                    this->bitmaps[0] &= ~(1ULL << (size_t(t) & MASK));
+                    this->current = t + 1U;
+                }
+
+                this->cascade();
+                t = this->next_expiry(&level);
+            }
+
+            if (this->current <= to) {
+                this->current = to + 1U;
+                this->cascade();
+            }
+        }
+
+    private:
+        struct Entry {
+            uint64_t due;
+            T datum;
+        };
+
+    private:
+        static size_t lowest_bit(uint64_t bits) {
+            size_t idx = 0U;
+
+            while ((bits & 1U) == 0U) {
+                bits >>= 1U;
+                idx ++;
+            }
+
+            return idx;
+        }
+
+    private:
+        void place(const Entry& e) {
+            uint64_t diff = e.due ^ this->current;
+            size_t level = 0U;
+
+            while ((level < LEVELS) && ((diff >> (BITS * (level + 1U))) != 0U)) {
+                level ++;
+            }
+
+            if (level < LEVELS) {
+                size_t idx = size_t(e.due >> (BITS * level)) & MASK;
+
+                this->slots[level][idx].push_back(e);
+                this->bitmaps[level] |= (1ULL << idx);
+            } else {
+                this->overflow.push_back(e);
+            }
+        }
+
+        void cascade() {
+            /* redistributes the blocks that `current` just enters, top level first */
+
+            if (((this->current & ((1ULL << SPAN) - 1U)) == 0U) && !this->overflow.empty()) {
+                std::vector<Entry> pending;
+
+                pending.swap(this->overflow);
+
+                for (Entry& e : pending) {
+                    this->place(e);
+                }
+            }
+
+            for (size_t l = LEVELS - 1U; l > 0U; l --) {
+                size_t shift = BITS * l;
+
+                if ((this->current & ((1ULL << shift) - 1U)) == 0U) {
+                    size_t idx = size_t(this->current >> shift) & MASK;
+
+                    if ((this->bitmaps[l] & (1ULL << idx)) != 0U) {
+                        std::vector<Entry> pending;
+
+                        pending.swap(this->slots[l][idx]);
+                        this->bitmaps[l] &= ~(1ULL << idx);
+
+                        for (Entry& e : pending) {
+                            this->place(e);
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        static const size_t LEVELS = 4U;
+        static const size_t BITS = 6U;
+        static const size_t SLOTS = 64U;
+        static const size_t MASK = 63U;
+        static const size_t SPAN = 24U; // BITS * LEVELS
+
+    private:
+        std::vector<Entry> slots[LEVELS][SLOTS];
+        std::vector<Entry> overflow;
+        uint64_t bitmaps[LEVELS] = {};
+        uint64_t current;
+        size_t count = 0U;
+    };
+}
@@ -7,24 +7,354 @@
 #include "../datum/box.hpp"
 
 #include "image.hpp"
+#include "texture.hpp"
 
 #include <SDL2/SDL2_gfxPrimitives.h>
 
+#include <vector>
+#include <tuple>
+#include <map>
+#include <atomic>
+
 using namespace Plteen;
 
 /**************************************************************************************************/
 #define FILL_BOX(box, px, py, width, height) { box.x = px; box.y = py; box.w = width; box.h = height; }
 
-static void pen_draw_circle(SDL_Renderer* renderer, int cx, int cy, int radius) {
+static const int GRID_TEXTURE_MAX_EXTENT = 4096;
+static const size_t GRID_TEXTURE_CACHE_CAPACITY = 8U;
+
+namespace Plteen {
+    enum class DrawCommandType { Copy, FillRects, DrawRects, Lines, Points, Triangles };
+
+    struct TextureCopy {
+        SDL_Rect src;
+        SDL_FRect dst;
+        double angle;
+        SDL_RendererFlip flip;
+    };
+
+    /** NOTE
+     * A command covers a run of consecutive primitives that share the same states,
+     *   `color` is the draw color for shapes, and the color and alpha modulation for textures,
+     *   both of which are captured when recording since clients may change them before flushing.
+     *
+     * A `Lines` command is a polyline, consecutive segments are joined when they are connected.
+     * A `Triangles` command is a list of colored triangles, which are only available since SDL 2.0.18.
+     */
+    struct DrawCommand {
+        DrawCommandType type;
+        SDL_Texture* texture;
+        SDL_BlendMode blend;
+        SDL_Color color;
+        SDL_Rect clip;
+        bool clipping;
+        size_t start;
+        size_t count;
+    };
+
+    struct DrawCommandBuffer {
+        bool empty() const { return this->commands.empty(); }
+
+        void clear() {
+            this->commands.clear();
+            this->copies.clear();
+            this->rects.clear();
+            this->points.clear();
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            this->triangles.clear();
+#endif
+        }
+
+        std::vector<DrawCommand> commands;
+        std::vector<TextureCopy> copies;
+        std::vector<SDL_FRect> rects;
+        std::vector<SDL_FPoint> points;
+
+        // the clipping region that clients see while recording
+        SDL_Rect clip;
+        bool clipping = false;
+
+        // scratches for pens
+        std::vector<SDL_FPoint> scratch_points;
+        std::vector<SDL_FRect> scratch_rects;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        std::vector<SDL_Vertex> triangles;
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+        std::vector<SDL_Vertex> scratch_vertices;
+#endif
+
+        // baked grids, keyed by (row, col, cell width, cell height, color), which survive `clear()`
+        std::map<std::tuple<int, int, float, float, uint32_t>, std::pair<shared_texture_t, uint64_t>> grids;
+        uint64_t grid_clock = 0U; // for evicting the least recently used
+        std::atomic<bool> grids_lost = false;
+        std::atomic<uint64_t> target_generation = 0U;
+    };
+}
+
+static inline bool same_color(const SDL_Color& c1, const SDL_Color& c2) {
+    return (c1.r == c2.r) && (c1.g == c2.g) && (c1.b == c2.b) && (c1.a == c2.a);
+}
+
+static inline SDL_Color rgba_to_color(const RGBA32& rgba) {
+    SDL_Color c;
+
+    rgba.unbox(&c.r, &c.g, &c.b, &c.a);
+
+    return c;
+}
+
+static inline bool same_clip(bool clipping1, const SDL_Rect& clip1, bool clipping2, const SDL_Rect& clip2) {
+    return (clipping1 == clipping2)
+        && ((!clipping1) || ((clip1.x == clip2.x) && (clip1.y == clip2.y) && (clip1.w == clip2.w) && (clip1.h == clip2.h)));
+}
+
+/**
+ * Tells if the clipping region cuts nothing of the box,
+ *   half a pixel is tolerated as pixels are sampled at their centers.
+ */
+static inline bool clip_inside(bool clipping, const SDL_Rect& clip, const SDL_FRect* box) {
+    return (!clipping)
+        || ((box->x + 0.5F >= float(clip.x)) && (box->y + 0.5F >= float(clip.y))
+            && (box->x + box->w - 0.5F <= float(clip.x + clip.w))
+            && (box->y + box->h - 0.5F <= float(clip.y + clip.h)));
+}
+
+/**
+ * Appends to the last command if states are the same,
+ *   different clipping regions are also fine if neither of them cuts the `bounds`.
+ */
+static DrawCommand* unsafe_command_for(DrawCommandBuffer* self, DrawCommandType type, SDL_Texture* texture, SDL_BlendMode blend, const SDL_Color& color, size_t start, const SDL_FRect* bounds) {
+    DrawCommand* cmd = nullptr;
+
+    if (!self->commands.empty()) {
+        cmd = &self->commands.back();
+
+        if ((cmd->type != type) || (cmd->texture != texture) || (cmd->blend != blend) || !same_color(cmd->color, color)) {
+            cmd = nullptr;
+        } else if (!same_clip(cmd->clipping, cmd->clip, self->clipping, self->clip)) {
+            if ((bounds == nullptr) || !clip_inside(self->clipping, self->clip, bounds) || !clip_inside(cmd->clipping, cmd->clip, bounds)) {
+                cmd = nullptr;
+            }
+        }
+    }
+
+    if (cmd == nullptr) {
+        self->commands.push_back({ type, texture, blend, color, self->clip, self->clipping, start, 0U });
+        cmd = &self->commands.back();
+    }
+
+    return cmd;
+}
+
+static void record_copy(DrawCommandBuffer* self, SDL_Texture* texture, SDL_Rect* src, const SDL_FRect& dst, double angle, SDL_RendererFlip flip) {
+    TextureCopy copy;
+    SDL_BlendMode blend;
+    SDL_Color color;
+    
+    if (src == nullptr) {
+        copy.src.x = 0;
+        copy.src.y = 0;
+        SDL_QueryTexture(texture, nullptr, nullptr, &copy.src.w, &copy.src.h);
+    } else {
+        copy.src = (*src);
+    }
+
+    copy.dst = dst;
+    copy.angle = angle;
+    copy.flip = flip;
+
+    SDL_GetTextureBlendMode(texture, &blend);
+    SDL_GetTextureColorMod(texture, &color.r, &color.g, &color.b);
+    SDL_GetTextureAlphaMod(texture, &color.a);
+
+    unsafe_command_for(self, DrawCommandType::Copy, texture, blend, color, self->copies.size(),
+        ((angle == 0.0) ? &copy.dst : nullptr))->count += 1U;
+    self->copies.push_back(copy);
+}
+
+static void record_rect(DrawCommandBuffer* self, DrawCommandType type, const SDL_FRect& box, const RGBA32& rgba) {
+    unsafe_command_for(self, type, nullptr, SDL_BLENDMODE_INVALID, rgba_to_color(rgba), self->rects.size(), &box)->count += 1U;
+    self->rects.push_back(box);
+}
+
+static void record_points(DrawCommandBuffer* self, const SDL_FPoint* pts, int size, const RGBA32& rgba, const SDL_FRect* bounds = nullptr) {
+    DrawCommand* cmd = unsafe_command_for(self, DrawCommandType::Points, nullptr, SDL_BLENDMODE_INVALID, rgba_to_color(rgba), self->points.size(), bounds);
+
+    self->points.insert(self->points.end(), pts, pts + size);
+    cmd->count += size_t(size);
+}
+
+static void record_rects(DrawCommandBuffer* self, DrawCommandType type, const SDL_FRect* boxes, int size, const RGBA32& rgba, const SDL_FRect* bounds) {
+    DrawCommand* cmd = unsafe_command_for(self, type, nullptr, SDL_BLENDMODE_INVALID, rgba_to_color(rgba), self->rects.size(), bounds);
+
+    self->rects.insert(self->rects.end(), boxes, boxes + size);
+    cmd->count += size_t(size);
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+static void record_triangles(DrawCommandBuffer* self, const SDL_Vertex* vertices, int size, const RGBA32& rgba, const SDL_FRect* bounds, SDL_BlendMode blend = SDL_BLENDMODE_INVALID) {
+    DrawCommand* cmd = unsafe_command_for(self, DrawCommandType::Triangles, nullptr, blend, rgba_to_color(rgba), self->triangles.size(), bounds);
+
+    self->triangles.insert(self->triangles.end(), vertices, vertices + size);
+    cmd->count += size_t(size);
+}
+#endif
+
+static void record_lines(DrawCommandBuffer* self, const SDL_FPoint* pts, int size, const RGBA32& rgba) {
+    if (size > 1) {
+        SDL_Color color = rgba_to_color(rgba);
+        DrawCommand* cmd = nullptr;
+
+        if (!self->commands.empty()) {
+            DrawCommand* last = &self->commands.back();
+
+            if ((last->type == DrawCommandType::Lines) && same_color(last->color, color)
+                    && same_clip(last->clipping, last->clip, self->clipping, self->clip)) {
+                const SDL_FPoint& tail = self->points.back();
+
+                if ((tail.x == pts[0].x) && (tail.y == pts[0].y)) {
+                    cmd = last;
+                    pts ++;
+                    size --;
+                }
+            }
+        }
+
+        if (cmd == nullptr) {
+            self->commands.push_back({ DrawCommandType::Lines, nullptr, SDL_BLENDMODE_INVALID, color, self->clip, self->clipping, self->points.size(), 0U });
+            cmd = &self->commands.back();
+        }
+
+        self->points.insert(self->points.end(), pts, pts + size);
+        cmd->count += size_t(size);
+    }
+}
+
+static inline void record_line(DrawCommandBuffer* self, float x1, float y1, float x2, float y2, const RGBA32& rgba) {
+    SDL_FPoint pts[2] = { { x1, y1 }, { x2, y2 } };
+
+    record_lines(self, pts, 2, rgba);
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+static void push_copy_vertices(DrawCommandBuffer* self, const TextureCopy& copy, const SDL_Color& color, float tw, float th) {
+    float u0 = float(copy.src.x) / tw;
+    float v0 = float(copy.src.y) / th;
+    float u1 = float(copy.src.x + copy.src.w) / tw;
+    float v1 = float(copy.src.y + copy.src.h) / th;
+    float hw = copy.dst.w * 0.5F;
+    float hh = copy.dst.h * 0.5F;
+    float cx = copy.dst.x + hw;
+    float cy = copy.dst.y + hh;
+    float cosa = 1.0F;
+    float sina = 0.0F;
+    int base = int(self->vertices.size());
+
+    if ((copy.flip & SDL_FLIP_HORIZONTAL) != 0) {
+        std::swap(u0, u1);
+    }
+
+    if ((copy.flip & SDL_FLIP_VERTICAL) != 0) {
+        std::swap(v0, v1);
+    }
+
+    if (copy.angle != 0.0) {
+        double rad = degrees_to_radians(copy.angle);
+
+        cosa = float(flcos(rad));
+        sina = float(flsin(rad));
+    }
+
+    /* rotating clockwise around the center of `dst`, just like `SDL_RenderCopyEx()` does */
+    self->vertices.push_back({ { cx - hw * cosa + hh * sina, cy - hw * sina - hh * cosa }, color, { u0, v0 } });
+    self->vertices.push_back({ { cx + hw * cosa + hh * sina, cy + hw * sina - hh * cosa }, color, { u1, v0 } });
+    self->vertices.push_back({ { cx + hw * cosa - hh * sina, cy + hw * sina + hh * cosa }, color, { u1, v1 } });
+    self->vertices.push_back({ { cx - hw * cosa - hh * sina, cy - hw * sina + hh * cosa }, color, { u0, v1 } });
+
+    self->indices.push_back(base + 0);
+    self->indices.push_back(base + 1);
+    self->indices.push_back(base + 2);
+    self->indices.push_back(base + 0);
+    self->indices.push_back(base + 2);
+    self->indices.push_back(base + 3);
+}
+#endif
+
+static void flush_copies(SDL_Renderer* device, DrawCommandBuffer* self, const DrawCommand& cmd) {
+    SDL_Texture* texture = cmd.texture;
+    SDL_BlendMode blend0;
+    uint8_t r0, g0, b0, a0;
+
+    SDL_GetTextureBlendMode(texture, &blend0);
+    SDL_GetTextureColorMod(texture, &r0, &g0, &b0);
+    SDL_GetTextureAlphaMod(texture, &a0);
+    SDL_SetTextureBlendMode(texture, cmd.blend);
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    /* the modulation goes with vertices */ {
+        int tw, th;
+
+        SDL_QueryTexture(texture, nullptr, nullptr, &tw, &th);
+        SDL_SetTextureColorMod(texture, 0xFFU, 0xFFU, 0xFFU);
+        SDL_SetTextureAlphaMod(texture, 0xFFU);
+
+        self->vertices.clear();
+        self->indices.clear();
+
+        for (size_t idx = cmd.start; idx < cmd.start + cmd.count; idx ++) {
+            push_copy_vertices(self, self->copies[idx], cmd.color, float(tw), float(th));
+        }
+
+        SDL_RenderGeometry(device, texture, self->vertices.data(), int(self->vertices.size()), self->indices.data(), int(self->indices.size()));
+    }
+#else
+    SDL_SetTextureColorMod(texture, cmd.color.r, cmd.color.g, cmd.color.b);
+    SDL_SetTextureAlphaMod(texture, cmd.color.a);
+
+    for (size_t idx = cmd.start; idx < cmd.start + cmd.count; idx ++) {
+        TextureCopy* copy = &self->copies[idx];
+
+        SDL_RenderCopyExF(device, texture, &copy->src, &copy->dst, copy->angle, nullptr, copy->flip);
+    }
+#endif
+
+    SDL_SetTextureBlendMode(texture, blend0);
+    SDL_SetTextureColorMod(texture, r0, g0, b0);
+    SDL_SetTextureAlphaMod(texture, a0);
+}
+
+/** NOTE
+ * Pens generate primitives into the scratch buffers instead of drawing them one by one,
+ *   so that each shape goes to the renderer (or the recorder) in a single call.
+ *
+ * Filled shapes are made of disjoint horizontal spans,
+ *   otherwise overlapped pixels would be blended more than once.
+ */
+static inline void pen_span(std::vector<SDL_FRect>& spans, int x0, int x1, int y) {
+    spans.push_back({ float(x0), float(y), float(x1 - x0 + 1), 1.0F });
+}
+
+static inline void pen_mirrored_span(std::vector<SDL_FRect>& spans, int cx, int cy, int xext, int y) {
+    pen_span(spans, cx - xext, cx + xext, cy + y);
+
+    if (y > 0) {
+        pen_span(spans, cx - xext, cx + xext, cy - y);
+    }
+}
+
+static void pen_trace_circle(std::vector<SDL_FPoint>& pts, int cx, int cy, int radius) {
     int err = 2 - 2 * radius;
     int x = -radius;
     int y = 0;
     
     do {
-        SDL_RenderDrawPoint(renderer, cx + x, cy - y);
-        SDL_RenderDrawPoint(renderer, cx - x, cy + y);
-        SDL_RenderDrawPoint(renderer, cx + y, cy + x);
-        SDL_RenderDrawPoint(renderer, cx - y, cy - x);
+        pts.push_back({ float(cx + x), float(cy - y) });
+        pts.push_back({ float(cx - x), float(cy + y) });
+        pts.push_back({ float(cx + y), float(cy + x) });
+        pts.push_back({ float(cx - y), float(cy - x) });
 
         radius = err;
         if (radius <= y) {
@@ -37,15 +367,18 @@ static void pen_draw_circle(SDL_Renderer* renderer, int cx, int cy, int radius)
     } while (x < 0);
 }
 
-static void pen_draw_filled_circle(SDL_Renderer* renderer, int cx, int cy, int radius) {
+static void pen_span_circle(std::vector<SDL_FRect>& spans, int cx, int cy, int radius) {
     int err = 2 - 2 * radius;
     int x = -radius;
     int y = 0;
+    int last_y = -1;
     
     do {
-        SDL_RenderDrawLine(renderer, cx + x, cy + y, cx - x, cy + y); // Q III, Q IV
-        SDL_RenderDrawLine(renderer, cx + x, cy,     cx + x, cy - y); // Q II
-        SDL_RenderDrawLine(renderer, cx - x, cy - y, cx,     cy - y); // Q I
+        /* `x` only grows, hence the first point of a row is the widest one */
+        if (y != last_y) {
+            pen_mirrored_span(spans, cx, cy, -x, y);
+            last_y = y;
+        }
 
         radius = err;
         if (radius <= y) {
@@ -56,9 +389,14 @@ static void pen_draw_filled_circle(SDL_Renderer* renderer, int cx, int cy, int r
             err += ++x * 2 + 1;
         }
     } while (x < 0);
+
+    /* the tips */
+    while (last_y < y) {
+        pen_mirrored_span(spans, cx, cy, 0, ++ last_y);
+    }
 }
 
-static void pen_draw_ellipse(SDL_Renderer* renderer, int cx, int cy, int ar, int br) {
+static void pen_trace_ellipse(std::vector<SDL_FPoint>& pts, int cx, int cy, int ar, int br) {
     /* II. quadrant from bottom left to top right */
     long x = -ar;
     long y = 0;
@@ -70,10 +408,10 @@ static void pen_draw_ellipse(SDL_Renderer* renderer, int cx, int cy, int ar, int
     long err = dx + dy;
 
     do {
-        SDL_RenderDrawPoint(renderer, cx - x, cy + y);
-        SDL_RenderDrawPoint(renderer, cx + x, cy + y);
-        SDL_RenderDrawPoint(renderer, cx + x, cy - y);
-        SDL_RenderDrawPoint(renderer, cx - x, cy - y);
+        pts.push_back({ float(cx - x), float(cy + y) });
+        pts.push_back({ float(cx + x), float(cy + y) });
+        pts.push_back({ float(cx + x), float(cy - y) });
+        pts.push_back({ float(cx - x), float(cy - y) });
 
         e2 = 2 * err;
         if (e2 >= dx) { x++; err += dx += 2 * b2; }    /* x step */
@@ -82,12 +420,12 @@ static void pen_draw_ellipse(SDL_Renderer* renderer, int cx, int cy, int ar, int
 
     /* to early stop for flat ellipses with a = 1, finish tip of ellipse */
     while (y++ < br) {
-        SDL_RenderDrawPoint(renderer, cx, cy + y);
-        SDL_RenderDrawPoint(renderer, cx, cy - y);
+        pts.push_back({ float(cx), float(cy + y) });
+        pts.push_back({ float(cx), float(cy - y) });
     }
 }
 
-static void pen_draw_filled_ellipse(SDL_Renderer* renderer, int cx, int cy, int ar, int br) {
+static void pen_span_ellipse(std::vector<SDL_FRect>& spans, int cx, int cy, int ar, int br) {
     /* Q II. from bottom left to top right */
     long x = -ar;
     long y = 0;
@@ -97,11 +435,13 @@ static void pen_draw_filled_ellipse(SDL_Renderer* renderer, int cx, int cy, int
     long dx = (1 + 2 * x) * e2 * e2;
     long dy = x * x;
     long err = dx + dy;
+    long last_y = -1;
 
     do {
-        SDL_RenderDrawLine(renderer, cx + x, cy + y, cx - x, cy + y); // Q III, Q IV
-        SDL_RenderDrawLine(renderer, cx + x, cy,     cx + x, cy - y); // Q II
-        SDL_RenderDrawLine(renderer, cx - x, cy - y, cx,     cy - y); // Q I
+        if (y != last_y) {
+            pen_mirrored_span(spans, cx, cy, int(-x), int(y));
+            last_y = y;
+        }
 
         e2 = 2 * err;
         if (e2 >= dx) { x++; err += dx += 2 * b2; }     /* x step */
@@ -109,111 +449,136 @@ static void pen_draw_filled_ellipse(SDL_Renderer* renderer, int cx, int cy, int
     } while (x <= 0);
 
     /* to early stop for flat ellipses with a = 1, finish tip of ellipse */
-    while (y++ < br) {
-        SDL_RenderDrawLine(renderer, cx, cy + y, cx, cy - y);
+    while (last_y < br) {
+        pen_mirrored_span(spans, cx, cy, 0, int(++ last_y));
     }
 }
 
-static void pen_draw_regular_polygon(SDL_Renderer* renderer, int n, float cx, float cy, float r, float rotation) {
+static void pen_trace_regular_polygon(std::vector<SDL_FPoint>& pts, int n, float cx, float cy, float r, float rotation) {
     // for inscribed regular polygon, the radius should be `Rcos(pi/n)`
     float start = degrees_to_radians(rotation);
     float delta = 2.0F * pi_f / float(n);
-    float x0, y0, px, py;
 
-    x0 = px = r * flcos(start) + cx;
-    y0 = py = r * flsin(start) + cy;
-
-    for (int idx = 1; idx < n; idx++) {
+    for (int idx = 0; idx < n; idx++) {
         float theta = start + delta * float(idx);
-        float sx = r * flcos(theta) + cx;
-        float sy = r * flsin(theta) + cy;
 
-        SDL_RenderDrawLineF(renderer, px, py, sx, sy);
-        px = sx;
-        py = sy;
+        pts.push_back({ r * flcos(theta) + cx, r * flsin(theta) + cy });
     }
 
-    if (px != x0) {
-        SDL_RenderDrawLineF(renderer, px, py, x0, y0);
+    if (n > 1) {
+        pts.push_back(pts.front());
     } else {
-        SDL_RenderDrawPointF(renderer, cx, cy);
+        pts.clear();
+        pts.push_back({ cx, cy });
     }
 }
 
-static void pen_fill_regular_polygon(SDL_Renderer* renderer, int n, float cx, float cy, float r, float rotation) {
-    // for inscribed regular polygon, the radius should be `Rcos(pi/n)`
-    float start = degrees_to_radians(rotation);
-    float delta = 2.0F * pi_f / float(n);
-    float xmin = cx - r;
-    float xmax = cx + r;
-    float ymin = +r + cy;
-    float ymax = -r + cy;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+static void pen_triangulate_regular_polygon(std::vector<SDL_Vertex>& vertices, std::vector<SDL_FPoint>& pts,
+        int n, float cx, float cy, float r, float rotation, const SDL_Color& color) {
+    pen_trace_regular_polygon(pts, n, cx, cy, r, rotation);
 
-#ifndef __windows__
-    SDL_FPoint pts[n + 1];
-#else
-    SDL_FPoint* pts = new SDL_FPoint[n + 1];
+    /* a fan around the center, the last point closes the outline */
+    for (size_t idx = 1; idx < pts.size(); idx ++) {
+        vertices.push_back({ { cx, cy }, color, { 0.0F, 0.0F } });
+        vertices.push_back({ pts[idx - 1], color, { 0.0F, 0.0F } });
+        vertices.push_back({ pts[idx], color, { 0.0F, 0.0F } });
+    }
+}
+
+/**
+ * An anti-aliased line is a strip of two pixels wide along the line,
+ *   whose alpha fades from the center to both edges, so that it covers one pixel across in total.
+ * Vertices are shifted by half a pixel, since pixels are sampled at their centers.
+ */
+static void pen_triangulate_aaline(std::vector<SDL_Vertex>& vertices, float x1, float y1, float x2, float y2, const SDL_Color& color) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float len = flsqrt(dx * dx + dy * dy);
+    float ux = dx / len * 0.5F;
+    float uy = dy / len * 0.5F;
+    SDL_FPoint a = { x1 + 0.5F - ux, y1 + 0.5F - uy };
+    SDL_FPoint b = { x2 + 0.5F + ux, y2 + 0.5F + uy };
+    SDL_FPoint a0 = { a.x - uy * 2.0F, a.y + ux * 2.0F };
+    SDL_FPoint a1 = { a.x + uy * 2.0F, a.y - ux * 2.0F };
+    SDL_FPoint b0 = { b.x - uy * 2.0F, b.y + ux * 2.0F };
+    SDL_FPoint b1 = { b.x + uy * 2.0F, b.y - ux * 2.0F };
+    SDL_Color edge = { color.r, color.g, color.b, 0 };
+
+    vertices.push_back({ a0, edge, { 0.0F, 0.0F } });
+    vertices.push_back({ a, color, { 0.0F, 0.0F } });
+    vertices.push_back({ b, color, { 0.0F, 0.0F } });
+    vertices.push_back({ a0, edge, { 0.0F, 0.0F } });
+    vertices.push_back({ b, color, { 0.0F, 0.0F } });
+    vertices.push_back({ b0, edge, { 0.0F, 0.0F } });
+
+    vertices.push_back({ a, color, { 0.0F, 0.0F } });
+    vertices.push_back({ a1, edge, { 0.0F, 0.0F } });
+    vertices.push_back({ b1, edge, { 0.0F, 0.0F } });
+    vertices.push_back({ a, color, { 0.0F, 0.0F } });
+    vertices.push_back({ b1, edge, { 0.0F, 0.0F } });
+    vertices.push_back({ b, color, { 0.0F, 0.0F } });
+}
 #endif
 
-    for (int idx = 0; idx < n; idx ++) {
-        float theta = start + delta * float(idx);
-        float sx = r * flcos(theta) + cx;
-        float sy = r * flsin(theta) + cy;
+/* regular polygons are convex, every scanline meets the outline at most twice */
+static void pen_span_regular_polygon(std::vector<SDL_FRect>& spans, std::vector<SDL_FPoint>& pts, int n, float cx, float cy, float r, float rotation) {
+    float ymin = cy;
+    float ymax = cy;
 
-        pts[idx].x = sx;
-        pts[idx].y = sy;
+    pen_trace_regular_polygon(pts, n, cx, cy, r, rotation);
 
-        if (sy < ymin) ymin = sy;
-        if (sy > ymax) ymax = sy;
+    for (auto& pt : pts) {
+        ymin = flmin(ymin, pt.y);
+        ymax = flmax(ymax, pt.y);
     }
-    
-    pts[n] = pts[0];
-
-    for (float y = ymin; y < ymax + 1.0; y += 1.0) {
-        int pcount = 0;
-        float px[2];
-        float py, t;
-
-        for (int i = 0; i < n / 2; i ++) {
-            SDL_FPoint spt = pts[i];
-            SDL_FPoint ept = pts[i + 1];
-
-            if (lines_intersect(spt.x, spt.y, ept.x, ept.y, xmin, y, xmax, y, px + pcount, &py, &t)) {
-                if (flin(0.0, t, 1.0)) pcount += 1;
-            } else if (pcount == 0) {
-                px[0] = spt.x;
-                px[1] = ept.x;
-                pcount = 2;
-            }
-            
-            if (pcount == 2) break;
-
-            spt = pts[n - i];
-            ept = pts[n - i - 1];
-
-            if (lines_intersect(spt.x, spt.y, ept.x, ept.y, xmin, y, xmax, y, px + pcount, &py, &t)) {
-                if (flin(0.0, t, 1.0)) pcount += 1;
-            } else if (pcount == 0) {
-                px[0] = spt.x;
-                px[1] = ept.x;
-                pcount = 2;
+
+    for (float y = flfloor(ymin) + 0.5F; y < ymax; y += 1.0F) {
+        float xmin = +infinity_f;
+        float xmax = -infinity_f;
+
+        for (size_t idx = 1; idx < pts.size(); idx ++) {
+            const SDL_FPoint& spt = pts[idx - 1];
+            const SDL_FPoint& ept = pts[idx];
+
+            if ((flmin(spt.y, ept.y) <= y) && (y <= flmax(spt.y, ept.y)) && (spt.y != ept.y)) {
+                float x = spt.x + (ept.x - spt.x) * (y - spt.y) / (ept.y - spt.y);
+
+                xmin = flmin(xmin, x);
+                xmax = flmax(xmax, x);
             }
-            
-            if (pcount == 2) break;
         }
 
-        if (pcount == 2) {
-            SDL_RenderDrawLineF(renderer, px[0], y, px[1], y);
-        } else if (n == 2) {
-            SDL_RenderDrawPointF(renderer, px[0], py);
-        } else if (n <= 1) {
-            SDL_RenderDrawPointF(renderer, cx, cy);
+        if (xmin <= xmax) {
+            spans.push_back({ xmin, y - 0.5F, xmax - xmin, 1.0F });
         }
     }
+}
 
-#ifdef __windows__
-    delete [] pts;
-#endif
+/** NOTE
+ * Consecutive filled cells in a row are merged into one span,
+ *   which keeps dense boards, say, those of cellular automata, far cheaper than a rectangle per cell.
+ */
+template<typename Filled>
+static void pen_span_cells(std::vector<SDL_FRect>& spans, int row, int col, float cw, float ch, float xoff, float yoff, Filled filled) {
+    for (int r = 0; r < row; r++) {
+        float y = yoff + float(r) * ch;
+        int c = 0;
+
+        while (c < col) {
+            if (filled(r, c)) {
+                int c0 = c;
+
+                do {
+                    c ++;
+                } while ((c < col) && filled(r, c));
+
+                spans.push_back({ xoff + float(c0) * cw, y, float(c - c0) * cw, ch });
+            } else {
+                c ++;
+            }
+        }
+    }
 }
 
 /*************************************************************************************************/
@@ -231,7 +596,7 @@ static inline void setup_for_text(const std::string& text, const RGBA& rgb, SDL_
     rgb.unbox(&c.r, &c.g, &c.b, &c.a);
 }
 
-static TTF_Font* select_font(const shared_font_t& sfont, const std::string& text) {
+static shared_font_t select_shared_font(const shared_font_t& sfont, const std::string& text) {
     shared_font_t f = sfont;
 
     if (!f->is_suitable(text)) {
@@ -242,7 +607,11 @@ static TTF_Font* select_font(const shared_font_t& sfont, const std::string& text
         f = GameFont::Default();
     }
 
-    return f->self();
+    return f;
+}
+
+static inline TTF_Font* select_font(const shared_font_t& sfont, const std::string& text) {
+    return select_shared_font(sfont, text)->self();
 }
 
 static SDL_Surface* game_text_surface(bool disable_font_selection, const std::string& text, const shared_font_t& sfont, TextRenderMode mode, const RGBA& fg, const RGBA& bg, int wrap) {
@@ -288,9 +657,18 @@ DrawingContext::DrawingContext(SDL_Renderer* device) : device(device) {
     // TODO: ensure that the device is not a nullptr.
 
     SDL_GetRendererInfo(this->device, &info);
+    this->buffer = new DrawCommandBuffer();
+    this->glyphs = new GlyphCache();
+    game_watch_retiring_textures(DrawingContext::on_texture_retiring, this);
+    SDL_AddEventWatch(DrawingContext::on_render_event, this);
 }
 
 DrawingContext::~DrawingContext() noexcept {
+    game_unwatch_retiring_textures(DrawingContext::on_texture_retiring, this);
+    SDL_DelEventWatch(DrawingContext::on_render_event, this);
+    delete this->buffer;
+    delete this->glyphs;
+
     if (this->device != nullptr) {
         SDL_DestroyRenderer(this->device);
     }
@@ -301,7 +679,7 @@ SDL_Surface* DrawingContext::snapshot(int width, int height) {
     SDL_Surface* photograph = game_formatted_surface(width, height, format);
 
     if (photograph != nullptr) {
-        if (SDL_RenderReadPixels(this->device, NULL, format, photograph->pixels, photograph->pitch) < 0) {
+        if (SDL_RenderReadPixels(this->self(), NULL, format, photograph->pixels, photograph->pitch) < 0) {
             SDL_FreeSurface(photograph);
             photograph = nullptr;
         }
@@ -311,11 +689,24 @@ SDL_Surface* DrawingContext::snapshot(int width, int height) {
 }
 
 /*************************************************************************************************/
-void Plteen::DrawingContext::clear(const RGBA& color) {
+void Plteen::DrawingContext::clear(const RGBA32& color) {
+    SDL_Rect clip;
+
     // the `alpha` might not affect the underline window instance
 
     this->set_draw_color(color);
-    SDL_RenderClear(this->device);
+
+    if (this->feed_clipping_region(&clip)) {
+        SDL_BlendMode mode;
+
+        /* `SDL_RenderClear()` ignores the clipping region, which breaks partial redrawing */
+        SDL_GetRenderDrawBlendMode(this->self(), &mode);
+        SDL_SetRenderDrawBlendMode(this->self(), SDL_BLENDMODE_NONE);
+        SDL_RenderFillRect(this->self(), &clip);
+        SDL_SetRenderDrawBlendMode(this->self(), mode);
+    } else {
+        SDL_RenderClear(this->self());
+    }
 }
 
 void Plteen::DrawingContext::reset(const RGBA& fgc, const RGBA& bgc) {
@@ -324,75 +715,198 @@ void Plteen::DrawingContext::reset(const RGBA& fgc, const RGBA& bgc) {
 }
 
 void Plteen::DrawingContext::reset(SDL_Texture* texture, const RGBA& fgc, const RGBA& bgc) {
-    SDL_SetRenderTarget(this->device, texture);
+    SDL_SetRenderTarget(this->self(), texture);
     this->reset(fgc, bgc);
 }
 
 void Plteen::DrawingContext::refresh(SDL_Texture* texture) {
-    SDL_SetRenderTarget(this->device, nullptr);
-    SDL_RenderCopy(this->device, texture, nullptr, nullptr);
-    SDL_RenderPresent(this->device);
-    SDL_SetRenderTarget(this->device, texture);
+    SDL_SetRenderTarget(this->self(), nullptr);
+    SDL_RenderCopy(this->self(), texture, nullptr, nullptr);
+    SDL_RenderPresent(this->self());
+    SDL_SetRenderTarget(this->self(), texture);
 }
 
-int Plteen::DrawingContext::set_draw_color(const RGBA& color) {
-    return SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-}
+void Plteen::DrawingContext::begin_recording() {
+    if (this->recording_depth == 0) {
+        this->buffer->clipping = SDL_RenderIsClipEnabled(this->device);
+        SDL_RenderGetClipRect(this->device, &this->buffer->clip);
+    }
 
-/*************************************************************************************************/
-SDL_Texture* Plteen::DrawingContext::create_blank_image(int width, int height) {
-    return game_blank_image(this->device, width, height);
+    this->recording_depth += 1;
 }
 
-SDL_Texture* Plteen::DrawingContext::create_blank_image(float width, float height) {
-    return game_blank_image(this->device, width, height);
+void Plteen::DrawingContext::end_recording() {
+    this->recording_depth -= 1;
+
+    if (this->recording_depth <= 0) {
+        this->recording_depth = 0;
+        this->flush();
+    }
 }
 
-/*************************************************************************************************/
-void Plteen::DrawingContext::draw_frame(int x, int y, int width, int height, const RGBA& color) {
-    SDL_Rect box;
+void Plteen::DrawingContext::flush() {
+    if (!this->buffer->empty()) {
+        DrawCommandBuffer* self = this->buffer;
+        const DrawCommand* prev = nullptr;
+        SDL_Color color;
 
-    FILL_BOX(box, x - 1, y - 1, width + 3, height + 3);
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawRect(this->device, &box);
-}
+        /* commands carry their own colors, clients still expect the one they set */
+        SDL_GetRenderDrawColor(this->device, &color.r, &color.g, &color.b, &color.a);
+        
+        for (const DrawCommand& cmd : self->commands) {
+            if ((prev == nullptr) || !same_clip(prev->clipping, prev->clip, cmd.clipping, cmd.clip)) {
+                SDL_RenderSetClipRect(this->device, (cmd.clipping ? &cmd.clip : nullptr));
+            }
 
-void Plteen::DrawingContext::draw_grid(int row, int col, int cell_width, int cell_height, const RGBA& color, int xoff, int yoff) {
-    int xend = xoff + col * cell_width;
-    int yend = yoff + row * cell_height;
+            prev = &cmd;
 
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
+            if (cmd.type == DrawCommandType::Copy) {
+                flush_copies(this->device, self, cmd);
+            } else {
+                SDL_BlendMode blend = SDL_BLENDMODE_INVALID;
 
-    for (int c = 0; c <= col; c++) {
-        int x = xoff + c * cell_width;
+                /* shapes are drawn with the blend mode of the renderer, unless they are recorded with their own */
+                if (cmd.blend != SDL_BLENDMODE_INVALID) {
+                    SDL_GetRenderDrawBlendMode(this->device, &blend);
+                    SDL_SetRenderDrawBlendMode(this->device, cmd.blend);
+                }
 
-        for (int r = 0; r <= row; r++) {
-            int y = yoff + r * cell_height;
+                SDL_SetRenderDrawColor(this->device, cmd.color.r, cmd.color.g, cmd.color.b, cmd.color.a);
+
+                switch (cmd.type) {
+                case DrawCommandType::FillRects: SDL_RenderFillRectsF(this->device, &self->rects[cmd.start], int(cmd.count)); break;
+                case DrawCommandType::DrawRects: SDL_RenderDrawRectsF(this->device, &self->rects[cmd.start], int(cmd.count)); break;
+                case DrawCommandType::Lines: SDL_RenderDrawLinesF(this->device, &self->points[cmd.start], int(cmd.count)); break;
+                case DrawCommandType::Points: SDL_RenderDrawPointsF(this->device, &self->points[cmd.start], int(cmd.count)); break;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                case DrawCommandType::Triangles: SDL_RenderGeometry(this->device, nullptr, &self->triangles[cmd.start], int(cmd.count), nullptr, 0); break;
+#endif
+                default: /* impossible */;
+                }
 
-            SDL_RenderDrawLine(this->device, xoff, y, xend, y);
+                if (blend != SDL_BLENDMODE_INVALID) {
+                    SDL_SetRenderDrawBlendMode(this->device, blend);
+                }
+            }
         }
 
-        SDL_RenderDrawLine(this->device, x, yoff, x, yend);
+        SDL_RenderSetClipRect(this->device, (self->clipping ? &self->clip : nullptr));
+        SDL_SetRenderDrawColor(this->device, color.r, color.g, color.b, color.a);
+        self->clear();
     }
+
+    this->glyphs->sweep();
 }
 
-void Plteen::DrawingContext::fill_grid(int* grids[], int row, int col, int cell_width, int cell_height, const RGBA& color, int xoff, int yoff) {
-    SDL_Rect cell_self;
+/** NOTE
+ * Contents of target textures are lost when the render targets or the device are reset,
+ *   the watcher might be called in any thread, so it only marks the baked grids, which are dropped at the next use,
+ *   and bumps the generation, which tells other clients to redraw their targets.
+ */
+int Plteen::DrawingContext::on_render_event(void* self, SDL_Event* e) {
+    DrawingContext* dc = static_cast<DrawingContext*>(self);
 
-    cell_self.w = cell_width;
-    cell_self.h = cell_height;
+    if ((e->type == SDL_RENDER_TARGETS_RESET) || (e->type == SDL_RENDER_DEVICE_RESET)) {
+        dc->buffer->grids_lost = true;
+        dc->buffer->target_generation ++;
+    }
 
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
+    return 0;
+}
 
-    for (int c = 0; c < col; c++) {
-        for (int r = 0; r < row; r++) {
-            if (grids[r][c] > 0) {
-                cell_self.x = xoff + c * cell_self.w;
-                cell_self.y = yoff + r * cell_self.h;
-                SDL_RenderFillRect(this->device, &cell_self);
-            }
+uint64_t Plteen::DrawingContext::get_target_generation() {
+    return this->buffer->target_generation;
+}
+
+/* recorded copies only hold the raw texture, which has to be drawn before it goes away */
+void Plteen::DrawingContext::on_texture_retiring(SDL_Texture* texture, void* self) {
+    DrawingContext* dc = static_cast<DrawingContext*>(self);
+
+    for (const DrawCommand& cmd : dc->buffer->commands) {
+        if ((cmd.type == DrawCommandType::Copy) && (cmd.texture == texture)) {
+            dc->flush();
+            break;
+        }
+    }
+}
+
+int Plteen::DrawingContext::set_target(SDL_Texture* target) {
+    int status = 0;
+
+    /* recorded commands belong to the previous target */
+    this->flush();
+    status = SDL_SetRenderTarget(this->device, target);
+
+    if (this->is_recording()) {
+        /* each target has its own clipping region */
+        this->buffer->clipping = SDL_RenderIsClipEnabled(this->device);
+        SDL_RenderGetClipRect(this->device, &this->buffer->clip);
+    }
+
+    return status;
+}
+
+bool Plteen::DrawingContext::set_clipping_region(SDL_Rect* rect) {
+    int status = 0;
+
+    if (this->is_recording()) {
+        this->buffer->clipping = (rect != nullptr);
+
+        if (rect != nullptr) {
+            this->buffer->clip = (*rect);
         }
+    } else {
+        status = SDL_RenderSetClipRect(this->device, rect);
     }
+
+    return status;
+}
+
+bool Plteen::DrawingContext::feed_clipping_region(SDL_Rect* rect) {
+    bool clipping = false;
+
+    if (this->is_recording()) {
+        clipping = this->buffer->clipping;
+        (*rect) = this->buffer->clip;
+    } else {
+        SDL_RenderGetClipRect(this->device, rect);
+        clipping = SDL_RenderIsClipEnabled(this->device);
+    }
+
+    return clipping;
+}
+
+int Plteen::DrawingContext::set_draw_color(const RGBA32& color) {
+    return SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
+}
+
+/*************************************************************************************************/
+SDL_Texture* Plteen::DrawingContext::create_blank_image(int width, int height) {
+    return game_blank_image(this->self(), width, height);
+}
+
+SDL_Texture* Plteen::DrawingContext::create_blank_image(float width, float height) {
+    return game_blank_image(this->self(), width, height);
+}
+
+/*************************************************************************************************/
+void Plteen::DrawingContext::draw_frame(int x, int y, int width, int height, const RGBA32& color) {
+    SDL_Rect box;
+
+    FILL_BOX(box, x - 1, y - 1, width + 3, height + 3);
+    this->draw_rect(&box, color);
+}
+
+void Plteen::DrawingContext::draw_grid(int row, int col, int cell_width, int cell_height, const RGBA32& color, int xoff, int yoff) {
+    this->draw_grid(row, col, float(cell_width), float(cell_height), color, float(xoff), float(yoff));
+}
+
+void Plteen::DrawingContext::fill_grid(int* grids[], int row, int col, int cell_width, int cell_height, const RGBA32& color, int xoff, int yoff) {
+    this->fill_grid(grids, row, col, float(cell_width), float(cell_height), color, float(xoff), float(yoff));
+}
+
+void Plteen::DrawingContext::fill_grid(const uint8_t* cells, int row, int col, int cell_width, int cell_height, const RGBA32& color, int xoff, int yoff) {
+    this->fill_grid(cells, row, col, float(cell_width), float(cell_height), color, float(xoff), float(yoff));
 }
 
 void Plteen::DrawingContext::stamp(SDL_Surface* surface, int x, int y, SDL_RendererFlip flip, double angle) {
@@ -411,10 +925,11 @@ void Plteen::DrawingContext::stamp(SDL_Surface* surface, SDL_Rect* region, SDL_R
 }
 
 void Plteen::DrawingContext::stamp(SDL_Surface* surface, SDL_Rect* src, SDL_Rect* dst, SDL_RendererFlip flip, double angle) {
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(this->device, surface);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(this->self(), surface);
 
     if (texture != nullptr) {
         this->stamp(texture, src, dst, flip, angle);
+        this->flush();
         SDL_DestroyTexture(texture);
     }
 }
@@ -440,173 +955,298 @@ int Plteen::DrawingContext::stamp(SDL_Texture* texture, SDL_Rect* region, SDL_Re
 }
 
 int Plteen::DrawingContext::stamp(SDL_Texture* texture, SDL_Rect* src, SDL_Rect* dst, SDL_RendererFlip flip, double angle) {
-    if ((flip == SDL_FLIP_NONE) && (angle == 0.0)) {
-        return SDL_RenderCopy(this->device, texture, src, dst);
+    if (this->is_recording() && (dst != nullptr)) {
+        SDL_FRect box;
+
+        FILL_BOX(box, float(dst->x), float(dst->y), float(dst->w), float(dst->h));
+        record_copy(this->buffer, texture, src, box, angle, flip);
+
+        return 0;
+    } else if ((flip == SDL_FLIP_NONE) && (angle == 0.0)) {
+        return SDL_RenderCopy(this->self(), texture, src, dst);
     } else {
-        return SDL_RenderCopyEx(this->device, texture, src, dst, angle, nullptr, flip);
+        return SDL_RenderCopyEx(this->self(), texture, src, dst, angle, nullptr, flip);
     }
 }
 
 /**************************************************************************************************/
-void Plteen::DrawingContext::draw_point(int x, int y, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawPoint(this->device, x, y);
+void Plteen::DrawingContext::draw_point(int x, int y, const RGBA32& color) {
+    if (this->is_recording()) {
+        SDL_FPoint pt = { float(x), float(y) };
+
+        record_points(this->buffer, &pt, 1, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawPoint(this->self(), x, y);
+    }
 }
 
-void Plteen::DrawingContext::draw_line(int x1, int y1, int x2, int y2, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawLine(this->device, x1, y1, x2, y2);
+void Plteen::DrawingContext::draw_line(int x1, int y1, int x2, int y2, const RGBA32& color) {
+    if (this->is_recording()) {
+        record_line(this->buffer, float(x1), float(y1), float(x2), float(y2), color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawLine(this->self(), x1, y1, x2, y2);
+    }
 }
 
-void Plteen::DrawingContext::draw_hline(int x, int y, int length, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawLine(this->device, x, y, x + length, y);
+void Plteen::DrawingContext::draw_hline(int x, int y, int length, const RGBA32& color) {
+    this->draw_line(x, y, x + length, y, color);
 }
 
-void Plteen::DrawingContext::draw_vline(int x, int y, int length, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawLine(this->device, x, y, x, y + length);
+void Plteen::DrawingContext::draw_vline(int x, int y, int length, const RGBA32& color) {
+    this->draw_line(x, y, x, y + length, color);
 }
 
-void Plteen::DrawingContext::draw_points(const SDL_Point* pts, int size, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawPoints(this->device, pts, size);
+void Plteen::DrawingContext::draw_points(const SDL_Point* pts, int size, const RGBA32& color) {
+    if (this->is_recording()) {
+        std::vector<SDL_FPoint>& fpts = this->buffer->scratch_points;
+
+        fpts.clear();
+
+        for (int idx = 0; idx < size; idx ++) {
+            fpts.push_back({ float(pts[idx].x), float(pts[idx].y) });
+        }
+
+        record_points(this->buffer, fpts.data(), size, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawPoints(this->self(), pts, size);
+    }
 }
 
-void Plteen::DrawingContext::draw_lines(const SDL_Point* pts, int size, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawLines(this->device, pts, size);
+void Plteen::DrawingContext::draw_lines(const SDL_Point* pts, int size, const RGBA32& color) {
+    if (this->is_recording()) {
+        for (int idx = 1; idx < size; idx ++) {
+            record_line(this->buffer, float(pts[idx - 1].x), float(pts[idx - 1].y), float(pts[idx].x), float(pts[idx].y), color);
+        }
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawLines(this->self(), pts, size);
+    }
 }
 
-void Plteen::DrawingContext::draw_rect(SDL_Rect* box, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawRect(this->device, box);
+void Plteen::DrawingContext::draw_rect(SDL_Rect* box, const RGBA32& color) {
+    if (this->is_recording() && (box != nullptr)) {
+        SDL_FRect fbox;
+
+        FILL_BOX(fbox, float(box->x), float(box->y), float(box->w), float(box->h));
+        record_rect(this->buffer, DrawCommandType::DrawRects, fbox, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawRect(this->self(), box);
+    }
 }
 
-void Plteen::DrawingContext::fill_rect(SDL_Rect* box, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderFillRect(this->device, box);
+void Plteen::DrawingContext::fill_rect(SDL_Rect* box, const RGBA32& color) {
+    if (this->is_recording() && (box != nullptr)) {
+        SDL_FRect fbox;
+
+        FILL_BOX(fbox, float(box->x), float(box->y), float(box->w), float(box->h));
+        record_rect(this->buffer, DrawCommandType::FillRects, fbox, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderFillRect(this->self(), box);
+    }
 }
 
-void Plteen::DrawingContext::draw_rect(int x, int y, int width, int height, const RGBA& color) {
+void Plteen::DrawingContext::draw_rect(int x, int y, int width, int height, const RGBA32& color) {
     SDL_Rect box;
 
     FILL_BOX(box, x, y, width, height);
     this->draw_rect(&box, color);
 }
 
-void Plteen::DrawingContext::fill_rect(int x, int y, int width, int height, const RGBA& color) {
+void Plteen::DrawingContext::fill_rect(int x, int y, int width, int height, const RGBA32& color) {
     SDL_Rect box;
 
     FILL_BOX(box, x, y, width, height);
     this->fill_rect(&box, color);
 }
 
-void Plteen::DrawingContext::draw_rounded_rect(SDL_Rect* box, float rad, const RGBA& color) {
+void Plteen::DrawingContext::draw_rounded_rect(SDL_Rect* box, float rad, const RGBA32& color) {
     this->draw_rounded_rect(box->x, box->y, box->w, box->h, rad, color);
 }
 
-void Plteen::DrawingContext::fill_rounded_rect(SDL_Rect* box, float rad, const RGBA& color) {
+void Plteen::DrawingContext::fill_rounded_rect(SDL_Rect* box, float rad, const RGBA32& color) {
     this->fill_rounded_rect(box->x, box->y, box->w, box->h, rad, color);
 }
 
-void Plteen::DrawingContext::draw_rounded_rect(int x, int y, int width, int height, float radius, const RGBA& color) {
+void Plteen::DrawingContext::draw_rounded_rect(int x, int y, int width, int height, float radius, const RGBA32& color) {
     this->draw_rounded_rect(float(x), float(y), float(width), float(height), radius, color);
 }
 
-void Plteen::DrawingContext::fill_rounded_rect(int x, int y, int width, int height, float radius, const RGBA& color) {
+void Plteen::DrawingContext::fill_rounded_rect(int x, int y, int width, int height, float radius, const RGBA32& color) {
     this->fill_rounded_rect(float(x), float(y), float(width), float(height), radius, color);
 }
 
-void Plteen::DrawingContext::draw_square(int cx, int cy, int apothem, const RGBA& color) {
+void Plteen::DrawingContext::draw_square(int cx, int cy, int apothem, const RGBA32& color) {
     this->draw_rect(cx - apothem, cy - apothem, apothem * 2, apothem * 2, color);
 }
 
-void Plteen::DrawingContext::fill_square(int cx, int cy, int apothem, const RGBA& color) {
+void Plteen::DrawingContext::fill_square(int cx, int cy, int apothem, const RGBA32& color) {
     this->fill_rect(cx - apothem, cy - apothem, apothem * 2, apothem * 2, color);
 }
 
-void Plteen::DrawingContext::draw_rounded_square(int cx, int cy, int apothem, float rad, const RGBA& color) {
+void Plteen::DrawingContext::draw_rounded_square(int cx, int cy, int apothem, float rad, const RGBA32& color) {
     this->draw_rounded_rect(cx - apothem, cy - apothem, apothem * 2, apothem * 2, rad, color);
 }
 
-void Plteen::DrawingContext::fill_rounded_square(int cx, int cy, int apothem, float rad, const RGBA& color) {
+void Plteen::DrawingContext::fill_rounded_square(int cx, int cy, int apothem, float rad, const RGBA32& color) {
     this->fill_rounded_rect(cx - apothem, cy - apothem, apothem * 2, apothem * 2, rad, color);
 }
 
-void Plteen::DrawingContext::draw_circle(int cx, int cy, int radius, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    pen_draw_circle(this->device, cx, cy, radius);
+void Plteen::DrawingContext::draw_circle(int cx, int cy, int radius, const RGBA32& color) {
+    this->draw_ellipse(cx, cy, radius, radius, color);
 }
 
-void Plteen::DrawingContext::fill_circle(int cx, int cy, int radius, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    pen_draw_filled_circle(this->device, cx, cy, radius);
+void Plteen::DrawingContext::fill_circle(int cx, int cy, int radius, const RGBA32& color) {
+    this->fill_ellipse(cx, cy, radius, radius, color);
 }
 
-void Plteen::DrawingContext::draw_ellipse(int cx, int cy, int ar, int br, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    pen_draw_ellipse(this->device, cx, cy, ar, br);
+void Plteen::DrawingContext::draw_ellipse(int cx, int cy, int ar, int br, const RGBA32& color) {
+    std::vector<SDL_FPoint>& pts = this->buffer->scratch_points;
+
+    pts.clear();
+
+    if (ar == br) {
+        pen_trace_circle(pts, cx, cy, ar);
+    } else {
+        pen_trace_ellipse(pts, cx, cy, ar, br);
+    }
+
+    this->draw_scratch_points(cx, cy, ar, br, color);
 }
 
-void Plteen::DrawingContext::fill_ellipse(int cx, int cy, int ar, int br, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    pen_draw_filled_ellipse(this->device, cx, cy, ar, br);
+void Plteen::DrawingContext::fill_ellipse(int cx, int cy, int ar, int br, const RGBA32& color) {
+    std::vector<SDL_FRect>& spans = this->buffer->scratch_rects;
+
+    spans.clear();
+
+    if (ar == br) {
+        pen_span_circle(spans, cx, cy, ar);
+    } else {
+        pen_span_ellipse(spans, cx, cy, ar, br);
+    }
+
+    this->fill_scratch_rects(float(cx - ar), float(cy - br), float(ar * 2 + 1), float(br * 2 + 1), color);
 }
 
-void Plteen::DrawingContext::draw_regular_polygon(int n, int cx, int cy, int radius, float rotation, const RGBA& color) {
+void Plteen::DrawingContext::draw_regular_polygon(int n, int cx, int cy, int radius, float rotation, const RGBA32& color) {
     this->draw_regular_polygon(n, float(cx), float(cy), float(radius), rotation, color);
 }
 
-void Plteen::DrawingContext::fill_regular_polygon(int n, int cx, int cy, int radius, float rotation, const RGBA& color) {
+void Plteen::DrawingContext::fill_regular_polygon(int n, int cx, int cy, int radius, float rotation, const RGBA32& color) {
     this->fill_regular_polygon(n, float(cx), float(cy), float(radius), rotation, color);
 }
 
 /*************************************************************************************************/
-void Plteen::DrawingContext::draw_frame(float x, float y, float width, float height, const RGBA& color) {
+void Plteen::DrawingContext::draw_frame(float x, float y, float width, float height, const RGBA32& color) {
     SDL_FRect box;
 
     FILL_BOX(box, x - 1.0F, y - 1.0F, width + 3.0F, height + 3.0F);
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawRectF(this->device, &box);
+    this->draw_rect(&box, color);
 }
 
-void Plteen::DrawingContext::draw_grid(int row, int col, float cell_width, float cell_height, const RGBA& color, float xoff, float yoff) {
-    float xend = xoff + col * cell_width;
-    float yend = yoff + row * cell_height;
-
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
+void Plteen::DrawingContext::draw_grid(int row, int col, float cell_width, float cell_height, const RGBA32& color, float xoff, float yoff) {
+    std::vector<SDL_FRect>& lines = this->buffer->scratch_rects;
+    float width = float(col) * cell_width;
+    float height = float(row) * cell_height;
 
-    for (int c = 0; c <= col; c++) {
-        float x = xoff + float(c) * cell_width;
+    if ((row >= 0) && (col >= 0)) {
+        /* lines are 1-pixel rectangles, so that they go with `fill_scratch_rects()` in one submission */
+        lines.clear();
 
         for (int r = 0; r <= row; r++) {
-            float y = yoff + float(r) * cell_height;
+            lines.push_back({ xoff, yoff + float(r) * cell_height, width + 1.0F, 1.0F });
+        }
 
-            SDL_RenderDrawLineF(this->device, xoff, y, xend, y);
+        for (int c = 0; c <= col; c++) {
+            lines.push_back({ xoff + float(c) * cell_width, yoff, 1.0F, height + 1.0F });
         }
 
-        SDL_RenderDrawLineF(this->device, x, yoff, x, yend);
+        this->fill_scratch_rects(xoff, yoff, width + 1.0F, height + 1.0F, color);
     }
 }
 
-void Plteen::DrawingContext::fill_grid(int* grids[], int row, int col, float cell_width, float cell_height, const RGBA& color, float xoff, float yoff) {
-    SDL_FRect cell_self;
+/** NOTE
+ * The grid is baked at the pixel phase `0`, hence the offset is snapped to whole pixels,
+ *   otherwise the stamped lines would be resampled into blurry two-pixel ones.
+ */
+void Plteen::DrawingContext::draw_cached_grid(int row, int col, float cell_width, float cell_height, const RGBA32& color, float xoff, float yoff) {
+    auto key = std::make_tuple(row, col, cell_width, cell_height, color.rgba());
+    int width = fl2fxi(flceiling(float(col) * cell_width)) + 1;
+    int height = fl2fxi(flceiling(float(row) * cell_height)) + 1;
+    float x = flround(xoff);
+    float y = flround(yoff);
+    shared_texture_t grid;
+
+    if (this->buffer->grids_lost.exchange(false)) {
+        this->buffer->grids.clear();
+    }
+
+    auto it = this->buffer->grids.find(key);
+
+    if (it != this->buffer->grids.end()) {
+        grid = it->second.first;
+        it->second.second = ++ this->buffer->grid_clock;
+    } else if ((row >= 0) && (col >= 0) && (width <= GRID_TEXTURE_MAX_EXTENT) && (height <= GRID_TEXTURE_MAX_EXTENT)) {
+        grid = std::make_shared<Texture>(this->create_blank_image(width, height));
+
+        if (grid->okay()) {
+            SDL_Texture* origin = this->get_target();
+            SDL_BlendMode mode;
+            SDL_Rect clip;
+            bool clipping = this->feed_clipping_region(&clip);
+
+            this->set_target(grid->self());
+            this->clear_clipping_region();
+
+            /* the color is written as is, and gets blended only when the grid is stamped */
+            SDL_GetRenderDrawBlendMode(this->self(), &mode);
+            SDL_SetRenderDrawBlendMode(this->self(), SDL_BLENDMODE_NONE);
+            this->draw_grid(row, col, cell_width, cell_height, color, 0.0F, 0.0F);
+            this->flush();
+            SDL_SetRenderDrawBlendMode(this->device, mode);
 
-    cell_self.w = cell_width;
-    cell_self.h = cell_height;
+            this->set_target(origin);
+            this->set_clipping_region(clipping ? &clip : nullptr);
 
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
+            if (this->buffer->grids.size() >= GRID_TEXTURE_CACHE_CAPACITY) {
+                auto lru = this->buffer->grids.begin();
 
-    for (int c = 0; c < col; c++) {
-        for (int r = 0; r < row; r++) {
-            if (grids[r][c] > 0) {
-                cell_self.x = xoff + float(c) * cell_self.w;
-                cell_self.y = yoff + float(r) * cell_self.h;
-                SDL_RenderFillRectF(this->device, &cell_self);
+                for (auto self = lru; self != this->buffer->grids.end(); ++ self) {
+                    if (self->second.second < lru->second.second) {
+                        lru = self;
+                    }
+                }
+
+                this->buffer->grids.erase(lru);
             }
+
+            this->buffer->grids[key] = { grid, ++ this->buffer->grid_clock };
         }
     }
+
+    if ((grid != nullptr) && grid->okay()) {
+        this->stamp(grid->self(), x, y, float(width), float(height));
+    } else {
+        this->draw_grid(row, col, cell_width, cell_height, color, x, y);
+    }
+}
+
+void Plteen::DrawingContext::fill_grid(int* grids[], int row, int col, float cell_width, float cell_height, const RGBA32& color, float xoff, float yoff) {
+    this->buffer->scratch_rects.clear();
+    pen_span_cells(this->buffer->scratch_rects, row, col, cell_width, cell_height, xoff, yoff,
+        [grids](int r, int c) { return grids[r][c] > 0; });
+    this->fill_grid_spans(row, col, cell_width, cell_height, color, xoff, yoff);
+}
+
+void Plteen::DrawingContext::fill_grid(const uint8_t* cells, int row, int col, float cell_width, float cell_height, const RGBA32& color, float xoff, float yoff) {
+    this->buffer->scratch_rects.clear();
+    pen_span_cells(this->buffer->scratch_rects, row, col, cell_width, cell_height, xoff, yoff,
+        [cells, col](int r, int c) { return cells[r * col + c] != 0U; });
+    this->fill_grid_spans(row, col, cell_width, cell_height, color, xoff, yoff);
 }
 
 void Plteen::DrawingContext::stamp(SDL_Surface* surface, float x, float y, SDL_RendererFlip flip, double angle) {
@@ -625,10 +1265,11 @@ void Plteen::DrawingContext::stamp(SDL_Surface* surface, SDL_FRect* region, SDL_
 }
 
 void Plteen::DrawingContext::stamp(SDL_Surface* surface, SDL_Rect* src, SDL_FRect* dst, SDL_RendererFlip flip, double angle) {
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(this->device, surface);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(this->self(), surface);
 
     if (texture != nullptr) {
         this->stamp(texture, src, dst, flip, angle);
+        this->flush();
         SDL_DestroyTexture(texture);
     }
 }
@@ -654,75 +1295,130 @@ int Plteen::DrawingContext::stamp(SDL_Texture* texture, SDL_FRect* region, SDL_R
 }
 
 int Plteen::DrawingContext::stamp(SDL_Texture* texture, SDL_Rect* src, SDL_FRect* dst, SDL_RendererFlip flip, double angle) {
-    if ((flip == SDL_FLIP_NONE) && (angle == 0.0)) {
-        return SDL_RenderCopyF(this->device, texture, src, dst);
+    if (this->is_recording() && (dst != nullptr)) {
+        record_copy(this->buffer, texture, src, (*dst), angle, flip);
+
+        return 0;
+    } else if ((flip == SDL_FLIP_NONE) && (angle == 0.0)) {
+        return SDL_RenderCopyF(this->self(), texture, src, dst);
     } else {
-        return SDL_RenderCopyExF(this->device, texture, src, dst, angle, nullptr, flip);
+        return SDL_RenderCopyExF(this->self(), texture, src, dst, angle, nullptr, flip);
     }
 }
 
 /**************************************************************************************************/
-void Plteen::DrawingContext::draw_point(float x, float y, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawPointF(this->device, x, y);
+void Plteen::DrawingContext::draw_point(float x, float y, const RGBA32& color) {
+    if (this->is_recording()) {
+        SDL_FPoint pt = { x, y };
+
+        record_points(this->buffer, &pt, 1, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawPointF(this->self(), x, y);
+    }
 }
 
-void Plteen::DrawingContext::draw_line(float x1, float y1, float x2, float y2, const RGBA& color) {
-    aalineRGBA(this->device, fl2fx<int16_t>(x1), fl2fx<int16_t>(y1), fl2fx<int16_t>(x2), fl2fx<int16_t>(y2),
-                color.R(), color.G(), color.B(), color.A());
+/** NOTE
+ * SDL2_gfx draws horizontal, vertical and diagonal lines without anti-aliasing,
+ *   so do recorded ones, and the others are recorded as anti-aliased strips if geometries are available.
+ */
+void Plteen::DrawingContext::draw_line(float x1, float y1, float x2, float y2, const RGBA32& color) {
+    int16_t ix1 = fl2fx<int16_t>(x1);
+    int16_t iy1 = fl2fx<int16_t>(y1);
+    int16_t ix2 = fl2fx<int16_t>(x2);
+    int16_t iy2 = fl2fx<int16_t>(y2);
+
+    if (this->is_recording()) {
+        int dx = ix2 - ix1;
+        int dy = iy2 - iy1;
+
+        if ((dx == 0) || (dy == 0) || (dx == dy) || (dx == -dy)) {
+            record_line(this->buffer, float(ix1), float(iy1), float(ix2), float(iy2), color);
+        } else {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            std::vector<SDL_Vertex>& vertices = this->buffer->scratch_vertices;
+            SDL_FRect bounds = { float(fxmin(ix1, ix2)) - 1.0F, float(fxmin(iy1, iy2)) - 1.0F,
+                                 float(fxabs(dx)) + 3.0F, float(fxabs(dy)) + 3.0F };
+
+            vertices.clear();
+            pen_triangulate_aaline(vertices, float(ix1), float(iy1), float(ix2), float(iy2), rgba_to_color(color));
+            record_triangles(this->buffer, vertices.data(), int(vertices.size()), color, &bounds, SDL_BLENDMODE_BLEND);
+#else
+            aalineRGBA(this->self(), ix1, iy1, ix2, iy2, color.R(), color.G(), color.B(), color.A());
+#endif
+        }
+    } else {
+        aalineRGBA(this->self(), ix1, iy1, ix2, iy2, color.R(), color.G(), color.B(), color.A());
+    }
 }
 
-void Plteen::DrawingContext::draw_hline(float x, float y, float length, const RGBA& color) {
+void Plteen::DrawingContext::draw_hline(float x, float y, float length, const RGBA32& color) {
     this->draw_hline(fl2fx<int>(x), fl2fx<int>(y), fl2fx<int>(length), color);
 }
 
-void Plteen::DrawingContext::draw_vline(float x, float y, float length, const RGBA& color) {
+void Plteen::DrawingContext::draw_vline(float x, float y, float length, const RGBA32& color) {
     this->draw_vline(fl2fx<int>(x), fl2fx<int>(y), fl2fx<int>(length), color);
 }
 
-void Plteen::DrawingContext::draw_points(const SDL_FPoint* pts, int size, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawPointsF(this->device, pts, size);
+void Plteen::DrawingContext::draw_points(const SDL_FPoint* pts, int size, const RGBA32& color) {
+    if (this->is_recording()) {
+        record_points(this->buffer, pts, size, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawPointsF(this->self(), pts, size);
+    }
 }
 
-void Plteen::DrawingContext::draw_lines(const SDL_FPoint* pts, int size, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawLinesF(this->device, pts, size);
+void Plteen::DrawingContext::draw_lines(const SDL_FPoint* pts, int size, const RGBA32& color) {
+    if (this->is_recording()) {
+        record_lines(this->buffer, pts, size, color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawLinesF(this->self(), pts, size);
+    }
 }
 
-void Plteen::DrawingContext::draw_rect(SDL_FRect* box, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderDrawRectF(this->device, box);
+void Plteen::DrawingContext::draw_rect(SDL_FRect* box, const RGBA32& color) {
+    if (this->is_recording() && (box != nullptr)) {
+        record_rect(this->buffer, DrawCommandType::DrawRects, (*box), color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawRectF(this->self(), box);
+    }
 }
 
-void Plteen::DrawingContext::fill_rect(SDL_FRect* box, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    SDL_RenderFillRectF(this->device, box);
+void Plteen::DrawingContext::fill_rect(SDL_FRect* box, const RGBA32& color) {
+    if (this->is_recording() && (box != nullptr)) {
+        record_rect(this->buffer, DrawCommandType::FillRects, (*box), color);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderFillRectF(this->self(), box);
+    }
 }
 
-void Plteen::DrawingContext::draw_rect(float x, float y, float width, float height, const RGBA& color) {
+void Plteen::DrawingContext::draw_rect(float x, float y, float width, float height, const RGBA32& color) {
     SDL_FRect box;
 
     FILL_BOX(box, x, y, width, height);
     this->draw_rect(&box, color);
 }
 
-void Plteen::DrawingContext::fill_rect(float x, float y, float width, float height, const RGBA& color) {
+void Plteen::DrawingContext::fill_rect(float x, float y, float width, float height, const RGBA32& color) {
     SDL_FRect box;
 
     FILL_BOX(box, x, y, width, height);
     this->fill_rect(&box, color);
 }
 
-void Plteen::DrawingContext::draw_rounded_rect(SDL_FRect* box, float rad, const RGBA& color) {
+void Plteen::DrawingContext::draw_rounded_rect(SDL_FRect* box, float rad, const RGBA32& color) {
     this->draw_rounded_rect(box->x, box->y, box->w, box->h, rad, color);
 }
 
-void Plteen::DrawingContext::fill_rounded_rect(SDL_FRect* box, float rad, const RGBA& color) {
+void Plteen::DrawingContext::fill_rounded_rect(SDL_FRect* box, float rad, const RGBA32& color) {
     this->fill_rounded_rect(box->x, box->y, box->w, box->h, rad, color);
 }
 
-void Plteen::DrawingContext::draw_rounded_rect(float x, float y, float width, float height, float radius, const RGBA& color) {
+void Plteen::DrawingContext::draw_rounded_rect(float x, float y, float width, float height, float radius, const RGBA32& color) {
     int16_t X1 = fl2fx<int16_t>(x);
     int16_t Y1 = fl2fx<int16_t>(y);
     int16_t X2 = fl2fx<int16_t>(x + width);
@@ -734,10 +1430,10 @@ void Plteen::DrawingContext::draw_rounded_rect(float x, float y, float width, fl
     }
 
     rad = fl2fx<int16_t>(flmin(radius, height * 0.5F));
-    roundedRectangleRGBA(this->device, X1, Y1, X2, Y2, rad, color.R(), color.G(), color.B(), color.A());
+    roundedRectangleRGBA(this->self(), X1, Y1, X2, Y2, rad, color.R(), color.G(), color.B(), color.A());
 }
 
-void Plteen::DrawingContext::fill_rounded_rect(float x, float y, float width, float height, float radius, const RGBA& color) {
+void Plteen::DrawingContext::fill_rounded_rect(float x, float y, float width, float height, float radius, const RGBA32& color) {
     int16_t X1 = fl2fx<int16_t>(x);
     int16_t Y1 = fl2fx<int16_t>(y);
     int16_t X2 = fl2fx<int16_t>(x + width);
@@ -749,34 +1445,34 @@ void Plteen::DrawingContext::fill_rounded_rect(float x, float y, float width, fl
     }
 
     rad = fl2fx<int16_t>(flmin(radius, height * 0.5F));
-    roundedBoxRGBA(this->device, X1, Y1, X2, Y2, rad, color.R(), color.G(), color.B(), color.A());
+    roundedBoxRGBA(this->self(), X1, Y1, X2, Y2, rad, color.R(), color.G(), color.B(), color.A());
 }
 
-void Plteen::DrawingContext::draw_square(float cx, float cy, float apothem, const RGBA& color) {
+void Plteen::DrawingContext::draw_square(float cx, float cy, float apothem, const RGBA32& color) {
     this->draw_rect(cx - apothem, cy - apothem, apothem * 2.0F, apothem * 2.0F, color);
 }
 
-void Plteen::DrawingContext::fill_square(float cx, float cy, float apothem, const RGBA& color) {
+void Plteen::DrawingContext::fill_square(float cx, float cy, float apothem, const RGBA32& color) {
     this->fill_rect(cx - apothem, cy - apothem, apothem * 2.0F, apothem * 2.0F, color);
 }
 
-void Plteen::DrawingContext::draw_rounded_square(float cx, float cy, float apothem, float rad, const RGBA& color) {
+void Plteen::DrawingContext::draw_rounded_square(float cx, float cy, float apothem, float rad, const RGBA32& color) {
     this->draw_rounded_rect(cx - apothem, cy - apothem, apothem * 2.0F, apothem * 2.0F, rad, color);
 }
 
-void Plteen::DrawingContext::fill_rounded_square(float cx, float cy, float apothem, float rad, const RGBA& color) {
+void Plteen::DrawingContext::fill_rounded_square(float cx, float cy, float apothem, float rad, const RGBA32& color) {
     this->fill_rounded_rect(cx - apothem, cy - apothem, apothem * 2.0F, apothem * 2.0F, rad, color);
 }
 
-void Plteen::DrawingContext::draw_circle(float cx, float cy, float radius, const RGBA& color) {
+void Plteen::DrawingContext::draw_circle(float cx, float cy, float radius, const RGBA32& color) {
     int16_t CX = fl2fx<int16_t>(cx);
     int16_t CY = fl2fx<int16_t>(cy);
     int16_t R = fl2fx<int16_t>(radius);
     
-    aacircleRGBA(this->device, CX, CY, R, color.R(), color.G(), color.B(), color.A());
+    aacircleRGBA(this->self(), CX, CY, R, color.R(), color.G(), color.B(), color.A());
 }
 
-void Plteen::DrawingContext::fill_circle(float cx, float cy, float radius, const RGBA& color) {
+void Plteen::DrawingContext::fill_circle(float cx, float cy, float radius, const RGBA32& color) {
     int16_t CX = fl2fx<int16_t>(cx);
     int16_t CY = fl2fx<int16_t>(cy);
     int16_t R = fl2fx<int16_t>(radius);
@@ -785,11 +1481,11 @@ void Plteen::DrawingContext::fill_circle(float cx, float cy, float radius, const
     uint8_t b = color.B();
     uint8_t a = color.A();
     
-    filledCircleRGBA(this->device, CX, CY, R, r, g, b, a);
-    aacircleRGBA(this->device, CX, CY, R, r, g, b, a);
+    filledCircleRGBA(this->self(), CX, CY, R, r, g, b, a);
+    aacircleRGBA(this->self(), CX, CY, R, r, g, b, a);
 }
 
-void Plteen::DrawingContext::draw_ellipse(float cx, float cy, float ar, float br, const RGBA& color) {
+void Plteen::DrawingContext::draw_ellipse(float cx, float cy, float ar, float br, const RGBA32& color) {
     int16_t CX = fl2fx<int16_t>(cx);
     int16_t CY = fl2fx<int16_t>(cy);
     int16_t AR = fl2fx<int16_t>(ar);
@@ -800,13 +1496,13 @@ void Plteen::DrawingContext::draw_ellipse(float cx, float cy, float ar, float br
     uint8_t a = color.A();
     
     if (AR == BR) {
-        aacircleRGBA(this->device, CX, CY, AR, r, g, b, a);
+        aacircleRGBA(this->self(), CX, CY, AR, r, g, b, a);
     } else {
-        aaellipseRGBA(this->device, CX, CY, AR, BR, r, g, b, a);
+        aaellipseRGBA(this->self(), CX, CY, AR, BR, r, g, b, a);
     }
 }
 
-void Plteen::DrawingContext::fill_ellipse(float cx, float cy, float ar, float br, const RGBA& color) {
+void Plteen::DrawingContext::fill_ellipse(float cx, float cy, float ar, float br, const RGBA32& color) {
     int16_t CX = fl2fx<int16_t>(cx);
     int16_t CY = fl2fx<int16_t>(cy);
     int16_t AR = fl2fx<int16_t>(ar);
@@ -817,28 +1513,95 @@ void Plteen::DrawingContext::fill_ellipse(float cx, float cy, float ar, float br
     uint8_t a = color.A();
     
     if (AR == BR) {
-        filledCircleRGBA(this->device, CX, CY, AR, r, g, b, a);
-        aacircleRGBA(this->device, CX, CY, BR, r, g, b, a);
+        filledCircleRGBA(this->self(), CX, CY, AR, r, g, b, a);
+        aacircleRGBA(this->self(), CX, CY, BR, r, g, b, a);
+    } else {
+        filledEllipseRGBA(this->self(), CX, CY, AR, BR, r, g, b, a);
+        aaellipseRGBA(this->self(), CX, CY, AR, BR, r, g, b, a);
+    }
+}
+
+void Plteen::DrawingContext::draw_regular_polygon(int n, float cx, float cy, float radius, float rotation, const RGBA32& color) {
+    std::vector<SDL_FPoint>& pts = this->buffer->scratch_points;
+
+    pts.clear();
+    pen_trace_regular_polygon(pts, n, cx, cy, radius, rotation);
+
+    if (pts.size() == 1U) {
+        this->draw_point(cx, cy, color);
+    } else if (this->is_recording()) {
+        record_lines(this->buffer, pts.data(), int(pts.size()), color);
     } else {
-        filledEllipseRGBA(this->device, CX, CY, AR, BR, r, g, b, a);
-        aaellipseRGBA(this->device, CX, CY, AR, BR, r, g, b, a);
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawLinesF(this->self(), pts.data(), int(pts.size()));
     }
 }
 
-void Plteen::DrawingContext::draw_regular_polygon(int n, float cx, float cy, float radius, float rotation, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    pen_draw_regular_polygon(this->device, n, cx, cy, radius, rotation);
+void Plteen::DrawingContext::fill_regular_polygon(int n, float cx, float cy, float radius, float rotation, const RGBA32& color) {
+    std::vector<SDL_FPoint>& pts = this->buffer->scratch_points;
+
+    pts.clear();
+
+    if (n < 3) {
+        this->draw_regular_polygon(n, cx, cy, radius, rotation, color);
+    } else {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        std::vector<SDL_Vertex>& vertices = this->buffer->scratch_vertices;
+        SDL_FRect bounds = { cx - radius, cy - radius, radius * 2.0F, radius * 2.0F };
+
+        vertices.clear();
+        pen_triangulate_regular_polygon(vertices, pts, n, cx, cy, radius, rotation, rgba_to_color(color));
+
+        if (this->is_recording()) {
+            record_triangles(this->buffer, vertices.data(), int(vertices.size()), color, &bounds);
+        } else {
+            SDL_RenderGeometry(this->self(), nullptr, vertices.data(), int(vertices.size()), nullptr, 0);
+        }
+#else
+        this->buffer->scratch_rects.clear();
+        pen_span_regular_polygon(this->buffer->scratch_rects, pts, n, cx, cy, radius, rotation);
+        this->fill_scratch_rects(cx - radius, cy - radius, radius * 2.0F, radius * 2.0F, color);
+#endif
+    }
 }
 
-void Plteen::DrawingContext::fill_regular_polygon(int n, float cx, float cy, float radius, float rotation, const RGBA& color) {
-    SDL_SetRenderDrawColor(this->device, color.R(), color.G(), color.B(), color.A());
-    pen_fill_regular_polygon(this->device, n, cx, cy, radius, rotation);
+/*************************************************************************************************/
+void Plteen::DrawingContext::draw_scratch_points(int cx, int cy, int ar, int br, const RGBA32& color) {
+    std::vector<SDL_FPoint>& pts = this->buffer->scratch_points;
+
+    if (this->is_recording()) {
+        SDL_FRect bounds = { float(cx - ar), float(cy - br), float(ar * 2 + 1), float(br * 2 + 1) };
+
+        record_points(this->buffer, pts.data(), int(pts.size()), color, &bounds);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderDrawPointsF(this->self(), pts.data(), int(pts.size()));
+    }
+}
+
+void Plteen::DrawingContext::fill_scratch_rects(float x, float y, float width, float height, const RGBA32& color) {
+    std::vector<SDL_FRect>& spans = this->buffer->scratch_rects;
+
+    if (this->is_recording()) {
+        SDL_FRect bounds = { x, y, width, height };
+
+        record_rects(this->buffer, DrawCommandType::FillRects, spans.data(), int(spans.size()), color, &bounds);
+    } else {
+        SDL_SetRenderDrawColor(this->self(), color.R(), color.G(), color.B(), color.A());
+        SDL_RenderFillRectsF(this->self(), spans.data(), int(spans.size()));
+    }
+}
+
+void Plteen::DrawingContext::fill_grid_spans(int row, int col, float cell_width, float cell_height, const RGBA32& color, float xoff, float yoff) {
+    if (!this->buffer->scratch_rects.empty()) {
+        this->fill_scratch_rects(xoff, yoff, float(col) * cell_width, float(row) * cell_height, color);
+    }
 }
 
 /*************************************************************************************************/
 SDL_Texture* Plteen::DrawingContext::create_text_texture(const std::string& text, const shared_font_t& font, TextRenderMode mode, const RGBA& fgc, const RGBA& bgc, int wrap) {
     SDL_Surface* surface = game_text_surface(this->_disable_font_selection, text, font, mode, fgc, bgc, wrap);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(this->device, surface);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(this->self(), surface);
 
     SDL_FreeSurface(surface);
 
@@ -877,8 +1640,10 @@ void Plteen::DrawingContext::draw_lcd_text(const std::string& text, const shared
 }
 
 void Plteen::DrawingContext::draw_blended_text(const std::string& text, const shared_font_t& font, int x, int y, const RGBA& rgb, int wrap) {
-    SDL_Surface* message = game_text_surface(this->_disable_font_selection, text, font, ::TextRenderMode::Blender, rgb, rgb, wrap);
-    safe_render_text_surface(this, message, x, y);
+    if (!this->draw_cached_text(text, font, float(x), float(y), rgb, wrap)) {
+        SDL_Surface* message = game_text_surface(this->_disable_font_selection, text, font, ::TextRenderMode::Blender, rgb, rgb, wrap);
+        safe_render_text_surface(this, message, x, y);
+    }
 }
 
 void Plteen::DrawingContext::draw_solid_text(const std::string& text, const shared_font_t& font, float x, float y, const RGBA& rgb, int wrap) {
@@ -897,6 +1662,56 @@ void Plteen::DrawingContext::draw_lcd_text(const std::string& text, const shared
 }
 
 void Plteen::DrawingContext::draw_blended_text(const std::string& text, const shared_font_t& font, float x, float y, const RGBA& rgb, int wrap) {
-    SDL_Surface* message = game_text_surface(this->_disable_font_selection, text, font, ::TextRenderMode::Blender, rgb, rgb, wrap);
-    safe_render_text_surface(this, message, x, y);
+    if (!this->draw_cached_text(text, font, x, y, rgb, wrap)) {
+        SDL_Surface* message = game_text_surface(this->_disable_font_selection, text, font, ::TextRenderMode::Blender, rgb, rgb, wrap);
+        safe_render_text_surface(this, message, x, y);
+    }
+}
+
+/**
+ * Texts wrapped by width are left to SDL_ttf,
+ *   and so are those in fonts that cannot be used.
+ */
+bool Plteen::DrawingContext::draw_cached_text(const std::string& text, const shared_font_t& font, float x, float y, const RGBA& rgb, int wrap) {
+    shared_font_t f = (this->_disable_font_selection) ? font : select_shared_font(font, text);
+    const ShapedRun* run = nullptr;
+    
+    if ((wrap <= 0) && f->okay()) {
+        run = this->glyphs->shape(this->device, f, text);
+
+        if (run != nullptr) {
+            SDL_Texture* atlas = nullptr;
+            SDL_FRect dst;
+            uint8_t r, g, b, a;
+
+            rgb.unbox(&r, &g, &b, &a);
+
+            for (const GlyphQuad& q : run->quads) {
+                if (q.atlas != atlas) {
+                    if (atlas != nullptr) {
+                        SDL_SetTextureColorMod(atlas, 0xFFU, 0xFFU, 0xFFU);
+                        SDL_SetTextureAlphaMod(atlas, 0xFFU);
+                    }
+
+                    atlas = q.atlas;
+                    SDL_SetTextureColorMod(atlas, r, g, b);
+                    SDL_SetTextureAlphaMod(atlas, a);
+                }
+
+                dst.x = x + float(q.x);
+                dst.y = y + float(q.y);
+                dst.w = float(q.src.w);
+                dst.h = float(q.src.h);
+
+                this->stamp(atlas, const_cast<SDL_Rect*>(&q.src), &dst);
+            }
+
+            if (atlas != nullptr) {
+                SDL_SetTextureColorMod(atlas, 0xFFU, 0xFFU, 0xFFU);
+                SDL_SetTextureAlphaMod(atlas, 0xFFU);
+            }
+        }
+    }
+
+    return (run != nullptr);
 }
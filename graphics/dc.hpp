@@ -8,19 +8,27 @@
 #include <string>
 
 #include "font.hpp"
+#include "glyph.hpp"
 
 #include "../physics/color/rgba.hpp"
 
 namespace Plteen {
     enum TextRenderMode { Solid, Shaded, Blender, LCD };
 
+    struct DrawCommandBuffer;
+
     class __lambda__ DrawingContext {
     public:
         DrawingContext(SDL_Renderer* device);
         ~DrawingContext() noexcept;
 
     public:
-        SDL_Renderer* self() const { return this->device; }
+        /** NOTE
+         * `self()` submits recorded commands before handing out the renderer, so that direct SDL drawing keeps the order,
+         *   `unsafe_self()` does not, and is for calls that never draw, say, creating textures or querying states.
+         */
+        SDL_Renderer* self() { this->flush(); return this->device; }
+        SDL_Renderer* unsafe_self() { return this->device; }
         const char* name() const { return this->info.name; }
 
     public:
@@ -28,28 +36,53 @@ namespace Plteen {
         SDL_Surface* snapshot(int width, int height);
 
     public:
-        void clear(const Plteen::RGBA& color);
+        void clear(const Plteen::RGBA32& color);
         void reset(const Plteen::RGBA& fgc, const Plteen::RGBA& bgc);
         void reset(SDL_Texture* texture, const Plteen::RGBA& fgc, const Plteen::RGBA& bgc);
         void refresh(SDL_Texture* texture);
 
+    public:
+        /** NOTE
+         * While recording, stamps, rectangles, lines and points are buffered and merged into batches,
+         *   which are submitted at the end of recording, or right before anything else touches the renderer.
+         * The order of commands is always kept, hence overlapped things are still drawn correctly,
+         *   and clipping regions are recorded as well, so that they do not break batches.
+         */
+        void begin_recording();
+        void end_recording();
+        bool is_recording() { return (this->recording_depth > 0); }
+        void flush();
+
     public:
         SDL_Texture* create_blank_image(int width, int height);
         SDL_Texture* create_blank_image(float width, float height);
         SDL_Texture* get_target() { return SDL_GetRenderTarget(this->device); }
-        int set_draw_color(const Plteen::RGBA& color);
-        int set_target(SDL_Texture* target) { return SDL_SetRenderTarget(this->device, target); }
-        bool set_clipping_region(SDL_Rect* rect) { return SDL_RenderSetClipRect(this->device, rect); }
+        int set_draw_color(const Plteen::RGBA32& color);
+        int set_target(SDL_Texture* target);
+        bool set_clipping_region(SDL_Rect* rect);
         bool clear_clipping_region() { return this->set_clipping_region(nullptr); }
+        bool feed_clipping_region(SDL_Rect* rect);
 
-    public:
-        void draw_frame(int x, int y, int width, int height, const Plteen::RGBA& color);
-        void draw_grid(int row, int col, int cell_width, int cell_height, const Plteen::RGBA& color, int xoff = 0, int yoff = 0);
-        void fill_grid(int* grids[], int row, int col, int cell_width, int cell_height, const Plteen::RGBA& color, int xoff = 0, int yoff = 0);
+        /* contents of target textures are lost whenever this changes, clients baking their own targets have to redraw them */
+        uint64_t get_target_generation();
 
-        void draw_frame(float x, float y, float width, float height, const Plteen::RGBA& color);
-        void draw_grid(int row, int col, float cell_width, float cell_height, const Plteen::RGBA& color, float xoff = 0.0F, float yoff = 0.0F);
-        void fill_grid(int* grids[], int row, int col, float cell_width, float cell_height, const Plteen::RGBA& color, float xoff = 0.0F, float yoff = 0.0F);
+    public:
+        void draw_frame(int x, int y, int width, int height, const Plteen::RGBA32& color);
+        void draw_grid(int row, int col, int cell_width, int cell_height, const Plteen::RGBA32& color, int xoff = 0, int yoff = 0);
+        void fill_grid(int* grids[], int row, int col, int cell_width, int cell_height, const Plteen::RGBA32& color, int xoff = 0, int yoff = 0);
+        void fill_grid(const uint8_t* cells, int row, int col, int cell_width, int cell_height, const Plteen::RGBA32& color, int xoff = 0, int yoff = 0);
+
+        void draw_frame(float x, float y, float width, float height, const Plteen::RGBA32& color);
+        void draw_grid(int row, int col, float cell_width, float cell_height, const Plteen::RGBA32& color, float xoff = 0.0F, float yoff = 0.0F);
+        void fill_grid(int* grids[], int row, int col, float cell_width, float cell_height, const Plteen::RGBA32& color, float xoff = 0.0F, float yoff = 0.0F);
+        void fill_grid(const uint8_t* cells, int row, int col, float cell_width, float cell_height, const Plteen::RGBA32& color, float xoff = 0.0F, float yoff = 0.0F);
+
+        /** NOTE
+         * Grids are drawn in one submission, and `cells` of `fill_grid` are row-major, non-zero ones are filled.
+         * The cached one bakes the grid into a texture the first time, and stamps it afterwards at whole pixels,
+         *   grids that are too large to bake fall back to `draw_grid`.
+         */
+        void draw_cached_grid(int row, int col, float cell_width, float cell_height, const Plteen::RGBA32& color, float xoff = 0.0F, float yoff = 0.0F);
 
         void stamp(SDL_Surface* surface, int x, int y, SDL_RendererFlip flip = SDL_FLIP_NONE, double angle = 0.0);
         void stamp(SDL_Surface* surface, int x, int y, int widht, int height, SDL_RendererFlip flip = SDL_FLIP_NONE, double angle = 0.0);
@@ -72,76 +105,83 @@ namespace Plteen {
         int stamp(SDL_Texture* texture, SDL_Rect* src, SDL_FRect* dst, SDL_RendererFlip flip = SDL_FLIP_NONE, double angle = 0.0);
         
     public:
-        void draw_point(int x, int y, const Plteen::RGBA& color);
-        void draw_line(int x1, int y1, int x2, int y2, const Plteen::RGBA& color);
-        void draw_hline(int x, int y, int length, const Plteen::RGBA& color);
-        void draw_vline(int x, int y, int length, const Plteen::RGBA& color);
+        void draw_point(int x, int y, const Plteen::RGBA32& color);
+        void draw_line(int x1, int y1, int x2, int y2, const Plteen::RGBA32& color);
+        void draw_hline(int x, int y, int length, const Plteen::RGBA32& color);
+        void draw_vline(int x, int y, int length, const Plteen::RGBA32& color);
 
-        void draw_points(const SDL_Point* pts, int size, const Plteen::RGBA& color);
-        void draw_lines(const SDL_Point* pts, int size, const Plteen::RGBA& color);
+        void draw_points(const SDL_Point* pts, int size, const Plteen::RGBA32& color);
+        void draw_lines(const SDL_Point* pts, int size, const Plteen::RGBA32& color);
         
-        void draw_rect(SDL_Rect* box, const Plteen::RGBA& color);
-        void fill_rect(SDL_Rect* box, const Plteen::RGBA& color);
-        void draw_rect(int x, int y, int width, int height, const Plteen::RGBA& color);
-        void fill_rect(int x, int y, int width, int height, const Plteen::RGBA& color);
+        void draw_rect(SDL_Rect* box, const Plteen::RGBA32& color);
+        void fill_rect(SDL_Rect* box, const Plteen::RGBA32& color);
+        void draw_rect(int x, int y, int width, int height, const Plteen::RGBA32& color);
+        void fill_rect(int x, int y, int width, int height, const Plteen::RGBA32& color);
         
-        void draw_rounded_rect(SDL_Rect* box, float rad, const Plteen::RGBA& color);
-        void fill_rounded_rect(SDL_Rect* box, float rad, const Plteen::RGBA& color);
-        void draw_rounded_rect(int x, int y, int width, int height, float rad, const Plteen::RGBA& color);
-        void fill_rounded_rect(int x, int y, int width, int height, float rad, const Plteen::RGBA& color);
+        void draw_rounded_rect(SDL_Rect* box, float rad, const Plteen::RGBA32& color);
+        void fill_rounded_rect(SDL_Rect* box, float rad, const Plteen::RGBA32& color);
+        void draw_rounded_rect(int x, int y, int width, int height, float rad, const Plteen::RGBA32& color);
+        void fill_rounded_rect(int x, int y, int width, int height, float rad, const Plteen::RGBA32& color);
         
-        void draw_square(int cx, int cy, int apothem, const Plteen::RGBA& color);
-        void fill_square(int cx, int cy, int apothem, const Plteen::RGBA& color);
+        void draw_square(int cx, int cy, int apothem, const Plteen::RGBA32& color);
+        void fill_square(int cx, int cy, int apothem, const Plteen::RGBA32& color);
         
-        void draw_rounded_square(int cx, int cy, int apothem, float rad, const Plteen::RGBA& color);
-        void fill_rounded_square(int cx, int cy, int apothem, float rad, const Plteen::RGBA& color);
+        void draw_rounded_square(int cx, int cy, int apothem, float rad, const Plteen::RGBA32& color);
+        void fill_rounded_square(int cx, int cy, int apothem, float rad, const Plteen::RGBA32& color);
         
-        void draw_circle(int cx, int cy, int radius, const Plteen::RGBA& color);
-        void fill_circle(int cx, int cy, int radius, const Plteen::RGBA& color);
+        void draw_circle(int cx, int cy, int radius, const Plteen::RGBA32& color);
+        void fill_circle(int cx, int cy, int radius, const Plteen::RGBA32& color);
         
-        void draw_ellipse(int cx, int cy, int aradius, int bradius, const Plteen::RGBA& color);
-        void fill_ellipse(int cx, int cy, int aradius, int bradius, const Plteen::RGBA& color);
+        void draw_ellipse(int cx, int cy, int aradius, int bradius, const Plteen::RGBA32& color);
+        void fill_ellipse(int cx, int cy, int aradius, int bradius, const Plteen::RGBA32& color);
         
-        void draw_regular_polygon(int n, int cx, int cy, int radius, float rotation, const Plteen::RGBA& color);
-        void fill_regular_polygon(int n, int cx, int cy, int radius, float rotation, const Plteen::RGBA& color);
+        void draw_regular_polygon(int n, int cx, int cy, int radius, float rotation, const Plteen::RGBA32& color);
+        void fill_regular_polygon(int n, int cx, int cy, int radius, float rotation, const Plteen::RGBA32& color);
         
     public:
-        void draw_point(float x, float y, const Plteen::RGBA& color);
-        void draw_line(float x1, float y1, float x2, float y2, const Plteen::RGBA& color);
-        void draw_hline(float x, float y, float length, const Plteen::RGBA& color);
-        void draw_vline(float x, float y, float length, const Plteen::RGBA& color);
+        void draw_point(float x, float y, const Plteen::RGBA32& color);
+        void draw_line(float x1, float y1, float x2, float y2, const Plteen::RGBA32& color);
+        void draw_hline(float x, float y, float length, const Plteen::RGBA32& color);
+        void draw_vline(float x, float y, float length, const Plteen::RGBA32& color);
         
-        void draw_points(const SDL_FPoint* pts, int size, const Plteen::RGBA& color);
-        void draw_lines(const SDL_FPoint* pts, int size, const Plteen::RGBA& color);
+        void draw_points(const SDL_FPoint* pts, int size, const Plteen::RGBA32& color);
+        void draw_lines(const SDL_FPoint* pts, int size, const Plteen::RGBA32& color);
         
-        void draw_rect(SDL_FRect* box, const Plteen::RGBA& color);
-        void fill_rect(SDL_FRect* box, const Plteen::RGBA& color);
-        void draw_rect(float x, float y, float width, float height, const Plteen::RGBA& color);
-        void fill_rect(float x, float y, float width, float height, const Plteen::RGBA& color);
+        void draw_rect(SDL_FRect* box, const Plteen::RGBA32& color);
+        void fill_rect(SDL_FRect* box, const Plteen::RGBA32& color);
+        void draw_rect(float x, float y, float width, float height, const Plteen::RGBA32& color);
+        void fill_rect(float x, float y, float width, float height, const Plteen::RGBA32& color);
         
-        void draw_rounded_rect(SDL_FRect* box, float rad, const Plteen::RGBA& color);
-        void fill_rounded_rect(SDL_FRect* box, float rad, const Plteen::RGBA& color);
-        void draw_rounded_rect(float x, float y, float width, float height, float rad, const Plteen::RGBA& color);
-        void fill_rounded_rect(float x, float y, float width, float height, float rad, const Plteen::RGBA& color);
+        void draw_rounded_rect(SDL_FRect* box, float rad, const Plteen::RGBA32& color);
+        void fill_rounded_rect(SDL_FRect* box, float rad, const Plteen::RGBA32& color);
+        void draw_rounded_rect(float x, float y, float width, float height, float rad, const Plteen::RGBA32& color);
+        void fill_rounded_rect(float x, float y, float width, float height, float rad, const Plteen::RGBA32& color);
         
-        void draw_square(float cx, float cy, float apothem, const Plteen::RGBA& color);
-        void fill_square(float cx, float cy, float apothem, const Plteen::RGBA& color);
+        void draw_square(float cx, float cy, float apothem, const Plteen::RGBA32& color);
+        void fill_square(float cx, float cy, float apothem, const Plteen::RGBA32& color);
         
-        void draw_circle(float cx, float cy, float radius, const Plteen::RGBA& color);
-        void fill_circle(float cx, float cy, float radius, const Plteen::RGBA& color);
+        void draw_circle(float cx, float cy, float radius, const Plteen::RGBA32& color);
+        void fill_circle(float cx, float cy, float radius, const Plteen::RGBA32& color);
         
-        void draw_rounded_square(float cx, float cy, float apothem, float rad, const Plteen::RGBA& color);
-        void fill_rounded_square(float cx, float cy, float apothem, float rad, const Plteen::RGBA& color);
+        void draw_rounded_square(float cx, float cy, float apothem, float rad, const Plteen::RGBA32& color);
+        void fill_rounded_square(float cx, float cy, float apothem, float rad, const Plteen::RGBA32& color);
         
-        void draw_ellipse(float cx, float cy, float aradius, float bradius, const Plteen::RGBA& color);
-        void fill_ellipse(float cx, float cy, float aradius, float bradius, const Plteen::RGBA& color);
+        void draw_ellipse(float cx, float cy, float aradius, float bradius, const Plteen::RGBA32& color);
+        void fill_ellipse(float cx, float cy, float aradius, float bradius, const Plteen::RGBA32& color);
         
-        void draw_regular_polygon(int n, float cx, float cy, float radius, float rotation, const Plteen::RGBA& color);
-        void fill_regular_polygon(int n, float cx, float cy, float radius, float rotation, const Plteen::RGBA& color);
+        void draw_regular_polygon(int n, float cx, float cy, float radius, float rotation, const Plteen::RGBA32& color);
+        void fill_regular_polygon(int n, float cx, float cy, float radius, float rotation, const Plteen::RGBA32& color);
 
     public:
         void disable_font_selection(bool yes) { this->_disable_font_selection = yes; }
 
+        /** NOTE
+         * Blended texts without pixel wrapping are drawn as quads of the glyph atlases,
+         *   the cache of shaped runs holds `capacity` most recently drawn strings.
+         */
+        void set_text_cache_capacity(size_t capacity) { this->glyphs->set_run_capacity(capacity); }
+        Plteen::GlyphCacheStatistics get_text_cache_statistics() { return this->glyphs->get_statistics(); }
+
         SDL_Texture* create_solid_text(const std::string& text, const shared_font_t& font, const Plteen::RGBA& fgc, int wrap = 0);
         SDL_Texture* create_shaded_text(const std::string& text, const shared_font_t& font, const Plteen::RGBA& fgc, const Plteen::RGBA& bgc, int wrap = 0);
         SDL_Texture* create_lcd_text(const std::string& text, const shared_font_t& font, const Plteen::RGBA& fgc, const Plteen::RGBA& bgc, int wrap = 0);
@@ -159,11 +199,24 @@ namespace Plteen {
 
     private:
         SDL_Texture* create_text_texture(const std::string& text, const shared_font_t& font, Plteen::TextRenderMode mode, const Plteen::RGBA& fgc, const Plteen::RGBA& bgc, int wrap = 0);
+        bool draw_cached_text(const std::string& text, const shared_font_t& font, float x, float y, const Plteen::RGBA& rgb, int wrap);
+        void draw_scratch_points(int cx, int cy, int ar, int br, const Plteen::RGBA32& color);
+        void fill_scratch_rects(float x, float y, float width, float height, const Plteen::RGBA32& color);
+        void fill_grid_spans(int row, int col, float cell_width, float cell_height, const Plteen::RGBA32& color, float xoff, float yoff);
+
+    private:
+        static void on_texture_retiring(SDL_Texture* texture, void* self);
+        static int on_render_event(void* self, SDL_Event* e);
 
     private:
         bool _disable_font_selection = false;
         SDL_RendererInfo info;
         SDL_Renderer* device = nullptr;
+
+    private:
+        Plteen::DrawCommandBuffer* buffer = nullptr;
+        Plteen::GlyphCache* glyphs = nullptr;
+        int recording_depth = 0;
     };
 
     typedef DrawingContext dc_t;
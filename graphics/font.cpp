@@ -2,6 +2,13 @@
 
 #include <unordered_map>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <charconv>
+#include <algorithm>
 
 #include "../datum/flonum.hpp"
 #include "../datum/string.hpp"
@@ -33,7 +40,14 @@ static int medium_fontsize = 16;
 
 /*************************************************************************************************/
 static std::unordered_map<std::string, std::string> system_fonts;
+static std::unordered_map<std::string, FontFaceInfo> system_faces;
 static std::unordered_map<std::string, std::string> basenames;
+static std::mutex system_fonts_mutex;
+static std::thread system_fonts_indexer;
+static std::atomic<bool> system_fonts_indexer_cancelled(false);
+
+/* opening and closing faces of the same FreeType library should be serialized */
+static std::mutex font_open_mutex;
 
 static std::string system_fontdirs[] = {
     "/System/Library/Fonts",
@@ -42,30 +56,331 @@ static std::string system_fontdirs[] = {
     "/usr/share/fonts"
 };
 
-static void game_push_fonts_of_directory(path& root) {
-    for (auto entry : directory_iterator(root)) {
+static const char* FONT_INDEX_MAGIC = "plteen-fonts";
+static const int FONT_INDEX_VERSION = 1;
+
+/** NOTE
+ * Coverages are probed with representative characters of Unicode blocks,
+ *   the bit of a block is set if the face provides its probe.
+ */
+struct UnicodeBlockProbe {
+    uint32_t first;
+    uint32_t last;
+    uint32_t probe;
+};
+
+static const UnicodeBlockProbe unicode_block_probes[] = {
+    { 0x0000U, 0x007FU, 'A' },       /* Basic Latin */
+    { 0x0080U, 0x024FU, 0x00E9U },   /* Latin-1 Supplement and Latin Extended */
+    { 0x0370U, 0x03FFU, 0x03B1U },   /* Greek */
+    { 0x0400U, 0x04FFU, 0x0430U },   /* Cyrillic */
+    { 0x0590U, 0x05FFU, 0x05D0U },   /* Hebrew */
+    { 0x0600U, 0x06FFU, 0x0627U },   /* Arabic */
+    { 0x0900U, 0x097FU, 0x0915U },   /* Devanagari */
+    { 0x0E00U, 0x0E7FU, 0x0E01U },   /* Thai */
+    { 0x2000U, 0x206FU, 0x2014U },   /* General Punctuation */
+    { 0x20A0U, 0x20CFU, 0x20ACU },   /* Currency Symbols */
+    { 0x2190U, 0x21FFU, 0x2192U },   /* Arrows */
+    { 0x2200U, 0x22FFU, 0x2211U },   /* Mathematical Operators */
+    { 0x2500U, 0x257FU, 0x2500U },   /* Box Drawing */
+    { 0x25A0U, 0x25FFU, 0x25A0U },   /* Geometric Shapes */
+    { 0x3000U, 0x303FU, 0x3002U },   /* CJK Symbols and Punctuation */
+    { 0x3040U, 0x309FU, 0x3042U },   /* Hiragana */
+    { 0x30A0U, 0x30FFU, 0x30A2U },   /* Katakana */
+    { 0x4E00U, 0x9FFFU, 0x4E2DU },   /* CJK Unified Ideographs */
+    { 0xAC00U, 0xD7AFU, 0xAC00U },   /* Hangul Syllables */
+    { 0xFF00U, 0xFFEFU, 0xFF01U },   /* Halfwidth and Fullwidth Forms */
+    { 0x1F300U, 0x1FAFFU, 0x1F600U } /* Emoji */
+};
+
+static inline int64_t directory_mtime(const path& dir) {
+    std::error_code ec;
+    int64_t mtime = -1; // for missing directories
+    
+    if (is_directory(dir, ec)) {
+        file_time_type t = last_write_time(dir, ec);
+
+        if (!ec) {
+            mtime = int64_t(t.time_since_epoch().count());
+        }
+    }
+
+    return mtime;
+}
+
+static inline TTF_Font* game_open_font(const char* pathname, int fontsize) {
+    std::lock_guard<std::mutex> guard(font_open_mutex);
+
+    return TTF_OpenFont(pathname, fontsize);
+}
+
+/**
+ * The index lives in the per-user data directory rather than the shared temporary one,
+ *   so that nobody else can plant it, and `""` means no index available.
+ */
+static inline std::string font_index_path() {
+    char* prefdir = SDL_GetPrefPath("plteen", "fonts");
+    std::string pathname;
+
+    if (prefdir != nullptr) {
+        pathname = std::string(prefdir) + "system.index";
+        SDL_free(prefdir);
+    }
+
+    return pathname;
+}
+
+static inline bool is_font_file(const path& file) {
+    std::string ext = file.extension().string();
+
+    for (auto& c : ext) {
+        c = char(tolower(c));
+    }
+
+    return (ext == ".ttf") || (ext == ".ttc") || (ext == ".otf") || (ext == ".otc");
+}
+
+static void game_push_fonts_of_directory(path& root, std::unordered_map<std::string, std::string>& fonts, std::vector<path>* dirs) {
+    std::error_code ec;
+
+    if (dirs != nullptr) {
+        dirs->push_back(root);
+    }
+
+    for (auto entry : directory_iterator(root, ec)) {
         path self = entry.path();
 
         if (entry.is_directory()) {
-            game_push_fonts_of_directory(self);
+            game_push_fonts_of_directory(self, fonts, dirs);
         } else if (entry.is_regular_file()) {
-            system_fonts[self.filename().string()] = self.string();
+            fonts[self.filename().string()] = self.string();
         }
     }
 }
 
-/*************************************************************************************************/
-void Plteen::game_fonts_initialize() {
-    for (unsigned int idx = 0; idx < sizeof(system_fontdirs) / sizeof(std::string); idx++) {
+static void game_probe_font_face(const std::string& pathname, FontFaceInfo* info) {
+    TTF_Font* font = nullptr;
+
+    info->pathname = pathname;
+    info->coverage = 0U;
+
+    if (is_font_file(path(pathname))) {
+        font = game_open_font(pathname.c_str(), 16);
+    }
+
+    if (font != nullptr) {
+        const char* family = TTF_FontFaceFamilyName(font);
+        const char* style = TTF_FontFaceStyleName(font);
+
+        info->family = (family == nullptr) ? "" : family;
+        info->style = (style == nullptr) ? "" : style;
+
+        for (size_t idx = 0; idx < sizeof(unicode_block_probes) / sizeof(UnicodeBlockProbe); idx ++) {
+            if (TTF_GlyphIsProvided32(font, unicode_block_probes[idx].probe)) {
+                info->coverage |= (1ULL << idx);
+            }
+        }
+
+        game_destory_font(font);
+    }
+}
+
+template<typename N>
+static inline bool unsafe_parse_index_field(const std::string& field, N* n, int radix) {
+    const char* end = field.data() + field.size();
+    auto result = std::from_chars(field.data(), end, (*n), radix);
+
+    return (result.ec == std::errc()) && (result.ptr == end) && (!field.empty());
+}
+
+/**
+ * The index is a text file of tab-separated fields, which is loaded by one read:
+ *   `D mtime path` for every directory that has been walked, missing roots included;
+ *   `F coverage family style path` for every file.
+ */
+static bool game_load_font_index(std::unordered_map<std::string, std::string>& fonts, std::unordered_map<std::string, FontFaceInfo>& faces, bool* stale) {
+    std::ifstream file(font_index_path(), std::ios::binary);
+    bool okay = false;
+
+    if (file.is_open()) {
+        std::stringstream content;
+        std::string line, magic;
+        int version = 0;
+
+        content << file.rdbuf();
+        content >> magic >> version;
+
+        if ((magic == FONT_INDEX_MAGIC) && (version == FONT_INDEX_VERSION)) {
+            std::vector<std::string> roots;
+
+            (*stale) = false;
+            okay = true;
+
+            while (std::getline(content, line)) {
+                std::vector<std::string> fields;
+                size_t start = 0U;
+                size_t tab = line.find('\t');
+
+                while (tab != std::string::npos) {
+                    fields.push_back(line.substr(start, tab - start));
+                    start = tab + 1U;
+                    tab = line.find('\t', start);
+                }
+
+                fields.push_back(line.substr(start));
+
+                if ((fields.size() == 3U) && (fields[0] == "D")) {
+                    int64_t mtime = 0;
+
+                    if (!unsafe_parse_index_field(fields[1], &mtime, 10) || (directory_mtime(path(fields[2])) != mtime)) {
+                        (*stale) = true;
+                    }
+
+                    roots.push_back(fields[2]);
+                } else if ((fields.size() == 5U) && (fields[0] == "F")) {
+                    uint64_t coverage = 0U;
+
+                    // bad lines are skipped, and the index is rebuilt
+                    if (!unsafe_parse_index_field(fields[1], &coverage, 16)) {
+                        (*stale) = true;
+                    } else {
+                        path self(fields[4]);
+                        FontFaceInfo* info = &faces[self.filename().string()];
+
+                        fonts[self.filename().string()] = fields[4];
+                        info->pathname = fields[4];
+                        info->family = fields[2];
+                        info->style = fields[3];
+                        info->coverage = coverage;
+                    }
+                }
+            }
+
+            for (unsigned int idx = 0; idx < sizeof(system_fontdirs) / sizeof(std::string); idx++) {
+                if (std::find(roots.begin(), roots.end(), system_fontdirs[idx]) == roots.end()) {
+                    (*stale) = true;
+                }
+            }
+        }
+    }
+
+    return okay;
+}
+
+static void game_rebuild_font_index() {
+    std::unordered_map<std::string, std::string> fonts;
+    std::unordered_map<std::string, FontFaceInfo> faces;
+    std::vector<path> dirs;
+    std::string index = font_index_path();
+    std::string temp = index + ".tmp";
+
+    bool written = false;
+    std::error_code ec;
+
+    for (unsigned int idx = 0; (!system_fonts_indexer_cancelled) && (idx < sizeof(system_fontdirs) / sizeof(std::string)); idx++) {
         path root(system_fontdirs[idx]);
 
         if (exists(root) && is_directory(root)) {
-            game_push_fonts_of_directory(root);
+            game_push_fonts_of_directory(root, fonts, &dirs);
+        } else {
+            dirs.push_back(root);
+        }
+    }
+
+    for (auto it = fonts.begin(); (!system_fonts_indexer_cancelled) && (it != fonts.end()); ++ it) {
+        game_probe_font_face(it->second, &faces[it->first]);
+    }
+
+    /* probing is cancelled at exit, and an incomplete index should not be saved */
+    if (!system_fonts_indexer_cancelled) {
+        if (!index.empty()) {
+            /* write to a temporary file first, so that a half-written index is never loaded */
+            std::ofstream file(temp, std::ios::binary);
+
+            if (file.is_open()) {
+                file << FONT_INDEX_MAGIC << " " << FONT_INDEX_VERSION << std::endl;
+
+                for (auto& dir : dirs) {
+                    file << "D\t" << directory_mtime(dir) << "\t" << dir.string() << std::endl;
+                }
+
+                for (auto& face : faces) {
+                    file << "F\t" << std::hex << face.second.coverage << std::dec
+                         << "\t" << face.second.family << "\t" << face.second.style
+                         << "\t" << face.second.pathname << std::endl;
+                }
+
+                file.close();
+                written = !file.fail();
+            }
+        }
+
+        if (written) {
+            rename(temp, index, ec);
+        } else if (!index.empty()) {
+            remove(temp, ec);
         }
+
+        system_fonts_mutex.lock();
+        system_fonts.swap(fonts);
+        system_faces.swap(faces);
+        system_fonts_mutex.unlock();
+    }
+}
+
+static inline std::string system_font_path(const std::string& face) {
+    std::string pathname;
+
+    system_fonts_mutex.lock();
+
+    if (system_fonts.find(face) != system_fonts.end()) {
+        pathname = system_fonts[face];
+    }
+
+    system_fonts_mutex.unlock();
+
+    return pathname;
+}
+
+/*************************************************************************************************/
+/** NOTE
+ * The index is loaded at startup, and is rebuilt in background only when any directory has changed,
+ *   the stale one serves in the meantime.
+ * Without an index, font files are collected by walking directories as usual,
+ *   and the rest of information is gathered in background.
+ */
+void Plteen::game_fonts_initialize() {
+    std::unordered_map<std::string, std::string> fonts;
+    std::unordered_map<std::string, FontFaceInfo> faces;
+    bool stale = true;
+
+    if (!game_load_font_index(fonts, faces, &stale)) {
+        for (unsigned int idx = 0; idx < sizeof(system_fontdirs) / sizeof(std::string); idx++) {
+            path root(system_fontdirs[idx]);
+
+            if (exists(root) && is_directory(root)) {
+                game_push_fonts_of_directory(root, fonts, nullptr);
+            }
+        }
+    }
+
+    system_fonts_mutex.lock();
+    system_fonts.swap(fonts);
+    system_faces.swap(faces);
+    system_fonts_mutex.unlock();
+
+    if (stale && !system_fonts_indexer.joinable()) {
+        system_fonts_indexer = std::thread(game_rebuild_font_index);
     }
 }
 
 void Plteen::game_fonts_destroy() {
+    if (system_fonts_indexer.joinable()) {
+        // the face being probed is finished, but the rest are left for the next run
+        system_fonts_indexer_cancelled = true;
+        system_fonts_indexer.join();
+    }
+
     /**
      * Please remeber to clear the fonts
      *   Or it will fail at exit due to segfault
@@ -74,6 +389,34 @@ void Plteen::game_fonts_destroy() {
     fontdb.clear();
 }
 
+bool Plteen::game_font_face_info(const char* basename, FontFaceInfo* info) {
+    bool found = false;
+
+    system_fonts_mutex.lock();
+
+    if (system_faces.find(basename) != system_faces.end()) {
+        (*info) = system_faces[basename];
+        found = true;
+    }
+
+    system_fonts_mutex.unlock();
+
+    return found;
+}
+
+uint64_t Plteen::game_font_coverage_mask(uint32_t ch) {
+    uint64_t mask = 0U;
+
+    for (size_t idx = 0; idx < sizeof(unicode_block_probes) / sizeof(UnicodeBlockProbe); idx ++) {
+        if ((ch >= unicode_block_probes[idx].first) && (ch <= unicode_block_probes[idx].last)) {
+            mask = (1ULL << idx);
+            break;
+        }
+    }
+
+    return mask;
+}
+
 int Plteen::generic_font_size(FontSize size) {
     // It's okay to work with integer-division
     switch (size) {
@@ -145,16 +488,17 @@ const char* Plteen::generic_font_family_name_for_chinese(FontFamily family) {
 /*************************************************************************************************/
 shared_font_t Plteen::game_create_shared_font(const char* face, int fontsize) {
     std::string face_key(face);
+    std::string pathname = system_font_path(face_key);
     font_key_t font_key;
     
-    if (system_fonts.find(face_key) == system_fonts.end()) {
+    if (pathname.empty()) {
         font_key = std::tuple<std::string, int>(face_key, fontsize);
     } else {
-        font_key = std::tuple<std::string, int>(system_fonts[face_key], fontsize);
+        font_key = std::tuple<std::string, int>(pathname, fontsize);
     }
 
     if (fontdb.find(font_key) == fontdb.end()) {
-        TTF_Font* font = TTF_OpenFont(std::get<0>(font_key).c_str(), fontsize);
+        TTF_Font* font = game_open_font(std::get<0>(font_key).c_str(), fontsize);
 
         if (font == nullptr) {
             fprintf(stderr, "无法加载字体 '%s': %s\n", face, TTF_GetError());
@@ -173,13 +517,13 @@ shared_font_t Plteen::game_create_shared_font(const char* face, float fontsize)
 }
 
 TTF_Font* Plteen::game_create_font(const char* face, int fontsize) {
-    std::string face_key(face);
+    std::string pathname = system_font_path(std::string(face));
     TTF_Font* font = nullptr;
     
-    if (system_fonts.find(face_key) == system_fonts.end()) {
-        font = TTF_OpenFont(face, fontsize);
+    if (pathname.empty()) {
+        font = game_open_font(face, fontsize);
     } else {
-        font = TTF_OpenFont(system_fonts[face_key].c_str(), fontsize);
+        font = game_open_font(pathname.c_str(), fontsize);
     }
 
     if (font == nullptr) {
@@ -197,23 +541,33 @@ TTF_Font* Plteen::game_create_font(const char* face, float fontsize) {
 
 void Plteen::game_destory_font(TTF_Font* font) {
     if (font != nullptr) {
+        std::lock_guard<std::mutex> guard(font_open_mutex);
+
         TTF_CloseFont(font);
     }
 }
 
 const std::string* Plteen::game_fontname_list(int* n, int fontsize) {
-    static std::string* font_list = new std::string[system_fonts.size()];
+    static std::string* font_list = nullptr;
     static int i = 0;
 
-    if (i == 0) {
-        for (std::pair<std::string, std::string> k_v : system_fonts) {
-            TTF_Font* f = TTF_OpenFont(k_v.second.c_str(), fontsize);
+    if (font_list == nullptr) {
+        std::unordered_map<std::string, std::string> fonts;
+
+        system_fonts_mutex.lock();
+        fonts = system_fonts;
+        system_fonts_mutex.unlock();
+
+        font_list = new std::string[fonts.size()];
+
+        for (std::pair<std::string, std::string> k_v : fonts) {
+            TTF_Font* f = game_open_font(k_v.second.c_str(), fontsize);
 
             if (f != nullptr) {
                 font_list[i ++] = k_v.first;
                 
                 // because of insufficient resources to open all fonts
-                TTF_CloseFont(f);
+                game_destory_font(f);
             }
         }
     }
@@ -226,6 +580,12 @@ const std::string* Plteen::game_fontname_list(int* n, int fontsize) {
 }
 
 /*************************************************************************************************/
+Plteen::GameFont::~GameFont() {
+    if (this->okay()) {
+        game_destory_font(this->font);
+    }
+}
+
 void Plteen::GameFont::fontsize(int ftsize) {
     if (ftsize > 0) {
         medium_fontsize = ftsize;
@@ -4,6 +4,7 @@
 
 #include <string>
 #include <memory>
+#include <cstdint>
 
 namespace Plteen {
     // https://www.w3.org/TR/css-fonts-4
@@ -48,7 +49,7 @@ namespace Plteen {
 
     public:
         GameFont(TTF_Font* raw, int ftsize) : font(raw), size(ftsize) {}
-        virtual ~GameFont() { if (this->okay()) TTF_CloseFont(this->font); }
+        virtual ~GameFont();
 
     public:
         bool okay() { return this->font != nullptr; }
@@ -82,10 +83,20 @@ namespace Plteen {
 
     typedef std::shared_ptr<GameFont> shared_font_t;
 
+    struct __lambda__ FontFaceInfo {
+        std::string pathname;
+        std::string family;
+        std::string style;
+        uint64_t coverage = 0U;
+    };
+
     /*********************************************************************************************/
     __lambda__ void game_fonts_initialize();
     __lambda__ void game_fonts_destroy();
 
+    __lambda__ bool game_font_face_info(const char* basename, Plteen::FontFaceInfo* info);
+    __lambda__ uint64_t game_font_coverage_mask(uint32_t ch);
+
     __lambda__ int generic_font_size(FontSize size);
     __lambda__ const char* generic_font_family_name_for_ascii(FontFamily family);
     __lambda__ const char* generic_font_family_name_for_chinese(FontFamily family);
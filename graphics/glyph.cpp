@@ -0,0 +1,278 @@
+#include "glyph.hpp"
+
+#include "../datum/fixnum.hpp"
+
+using namespace Plteen;
+
+/*************************************************************************************************/
+static const int GLYPH_PAGE_SIZE = 512;
+static const int GLYPH_PADDING = 1;
+
+static inline uint32_t unsafe_utf8_next(const std::string& text, size_t* idx) {
+    unsigned char c = static_cast<unsigned char>(text[*idx]);
+    uint32_t codepoint = c;
+    size_t size = 1U;
+
+    if (c >= 0b11110000U) {
+        codepoint = c & 0b00000111U;
+        size = 4U;
+    } else if (c >= 0b11100000U) {
+        codepoint = c & 0b00001111U;
+        size = 3U;
+    } else if (c >= 0b11000000U) {
+        codepoint = c & 0b00011111U;
+        size = 2U;
+    }
+
+    if ((*idx) + size > text.size()) { // truncated
+        codepoint = 0xFFFDU;
+        size = text.size() - (*idx);
+    } else {
+        for (size_t i = 1U; i < size; i ++) {
+            codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[(*idx) + i]) & 0b00111111U);
+        }
+    }
+
+    (*idx) += size;
+
+    return codepoint;
+}
+
+static inline std::string run_key(TTF_Font* font, const std::string& text) {
+    std::string key(reinterpret_cast<const char*>(&font), sizeof(TTF_Font*));
+
+    return key.append(text);
+}
+
+/*************************************************************************************************/
+const ShapedRun* Plteen::GlyphCache::shape(SDL_Renderer* renderer, const shared_font_t& font, const std::string& text) {
+    FontAtlas* atlas = this->font_atlas(font);
+    std::string key = run_key(font->self(), text);
+    auto it = this->index.find(key);
+    ShapedRun* run = nullptr;
+
+    if (it != this->index.end()) {
+        this->runs.splice(this->runs.begin(), this->runs, it->second);
+        run = &it->second->run;
+        this->run_hits ++;
+    } else if (atlas != nullptr) {
+        TTF_Font* self = font->self();
+        int lineskip = TTF_FontLineSkip(self);
+        int height = TTF_FontHeight(self);
+        uint32_t prev = 0U;
+        int x = 0;
+        int y = 0;
+        size_t idx = 0U;
+
+        this->runs.push_front({ self, text, ShapedRun() });
+        this->index[key] = this->runs.begin();
+        run = &this->runs.front().run;
+        run->height = height;
+        this->run_misses ++;
+
+        while (idx < text.size()) {
+            uint32_t ch = unsafe_utf8_next(text, &idx);
+
+            if (ch == '\n') {
+                x = 0;
+                y += lineskip;
+                prev = 0U;
+                run->height = y + height;
+            } else if (ch != '\r') {
+                Glyph* g = this->glyph(renderer, self, atlas, ch);
+
+                if (prev != 0U) {
+                    x += TTF_GetFontKerningSizeGlyphs32(self, prev, ch);
+                }
+
+                if (g != nullptr) {
+                    if ((g->atlas != nullptr) && (g->src.w > 0) && (g->src.h > 0)) {
+                        run->quads.push_back({ g->atlas, g->src, x + g->xoff, y });
+                    }
+
+                    x += g->advance;
+                }
+
+                run->width = fxmax(run->width, x);
+                prev = ch;
+            }
+        }
+
+        this->evict_runs();
+    }
+
+    return run;
+}
+
+void Plteen::GlyphCache::set_run_capacity(size_t capacity) {
+    this->run_capacity = capacity;
+    this->evict_runs();
+}
+
+void Plteen::GlyphCache::clear() {
+    this->index.clear();
+    this->runs.clear();
+
+    for (auto& a : this->atlases) {
+        for (auto page : a.second.pages) {
+            SDL_DestroyTexture(page);
+        }
+    }
+
+    this->atlases.clear();
+    this->sweep();
+}
+
+void Plteen::GlyphCache::sweep() {
+    for (auto page : this->retired) {
+        SDL_DestroyTexture(page);
+    }
+
+    this->retired.clear();
+}
+
+GlyphCacheStatistics Plteen::GlyphCache::get_statistics() {
+    GlyphCacheStatistics stats;
+
+    stats.fonts = this->atlases.size();
+    stats.glyphs = 0U;
+    stats.pages = 0U;
+    stats.runs = this->runs.size();
+    stats.run_capacity = this->run_capacity;
+    stats.run_hits = this->run_hits;
+    stats.run_misses = this->run_misses;
+    stats.glyph_misses = this->glyph_misses;
+
+    for (auto& a : this->atlases) {
+        stats.glyphs += a.second.glyphs.size();
+        stats.pages += a.second.pages.size();
+    }
+
+    return stats;
+}
+
+/*************************************************************************************************/
+GlyphCache::FontAtlas* Plteen::GlyphCache::font_atlas(const shared_font_t& font) {
+    FontAtlas* atlas = nullptr;
+
+    if (font->okay()) {
+        auto it = this->atlases.find(font->self());
+
+        /** NOTE
+         * A raw font pointer cannot be reused while its owner is alive,
+         *   hence an expired owner means the atlas is stale.
+         */
+        if ((it != this->atlases.end()) && it->second.font.expired()) {
+            this->drop_font(font->self());
+            it = this->atlases.end();
+        }
+
+        if (it == this->atlases.end()) {
+            atlas = &this->atlases[font->self()];
+            atlas->font = font;
+        } else {
+            atlas = &it->second;
+        }
+    }
+
+    return atlas;
+}
+
+GlyphCache::Glyph* Plteen::GlyphCache::glyph(SDL_Renderer* renderer, TTF_Font* font, FontAtlas* atlas, uint32_t ch) {
+    auto it = atlas->glyphs.find(ch);
+    Glyph* g = nullptr;
+
+    if (it != atlas->glyphs.end()) {
+        g = &it->second;
+    } else {
+        int minx, maxx, miny, maxy, advance;
+
+        this->glyph_misses ++;
+
+        if (TTF_GlyphMetrics32(font, ch, &minx, &maxx, &miny, &maxy, &advance) == 0) {
+            SDL_Surface* surface = TTF_RenderGlyph32_Blended(font, ch, { 0xFFU, 0xFFU, 0xFFU, 0xFFU });
+
+            g = &atlas->glyphs[ch];
+            g->atlas = nullptr;
+            g->src = { 0, 0, 0, 0 };
+            g->xoff = fxmin(minx, 0);
+            g->advance = advance;
+
+            if (surface != nullptr) {
+                if ((surface->w > 0) && (surface->h > 0)) {
+                    if (this->pack_glyph(renderer, atlas, surface, &g->src)) {
+                        g->atlas = atlas->pages.back();
+                    }
+                }
+
+                SDL_FreeSurface(surface);
+            }
+        }
+    }
+
+    return g;
+}
+
+bool Plteen::GlyphCache::pack_glyph(SDL_Renderer* renderer, FontAtlas* atlas, SDL_Surface* glyph, SDL_Rect* slot) {
+    SDL_Surface* pixels = SDL_ConvertSurfaceFormat(glyph, SDL_PIXELFORMAT_ARGB8888, 0);
+    int w = glyph->w + GLYPH_PADDING;
+    int h = glyph->h + GLYPH_PADDING;
+    bool okay = false;
+
+    if (pixels != nullptr) {
+        /* glyphs only go to the last page, so that the caller knows where they are */
+        if (atlas->packers.empty() || !atlas->packers.back().pack(w, h, slot)) {
+            int size = fxmax(GLYPH_PAGE_SIZE, fxmax(w, h));
+            SDL_Texture* page = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+
+            if (page != nullptr) {
+                std::vector<uint32_t> blank(size_t(size) * size_t(size), 0U);
+
+                SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+                SDL_UpdateTexture(page, nullptr, blank.data(), size * int(sizeof(uint32_t)));
+                atlas->pages.push_back(page);
+                atlas->packers.push_back(SkylinePacker(size, size));
+                atlas->packers.back().pack(w, h, slot);
+            } else {
+                slot->w = 0;
+            }
+        }
+
+        if (slot->w > 0) {
+            slot->w = glyph->w;
+            slot->h = glyph->h;
+            okay = (SDL_UpdateTexture(atlas->pages.back(), slot, pixels->pixels, pixels->pitch) == 0);
+        }
+
+        SDL_FreeSurface(pixels);
+    }
+
+    return okay;
+}
+
+void Plteen::GlyphCache::drop_font(TTF_Font* font) {
+    auto it = this->atlases.find(font);
+
+    for (auto r = this->runs.begin(); r != this->runs.end(); ) {
+        if (r->font == font) {
+            this->index.erase(run_key(r->font, r->text));
+            r = this->runs.erase(r);
+        } else {
+            ++ r;
+        }
+    }
+
+    if (it != this->atlases.end()) {
+        // pages might be referenced by pending draw commands
+        this->retired.insert(this->retired.end(), it->second.pages.begin(), it->second.pages.end());
+        this->atlases.erase(it);
+    }
+}
+
+void Plteen::GlyphCache::evict_runs() {
+    // the newest run is always kept since it is in use
+    while (this->runs.size() > fxmax(this->run_capacity, size_t(1U))) {
+        this->index.erase(run_key(this->runs.back().font, this->runs.back().text));
+        this->runs.pop_back();
+    }
+}
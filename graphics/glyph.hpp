@@ -0,0 +1,104 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "font.hpp"
+#include "packer.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <list>
+
+namespace Plteen {
+    struct __lambda__ GlyphCacheStatistics {
+        size_t fonts;
+        size_t glyphs;
+        size_t pages;
+        size_t runs;
+        size_t run_capacity;
+
+        uint64_t run_hits;
+        uint64_t run_misses;
+        uint64_t glyph_misses;
+    };
+
+    struct __lambda__ GlyphQuad {
+        SDL_Texture* atlas;
+        SDL_Rect src;
+        int x;
+        int y;
+    };
+
+    struct __lambda__ ShapedRun {
+        std::vector<Plteen::GlyphQuad> quads;
+        int width = 0;
+        int height = 0;
+    };
+
+    /** NOTE
+     * Glyphs are rasterized in white only once per font and packed into atlas pages,
+     *   clients colorize them with the color and alpha modulation of the pages.
+     *
+     * Shaped runs are the positioned glyphs of strings, laid out by advances and kernings,
+     *   and are cached by the least recently used policy,
+     *   so that drawing a repeated string costs neither rasterization nor texture allocation.
+     *
+     * Fonts are referenced weakly, glyphs of a font are dropped along with its runs once the font is gone,
+     *   and the pages are retired until `sweep` is called when no pending draw command refers to them.
+     */
+    class __lambda__ GlyphCache {
+    public:
+        GlyphCache(size_t run_capacity = 1024U) : run_capacity(run_capacity) {}
+        virtual ~GlyphCache() noexcept { this->clear(); }
+
+    public:
+        const Plteen::ShapedRun* shape(SDL_Renderer* renderer, const Plteen::shared_font_t& font, const std::string& text);
+        void set_run_capacity(size_t capacity);
+        void clear();
+        void sweep();
+
+    public:
+        Plteen::GlyphCacheStatistics get_statistics();
+
+    private:
+        struct Glyph {
+            SDL_Texture* atlas;
+            SDL_Rect src;
+            int xoff;
+            int advance;
+        };
+
+        struct FontAtlas {
+            std::weak_ptr<Plteen::GameFont> font;
+            std::unordered_map<uint32_t, Glyph> glyphs;
+            std::vector<SDL_Texture*> pages;
+            std::vector<Plteen::SkylinePacker> packers;
+        };
+
+        struct RunEntry {
+            TTF_Font* font;
+            std::string text;
+            Plteen::ShapedRun run;
+        };
+
+    private:
+        FontAtlas* font_atlas(const Plteen::shared_font_t& font);
+        Glyph* glyph(SDL_Renderer* renderer, TTF_Font* font, FontAtlas* atlas, uint32_t ch);
+        bool pack_glyph(SDL_Renderer* renderer, FontAtlas* atlas, SDL_Surface* glyph, SDL_Rect* slot);
+        void drop_font(TTF_Font* font);
+        void evict_runs();
+
+    private:
+        std::unordered_map<TTF_Font*, FontAtlas> atlases;
+        std::unordered_map<std::string, std::list<RunEntry>::iterator> index;
+        std::list<RunEntry> runs;
+        std::vector<SDL_Texture*> retired;
+        size_t run_capacity;
+
+    private:
+        uint64_t run_hits = 0U;
+        uint64_t run_misses = 0U;
+        uint64_t glyph_misses = 0U;
+    };
+}
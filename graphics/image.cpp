@@ -2,6 +2,7 @@
 #include <filesystem>
 
 #include "image.hpp"
+#include "texture.hpp"
 #include "../datum/flonum.hpp"
 
 using namespace Plteen;
@@ -57,7 +58,7 @@ void Plteen::game_clear_image(SDL_Renderer* renderer, SDL_Texture* image) {
 }
 
 void Plteen::game_unload_image(SDL_Texture* image) {
-    SDL_DestroyTexture(image);
+    game_destroy_texture(image);
 }
 
 /*************************************************************************************************/
@@ -0,0 +1,114 @@
+#include "packer.hpp"
+
+#include "../datum/fixnum.hpp"
+
+using namespace Plteen;
+
+/*************************************************************************************************/
+Plteen::SkylinePacker::SkylinePacker(int width, int height) : _width(width), _height(height) {
+    this->reset();
+}
+
+void Plteen::SkylinePacker::reset() {
+    this->skyline.clear();
+    this->skyline.push_back({ 0, 0, this->_width });
+    this->_used_width = 0;
+    this->_used_height = 0;
+}
+
+bool Plteen::SkylinePacker::pack(int width, int height, SDL_Rect* slot) {
+    size_t best_idx = this->skyline.size();
+    int best_top = this->_height + 1;
+    int best_width = this->_width + 1;
+    int best_y = 0;
+
+    if ((width > 0) && (height > 0)) {
+        for (size_t idx = 0; idx < this->skyline.size(); idx ++) {
+            int y = this->fit(idx, width, height);
+
+            if (y >= 0) {
+                int top = y + height;
+
+                if ((top < best_top) || ((top == best_top) && (this->skyline[idx].width < best_width))) {
+                    best_idx = idx;
+                    best_top = top;
+                    best_width = this->skyline[idx].width;
+                    best_y = y;
+                }
+            }
+        }
+    }
+
+    if (best_idx < this->skyline.size()) {
+        slot->x = this->skyline[best_idx].x;
+        slot->y = best_y;
+        slot->w = width;
+        slot->h = height;
+
+        this->settle(best_idx, slot->x, best_y, width, height);
+    }
+
+    return (best_idx < this->skyline.size());
+}
+
+/*************************************************************************************************/
+int Plteen::SkylinePacker::fit(size_t idx, int width, int height) {
+    int x = this->skyline[idx].x;
+    int y = -1;
+
+    if (x + width <= this->_width) {
+        int rest = width;
+
+        y = this->skyline[idx].y;
+
+        while ((rest > 0) && (idx < this->skyline.size())) {
+            y = fxmax(y, this->skyline[idx].y);
+            rest -= this->skyline[idx].width;
+            idx ++;
+        }
+
+        if (y + height > this->_height) {
+            y = -1;
+        }
+    }
+
+    return y;
+}
+
+void Plteen::SkylinePacker::settle(size_t idx, int x, int y, int width, int height) {
+    int right = x + width;
+
+    this->skyline.insert(this->skyline.begin() + idx, { x, y + height, width });
+
+    /* shrink or remove the segments shadowed by the new one */
+    for (size_t i = idx + 1; i < this->skyline.size(); ) {
+        Segment& seg = this->skyline[i];
+
+        if (seg.x < right) {
+            int shrink = right - seg.x;
+
+            if (seg.width > shrink) {
+                seg.x += shrink;
+                seg.width -= shrink;
+                break;
+            } else {
+                this->skyline.erase(this->skyline.begin() + i);
+            }
+        } else {
+            break;
+        }
+    }
+
+    /* merge the neighbors of the same height */
+    for (size_t i = 0; i + 1 < this->skyline.size(); ) {
+        if (this->skyline[i].y == this->skyline[i + 1].y) {
+            this->skyline[i].width += this->skyline[i + 1].width;
+            this->skyline.erase(this->skyline.begin() + i + 1);
+        } else {
+            i ++;
+        }
+    }
+
+    this->_used_width = fxmax(this->_used_width, right);
+    this->_used_height = fxmax(this->_used_height, y + height);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include <vector>
+
+namespace Plteen {
+    /** NOTE
+     * A bottom-left skyline bin packer,
+     *   the skyline is the upper contour of the packed rectangles, stored as horizontal segments,
+     *   a new rectangle is put on the segment where its top edge ends up lowest,
+     *   and the narrower segment wins ties so that the wide gaps are left for wide rectangles.
+     *
+     * Clients get better results by packing rectangles in descending order of heights.
+     */
+    class __lambda__ SkylinePacker {
+    public:
+        SkylinePacker(int width, int height);
+        virtual ~SkylinePacker() noexcept {}
+
+    public:
+        bool pack(int width, int height, SDL_Rect* slot);
+        void reset();
+
+    public:
+        int width() { return this->_width; }
+        int height() { return this->_height; }
+        int used_width() { return this->_used_width; }
+        int used_height() { return this->_used_height; }
+
+    private:
+        struct Segment {
+            int x;
+            int y;
+            int width;
+        };
+
+    private:
+        int fit(size_t idx, int width, int height);
+        void settle(size_t idx, int x, int y, int width, int height);
+
+    private:
+        std::vector<Segment> skyline;
+        int _width;
+        int _height;
+        int _used_width = 0;
+        int _used_height = 0;
+    };
+}
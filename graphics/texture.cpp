@@ -2,9 +2,42 @@
 
 #include "../datum/box.hpp"
 
+#include <vector>
+#include <utility>
+
 using namespace Plteen;
 
 /*************************************************************************************************/
+static std::vector<std::pair<texture_retiring_t, void*>> retiring_watchers;
+
+void Plteen::game_watch_retiring_textures(texture_retiring_t watcher, void* userdata) {
+    retiring_watchers.push_back(std::make_pair(watcher, userdata));
+}
+
+void Plteen::game_unwatch_retiring_textures(texture_retiring_t watcher, void* userdata) {
+    for (auto it = retiring_watchers.begin(); it != retiring_watchers.end(); ++ it) {
+        if ((it->first == watcher) && (it->second == userdata)) {
+            retiring_watchers.erase(it);
+            break;
+        }
+    }
+}
+
+void Plteen::game_destroy_texture(SDL_Texture* texture) {
+    if (texture != nullptr) {
+        for (auto& watcher : retiring_watchers) {
+            watcher.first(texture, watcher.second);
+        }
+
+        SDL_DestroyTexture(texture);
+    }
+}
+
+/*************************************************************************************************/
+Plteen::Texture::~Texture() {
+    game_destroy_texture(this->_self);
+}
+
 void Plteen::Texture::feed_extent(int* width, int* height) {
     if (this->_self != nullptr) {
         SDL_QueryTexture(this->_self, nullptr, nullptr, width, height);
@@ -18,3 +51,15 @@ void Plteen::Texture::feed_extent(float* width, float* height) {
     SET_BOX(width, float(w));
     SET_BOX(height, float(h));
 }
+
+/** NOTE
+ * Clients share textures via `shared_texture_t`,
+ *   resetting the raw texture therefore takes effect for all holders,
+ *   say, the placeholders of images that are still being decoded.
+ */
+void Plteen::Texture::reset(SDL_Texture* raw) {
+    if (this->_self != raw) {
+        game_destroy_texture(this->_self);
+        this->_self = raw;
+    }
+}
@@ -8,17 +8,28 @@ namespace Plteen {
     class __lambda__ Texture {
     public:
         Texture(SDL_Texture* raw) : _self(raw) {}
-        virtual ~Texture() { if (this->okay()) SDL_DestroyTexture(this->_self); }
+        virtual ~Texture();
 
     public:
         bool okay() { return this->_self != nullptr; }
         SDL_Texture* self() { return this->_self; }
         void feed_extent(int* width, int* height);
         void feed_extent(float* width, float* height);
+        void reset(SDL_Texture* raw);
         
     private:
         SDL_Texture* _self = nullptr;
     };
 
     typedef std::shared_ptr<Texture> shared_texture_t;
+
+    /** NOTE
+     * Renderers that defer drawing, say, the recording `DrawingContext`, watch textures that are about to be destroyed,
+     *   so that commands referring to them get submitted in time.
+     */
+    typedef void (*texture_retiring_t)(SDL_Texture* texture, void* userdata);
+
+    __lambda__ void game_watch_retiring_textures(Plteen::texture_retiring_t watcher, void* userdata);
+    __lambda__ void game_unwatch_retiring_textures(Plteen::texture_retiring_t watcher, void* userdata);
+    __lambda__ void game_destroy_texture(SDL_Texture* texture);
 }
@@ -163,6 +163,12 @@ void Plteen::IMatter::notify_timeline_restart(uint32_t count0, int duration) {
     }
 }
 
+void Plteen::IMatter::on_motion_changed() {
+    if (this->info != nullptr) {
+        this->info->master->notify_matter_motion_changed(this);
+    }
+}
+
 void Plteen::IMatter::moor(const Port& port) {
     if (this->port != port) {
         if (this->info != nullptr) {
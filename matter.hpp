@@ -48,6 +48,7 @@ namespace Plteen {
         virtual Plteen::Margin get_margin() { return this->get_original_margin(); }
         virtual Plteen::Margin get_original_margin() { return Plteen::Margin(); }
         virtual int update(uint64_t count, uint32_t interval, uint64_t uptime) { return 0; }
+        virtual bool is_quiescent(uint64_t uptime, uint64_t* wakeup) { return true; }
         virtual void draw(Plteen::dc_t* renderer, float x, float y, float Width, float Height) = 0;
         virtual void draw_in_progress(Plteen::dc_t* renderer, float x, float y, float Width, float Height) {}
         virtual bool ready() { return true; }
@@ -119,6 +120,7 @@ namespace Plteen {
 
     private:
         void scale_by_size(float size, bool given_width, const Plteen::Port& port);
+        void on_motion_changed() override;
 
     private:
         bool findable = true;
@@ -10,14 +10,65 @@
 #include "../graphics/misc.hpp"
 #include "../physics/mathematics.hpp"
 
+#include <vector>
+#include <algorithm>
+
 using namespace Plteen;
 
+/*************************************************************************************************/
+namespace Plteen {
+    struct AtlasChunks {
+        AtlasChunks(size_t chunk_size) : chunk_size(chunk_size) {}
+
+        size_t chunk_size;
+        bool valid = false;
+        uint64_t generation = 0U; // of the render targets, see `DrawingContext::get_target_generation()`
+
+        /* in map space */
+        float width = 0.0F;
+        float height = 0.0F;
+        float map_width = 0.0F;
+        float map_height = 0.0F;
+        int row = 0;
+        int col = 0;
+
+        std::vector<std::vector<size_t>> tiles;
+        std::vector<shared_texture_t> textures;
+        std::vector<bool> dirty;
+    };
+}
+
+/*************************************************************************************************/
+static inline bool unsafe_chunk_range(AtlasChunks* chunks, float x1, float y1, float x2, float y2, int* c0, int* r0, int* c1, int* r1) {
+    bool okay = false;
+
+    if ((x2 > 0.0F) && (y2 > 0.0F) && (x1 < chunks->map_width) && (y1 < chunks->map_height)) {
+        (*c0) = fxmax(int(flfloor(x1 / chunks->width)), 0);
+        (*r0) = fxmax(int(flfloor(y1 / chunks->height)), 0);
+        (*c1) = fxmin(int(flfloor(x2 / chunks->width)), chunks->col - 1);
+        (*r1) = fxmin(int(flfloor(y2 / chunks->height)), chunks->row - 1);
+        okay = true;
+    }
+
+    return okay;
+}
+
+static inline float unsafe_map_position(float x, float Width, float pos, float length, float scale, float s) {
+    return (scale >= 0.0F) ? (pos * s + x) : (x + Width - pos * s - length);
+}
+
 /*************************************************************************************************/
 Plteen::IAtlas::IAtlas(const std::string& pathname) : _pathname(pathname) {
     this->enable_resize(true);
     this->camouflage(true);
 }
 
+Plteen::IAtlas::~IAtlas() {
+    if (this->chunks != nullptr) {
+        delete this->chunks;
+    }
+}
+
 const char* Plteen::IAtlas::name() {
     static std::string _name;
 
@@ -27,7 +78,7 @@ const char* Plteen::IAtlas::name() {
 }
 
 void Plteen::IAtlas::construct(Plteen::dc_t* dc) {
-    this->atlas = imgdb_ref(this->_pathname, dc->self());
+    this->atlas = imgdb_ref(this->_pathname, dc->unsafe_self());
 
     if (this->atlas->okay()) {
         this->on_tilemap_load(this->atlas);
@@ -89,60 +140,277 @@ void Plteen::IAtlas::on_resize(float width, float height, float old_width, float
 }
 
 void Plteen::IAtlas::draw(Plteen::dc_t* dc, float x, float y, float Width, float Height) {
+    float sx = flabs(this->xscale);
+    float sy = flabs(this->yscale);
+    float vx1 = x;
+    float vy1 = y;
+    float vx2 = x + Width;
+    float vy2 = y + Height;
+    SDL_Rect clip;
+
+    if (dc->feed_clipping_region(&clip)) {
+        vx1 = flmax(vx1, float(clip.x));
+        vy1 = flmax(vy1, float(clip.y));
+        vx2 = flmin(vx2, float(clip.x + clip.w));
+        vy2 = flmin(vy2, float(clip.y + clip.h));
+    }
+
+    if ((vx1 < vx2) && (vy1 < vy2) && (sx > 0.0F) && (sy > 0.0F)) {
+        /* the visible region in map space */
+        float mx = (this->xscale >= 0.0F) ? (vx1 - x) : (x + Width - vx2);
+        float my = (this->yscale >= 0.0F) ? (vy1 - y) : (y + Height - vy2);
+        Box visible(mx / sx, my / sy, (vx2 - vx1) / sx, (vy2 - vy1) / sy);
+
+        if (this->chunks != nullptr) {
+            this->draw_chunks(dc, x, y, Width, Height, visible);
+        } else {
+            this->draw_tiles(dc, x, y, Width, Height, visible);
+        }
+    }
+
+    if (this->logic_grid_color.is_opacity() && (this->logic_col > 0) && (this->logic_row > 0)) {
+        dc->draw_grid(this->logic_row, this->logic_col,
+            this->logic_tile_width * sx, this->logic_tile_height * sy,
+            this->logic_grid_color,
+            x + this->logic_margin.left * sx, y + this->logic_margin.top * sy);
+    }
+}
+
+bool Plteen::IAtlas::feed_map_tile_regions(size_t map_idx, SDL_Rect* src, SDL_FRect* dest) {
+    int xoff = 0;
+    int yoff = 0;
+    int primitive_tile_idx = this->get_atlas_tile_index(map_idx, xoff, yoff);
+    bool okay = false;
+
+    if (primitive_tile_idx >= 0) {
+        /** NOTE
+         * The source rectangle could be larger than the tilemap,
+         *   and it's okay, the larger part is simply ignored. 
+         **/
+        
+        feed_rect(src, this->get_atlas_tile_region(primitive_tile_idx % this->atlas_tile_count()));
+        feed_rect(dest, this->get_map_tile_region(map_idx));
+
+        if (xoff != 0) {
+            src->x += xoff;
+        }
+
+        if (yoff != 0) {
+            src->y += yoff;
+        }
+
+        okay = true;
+    }
+
+    return okay;
+}
+
+void Plteen::IAtlas::draw_tiles(Plteen::dc_t* dc, float x, float y, float Width, float Height, const Box& visible) {
     SDL_Texture* tilemap = this->atlas->self();
     SDL_RendererFlip flip = this->current_flip_status();
     float sx = flabs(this->xscale);
     float sy = flabs(this->yscale);
-    size_t idxmax = this->atlas_tile_count();
     SDL_Rect src;
     SDL_FRect dest;
     
     for (size_t idx = 0U; idx < this->map_tile_count(); idx ++) {
-        int xoff = 0;
-        int yoff = 0;
-        int primitive_tile_idx = this->get_atlas_tile_index(idx, xoff, yoff);
-
-        if (primitive_tile_idx >= 0) {
-            /** NOTE
-             * The source rectangle could be larger than the tilemap,
-             *   and it's okay, the larger part is simply ignored. 
-             **/
-            
-            feed_rect(&src, this->get_atlas_tile_region(primitive_tile_idx % idxmax));
-            feed_rect(&dest, this->get_map_tile_region(idx));
-
-            if (xoff != 0) {
-                src.x += xoff;
+        if (this->feed_map_tile_regions(idx, &src, &dest)) {
+            if ((dest.x < visible.rbdot.x) && (dest.x + dest.w > visible.ltdot.x)
+                    && (dest.y < visible.rbdot.y) && (dest.y + dest.h > visible.ltdot.y)) {
+                dest.w *= sx;
+                dest.h *= sy;
+                dest.x = unsafe_map_position(x, Width, dest.x, dest.w, this->xscale, sx);
+                dest.y = unsafe_map_position(y, Height, dest.y, dest.h, this->yscale, sy);
+
+                dc->stamp(tilemap, &src, &dest, flip);
+            }
+        }
+    }
+}
+
+void Plteen::IAtlas::draw_chunks(Plteen::dc_t* dc, float x, float y, float Width, float Height, const Box& visible) {
+    SDL_RendererFlip flip = this->current_flip_status();
+    float sx = flabs(this->xscale);
+    float sy = flabs(this->yscale);
+    uint64_t generation = dc->get_target_generation();
+    int c0, r0, c1, r1;
+
+    if (!this->chunks->valid) {
+        this->layout_chunks();
+    } else if (this->chunks->generation != generation) {
+        /* baked chunks are wiped by resetting the render targets or the device */
+        std::fill(this->chunks->dirty.begin(), this->chunks->dirty.end(), true);
+    }
+
+    this->chunks->generation = generation;
+
+    if (unsafe_chunk_range(this->chunks, visible.ltdot.x, visible.ltdot.y, visible.rbdot.x, visible.rbdot.y, &c0, &r0, &c1, &r1)) {
+        SDL_Texture* origin = nullptr;
+        SDL_Rect clip;
+        bool clipping = false;
+        bool baking = false;
+        SDL_FRect dest;
+
+        /* bake all the dirty chunks first, so that the target is switched only twice */
+        for (int r = r0; r <= r1; r ++) {
+            for (int c = c0; c <= c1; c ++) {
+                size_t idx = size_t(r * this->chunks->col + c);
+
+                if (this->chunks->dirty[idx]) {
+                    if (!baking) {
+                        origin = dc->get_target();
+                        clipping = dc->feed_clipping_region(&clip);
+                        baking = true;
+                    }
+
+                    this->bake_chunk(dc, idx);
+                }
             }
+        }
+
+        if (baking) {
+            // the clipping region is dropped by switching targets
+            dc->set_target(origin);
+            dc->set_clipping_region(clipping ? &clip : nullptr);
+        }
+
+        for (int r = r0; r <= r1; r ++) {
+            for (int c = c0; c <= c1; c ++) {
+                shared_texture_t chunk = this->chunks->textures[size_t(r * this->chunks->col + c)];
 
-            if (yoff != 0) {
-                src.y += yoff;
+                if ((chunk != nullptr) && chunk->okay()) {
+                    chunk->feed_extent(&dest.w, &dest.h);
+                    dest.w *= sx;
+                    dest.h *= sy;
+                    dest.x = unsafe_map_position(x, Width, float(c) * this->chunks->width, dest.w, this->xscale, sx);
+                    dest.y = unsafe_map_position(y, Height, float(r) * this->chunks->height, dest.h, this->yscale, sy);
+
+                    dc->stamp(chunk->self(), &dest, flip);
+                }
             }
+        }
+    }
+}
+
+void Plteen::IAtlas::bake_chunk(Plteen::dc_t* dc, size_t chunk_idx) {
+    int c = int(chunk_idx) % this->chunks->col;
+    int r = int(chunk_idx) / this->chunks->col;
+    float cx = float(c) * this->chunks->width;
+    float cy = float(r) * this->chunks->height;
+    int width = fl2fxi(flceiling(flmin(this->chunks->width, this->chunks->map_width - cx)));
+    int height = fl2fxi(flceiling(flmin(this->chunks->height, this->chunks->map_height - cy)));
+    shared_texture_t chunk = this->chunks->textures[chunk_idx];
+    SDL_Rect src;
+    SDL_FRect dest;
+
+    if (((chunk == nullptr) || !chunk->okay()) && (width > 0) && (height > 0) && !this->chunks->tiles[chunk_idx].empty()) {
+        chunk = std::make_shared<Texture>(dc->create_blank_image(width, height));
+        this->chunks->textures[chunk_idx] = chunk;
+    }
 
-            dest.w *= sx;
-            dest.h *= sy;
+    if ((chunk != nullptr) && chunk->okay()) {
+        dc->set_target(chunk->self());
+        dc->clear_clipping_region();
+        dc->clear(RGBA(0x0U, 0.0));
 
-            if (this->xscale >= 0.0F) {
-                dest.x = dest.x * sx + x;    
-            } else {
-                dest.x = x + Width - dest.x * sx - dest.w;
+        for (size_t idx : this->chunks->tiles[chunk_idx]) {
+            if (this->feed_map_tile_regions(idx, &src, &dest)) {
+                dest.x -= cx;
+                dest.y -= cy;
+                dc->stamp(this->atlas->self(), &src, &dest);
             }
+        }
+    }
+
+    this->chunks->dirty[chunk_idx] = false;
+}
+
+void Plteen::IAtlas::layout_chunks() {
+    Box map = this->get_original_bounding_box();
+    size_t n = this->map_tile_count();
+    int c0, r0, c1, r1;
+
+    this->chunks->tiles.clear();
+    this->chunks->textures.clear();
+    this->chunks->dirty.clear();
+    this->chunks->row = 0;
+    this->chunks->col = 0;
+
+    if ((n > 0U) && !map.is_empty()) {
+        Box tile = this->get_map_tile_region(0U);
+
+        this->chunks->map_width = map.rbdot.x;
+        this->chunks->map_height = map.rbdot.y;
+        this->chunks->width = flmax(tile.width() * float(this->chunks->chunk_size), 1.0F);
+        this->chunks->height = flmax(tile.height() * float(this->chunks->chunk_size), 1.0F);
+        this->chunks->col = fxmax(int(flceiling(this->chunks->map_width / this->chunks->width)), 1);
+        this->chunks->row = fxmax(int(flceiling(this->chunks->map_height / this->chunks->height)), 1);
+        this->chunks->tiles.resize(size_t(this->chunks->row * this->chunks->col));
+        this->chunks->textures.resize(this->chunks->tiles.size());
+        this->chunks->dirty.resize(this->chunks->tiles.size(), true);
+
+        /* tiles might overlap each other, and every chunk they touch owns them in order */
+        for (size_t idx = 0U; idx < n; idx ++) {
+            tile = this->get_map_tile_region(idx);
 
-            if (this->yscale >= 0.0F) {
-                dest.y = dest.y * sy + y;
-            } else {
-                dest.y = y + Height - dest.y * sy - dest.h;
+            if (unsafe_chunk_range(this->chunks, tile.ltdot.x, tile.ltdot.y, tile.rbdot.x, tile.rbdot.y, &c0, &r0, &c1, &r1)) {
+                for (int r = r0; r <= r1; r ++) {
+                    for (int c = c0; c <= c1; c ++) {
+                        this->chunks->tiles[size_t(r * this->chunks->col + c)].push_back(idx);
+                    }
+                }
+            }
+        }
+    }
+
+    this->chunks->valid = true;
+}
+
+void Plteen::IAtlas::enable_map_baking(bool yes_or_no, size_t chunk_size) {
+    if (yes_or_no) {
+        chunk_size = fxmax(chunk_size, size_t(1U));
+
+        if ((this->chunks == nullptr) || (this->chunks->chunk_size != chunk_size)) {
+            if (this->chunks != nullptr) {
+                delete this->chunks;
             }
 
-            dc->stamp(tilemap, &src, &dest, flip);
+            this->chunks = new AtlasChunks(chunk_size);
+            this->notify_updated();
         }
+    } else if (this->chunks != nullptr) {
+        delete this->chunks;
+        this->chunks = nullptr;
+        this->notify_updated();
     }
+}
 
-    if (this->logic_grid_color.is_opacity() && (this->logic_col > 0) && (this->logic_row > 0)) {
-        dc->draw_grid(this->logic_row, this->logic_col,
-            this->logic_tile_width * sx, this->logic_tile_height * sy,
-            this->logic_grid_color,
-            x + this->logic_margin.left * sx, y + this->logic_margin.top * sy);
+void Plteen::IAtlas::invalidate_map_size() {
+    this->map_region.invalidate();
+
+    if (this->chunks != nullptr) {
+        this->chunks->valid = false;
+    }
+}
+
+void Plteen::IAtlas::invalidate_map_tile(size_t map_idx) {
+    if ((this->chunks != nullptr) && this->chunks->valid) {
+        Box tile = this->get_map_tile_region(map_idx);
+        int c0, r0, c1, r1;
+
+        if (unsafe_chunk_range(this->chunks, tile.ltdot.x, tile.ltdot.y, tile.rbdot.x, tile.rbdot.y, &c0, &r0, &c1, &r1)) {
+            for (int r = r0; r <= r1; r ++) {
+                for (int c = c0; c <= c1; c ++) {
+                    this->chunks->dirty[size_t(r * this->chunks->col + c)] = true;
+                }
+            }
+        }
+    }
+}
+
+void Plteen::IAtlas::invalidate_map_tiles() {
+    if ((this->chunks != nullptr) && this->chunks->valid) {
+        std::fill(this->chunks->dirty.begin(), this->chunks->dirty.end(), true);
     }
 }
 
@@ -10,11 +10,13 @@
 #include "../virtualization/filesystem/imgdb.hpp"
 
 namespace Plteen {
+    struct AtlasChunks;
+
     class __lambda__ IAtlas : public Plteen::IMatter {
     public:
         IAtlas(const std::string& pathname);
         IAtlas(const char* pathname) : IAtlas(std::string(pathname)) {}
-        virtual ~IAtlas() {}
+        virtual ~IAtlas();
 
         void construct(Plteen::dc_t* dc) override;
         const char* name() override;
@@ -31,6 +33,15 @@ namespace Plteen {
 
     public:
         int preferred_local_fps() override { return 4; }
+
+    public:
+        /** NOTE
+         * Static maps could be baked into chunks of `chunk_size`x`chunk_size` tiles,
+         *   which are drawn as a whole and are rebaked only when their tiles are invalidated,
+         *   subclasses that change tiles should tell it by `invalidate_map_tile` or `invalidate_map_tiles`.
+         */
+        void enable_map_baking(bool yes_or_no, size_t chunk_size = 16U);
+        bool is_map_baking() { return this->chunks != nullptr; }
         
     public:
         size_t logic_tile_count();
@@ -61,7 +72,9 @@ namespace Plteen {
         void on_resize(float width, float height, float old_width, float old_height) override;
         
     protected:
-        void invalidate_map_size() { this->map_region.invalidate(); }
+        void invalidate_map_size();
+        void invalidate_map_tile(size_t map_idx);
+        void invalidate_map_tiles();
         void on_map_resize(float map_width, float map_height);
         SDL_RendererFlip current_flip_status();
         float get_horizontal_scale();
@@ -71,8 +84,16 @@ namespace Plteen {
         float xscale = 1.0F;
         float yscale = 1.0F;
 
+    private:
+        bool feed_map_tile_regions(size_t map_idx, SDL_Rect* src, SDL_FRect* dest);
+        void draw_tiles(Plteen::dc_t* dc, float x, float y, float Width, float Height, const Plteen::Box& visible);
+        void draw_chunks(Plteen::dc_t* dc, float x, float y, float Width, float Height, const Plteen::Box& visible);
+        void bake_chunk(Plteen::dc_t* dc, size_t chunk_idx);
+        void layout_chunks();
+
     private:
         Plteen::shared_texture_t atlas;
+        Plteen::AtlasChunks* chunks = nullptr;
 
     private:
         Plteen::Box map_region;
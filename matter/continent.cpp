@@ -97,6 +97,10 @@ int Plteen::Continent::update(uint64_t count, uint32_t interval, uint64_t uptime
 	return 0;
 }
 
+bool Plteen::Continent::is_quiescent(uint64_t uptime, uint64_t* wakeup) {
+	return this->plane->is_quiescent(uptime, wakeup);
+}
+
 void Plteen::Continent::draw(Plteen::dc_t* dc, float x, float y, float Width, float Height) {
 	if (this->background.is_opacity()) {
         dc->fill_rect(x, y, Width, Height, this->background);
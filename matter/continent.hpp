@@ -20,6 +20,7 @@ namespace Plteen {
 		void construct(Plteen::dc_t* dc) override;
 		Plteen::Box get_bounding_box() override;
 		int update(uint64_t count, uint32_t interval, uint64_t uptime) override;
+		bool is_quiescent(uint64_t uptime, uint64_t* wakeup) override;
 		void draw(Plteen::dc_t* dc, float x, float y, float Width, float Height) override;
 
 	public:
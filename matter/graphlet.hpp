@@ -50,6 +50,10 @@ namespace Plteen {
 			this->update_value_now();
 			return 0;
 		}
+
+		bool is_quiescent(uint64_t uptime, uint64_t* wakeup) override {
+			return false; // the value is polled every frame
+		}
 		
 	protected:
 		virtual void on_value_changed(Plteen::dc_t* renderer, T value) {}
@@ -2,6 +2,8 @@
 
 #include "../../datum/box.hpp"
 #include "../../datum/flonum.hpp"
+#include "../../datum/fixnum.hpp"
+#include "../../datum/string.hpp"
 
 #include "../../graphics/image.hpp"
 #include "../../physics/color/rgba.hpp"
@@ -9,6 +11,12 @@
 
 #include "../../physics/mathematics.hpp"
 
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+
 using namespace Plteen;
 
 /*************************************************************************************************/
@@ -231,6 +239,164 @@ static const double wavelength_zbars [] = {
     0.0, 0.0, 0.0, 0.0
 };
 
+namespace {
+    struct ChromaticityColumn {
+        double x;
+        int top;
+        int bottom;
+    };
+
+    /* chromaticities of a row go through the batch conversions together */
+    struct ChromaticityRow {
+        size_t size() const { return this->x.size(); }
+
+        void clear() {
+            this->x.clear();
+            this->y.clear();
+        }
+
+        void push(double cx, double cy) {
+            this->x.push_back(cx);
+            this->y.push_back(cy);
+        }
+
+        void convert(CIE_Standard standard, double luminance) {
+            size_t n = this->size();
+
+            this->X.resize(n);
+            this->Y.resize(n);
+            this->Z.resize(n);
+            this->R.resize(n);
+            this->G.resize(n);
+            this->B.resize(n);
+
+            CIE_xyY_to_XYZ(this->x.data(), this->y.data(), this->X.data(), this->Y.data(), this->Z.data(), n, luminance);
+            CIE_XYZ_to_RGB(standard, this->X.data(), this->Y.data(), this->Z.data(), this->R.data(), this->G.data(), this->B.data(), n, true);
+        }
+
+        std::vector<double> x, y;
+        std::vector<double> X, Y, Z;
+        std::vector<double> R, G, B;
+    };
+}
+
+static inline void render_pixel(std::vector<uint32_t>& pixels, int pwidth, int pheight, double x, double y, double R, double G, double B) {
+    int px = fl2fxi(flround(x));
+    int py = fl2fxi(flround(y));
+
+    if ((px >= 0) && (px < pwidth) && (py >= 0) && (py < pheight)) {
+        pixels[size_t(py) * size_t(pwidth) + size_t(px)] = RGBA(R, G, B).rgba();
+    }
+}
+
+/* band workers are shared by all chromalets, and are only driven by the rendering thread */
+static std::vector<std::thread> band_workers;
+static std::deque<std::pair<int, int>> band_jobs;
+static std::function<void(int, int)> band_renderer;
+static std::condition_variable band_signal;
+static std::condition_variable band_done_signal;
+static std::mutex band_mutex;
+static size_t band_pending = 0U;
+static bool band_workers_stopping = false;
+
+static void band_work() {
+    std::unique_lock<std::mutex> lock(band_mutex);
+
+    while (!band_workers_stopping) {
+        if (band_jobs.empty()) {
+            band_signal.wait(lock);
+        } else {
+            std::pair<int, int> band = band_jobs.front();
+
+            band_jobs.pop_front();
+            lock.unlock();
+            band_renderer(band.first, band.second);
+            lock.lock();
+
+            if (-- band_pending == 0U) {
+                band_done_signal.notify_one();
+            }
+        }
+    }
+}
+
+static void band_stop_workers() {
+    {
+        std::unique_lock<std::mutex> lock(band_mutex);
+
+        band_workers_stopping = true;
+    }
+
+    band_signal.notify_all();
+
+    for (auto& worker : band_workers) {
+        worker.join();
+    }
+
+    band_workers.clear();
+    band_workers_stopping = false;
+}
+
+/** NOTE
+ * Workers are started at the first rendering, leaving one core for the rendering thread,
+ *   which renders a band itself, and are stopped at exit.
+ */
+static void band_start_workers() {
+    if (band_workers.empty()) {
+        int n = int(std::thread::hardware_concurrency());
+
+        for (int idx = 1; idx < n; idx ++) {
+            band_workers.push_back(std::thread(band_work));
+        }
+
+        static bool registered = false;
+
+        if (!registered) {
+            atexit(band_stop_workers);
+            registered = true;
+        }
+    }
+}
+
+/* rows are independent of each other, hence bands of rows for all cores */
+static void render_bands(int start, int end, const std::function<void(int, int)>& render_rows) {
+    int n = 0;
+    int band = 0;
+
+    band_start_workers();
+    n = int(band_workers.size()) + 1;
+    n = ((n < end - start) ? n : (end - start));
+
+    if (n > 0) {
+        band = (end - start + n - 1) / n;
+
+        {
+            std::unique_lock<std::mutex> lock(band_mutex);
+
+            band_renderer = render_rows;
+
+            for (int idx = 1; idx < n; idx ++) {
+                int y0 = start + band * idx;
+
+                if (y0 < end) {
+                    band_jobs.push_back({ y0, fxmin(y0 + band, end) });
+                    band_pending ++;
+                }
+            }
+        }
+
+        band_signal.notify_all();
+        render_rows(start, fxmin(start + band, end));
+
+        {
+            std::unique_lock<std::mutex> lock(band_mutex);
+
+            band_done_signal.wait(lock, []() { return band_pending == 0U; });
+            band_renderer = nullptr;
+        }
+    }
+}
+
 /*************************************************************************************************/
 Plteen::Chromalet::Chromalet(float width, float height, CIE_Standard std, double Y)
         : width(width), height(height), standard(std), pseudo_primary_triangle_color(GRAY), luminance(Y) {
@@ -247,6 +413,7 @@ Box Plteen::Chromalet::get_bounding_box() {
 
 void Plteen::Chromalet::on_resize(float w, float h, float width, float height) {
     ICanvaslet::on_resize(w, h, width, height);
+    this->invalidate_chart();
 
     this->width = w;
     this->height = h;
@@ -254,16 +421,15 @@ void Plteen::Chromalet::on_resize(float w, float h, float width, float height) {
 
 void Plteen::Chromalet::draw_before_canvas(Plteen::dc_t* dc, float flx, float fly, float flwidth, float flheight) { 
     dc->draw_grid(10, 10, (flwidth - 2.0F) / 10.0F, (flheight - 2.0F)/ 10.0F, DIMGRAY, flx, fly);
-    SDL_RenderDrawLineF(dc->self(), flx, fly, flx + flwidth, fly + flheight);
+    dc->draw_line(flx, fly, flx + flwidth, fly + flheight, DIMGRAY);
 }
 
 void Plteen::Chromalet::draw_on_canvas(Plteen::dc_t* dc, float flwidth, float flheight) {
     double imaginary_width = abs(this->width);
     double imaginary_height = abs(this->height);
  
-    // this->draw_color_map(dc, imaginary_width, imaginary_height);
     this->draw_spectral_locus(dc, imaginary_width, imaginary_height);
-    this->draw_chromaticity(dc, imaginary_width, imaginary_height);
+    this->draw_chart(dc, imaginary_width, imaginary_height);
 }
 
 void Plteen::Chromalet::draw_after_canvas(Plteen::dc_t* dc, float flx, float fly, float flwidth, float flheight) {
@@ -425,26 +591,6 @@ void Plteen::Chromalet::draw_color_triangle(Plteen::dc_t* dc, double dx, double
     }
 }
 
-void Plteen::Chromalet::draw_color_map(Plteen::dc_t* dc, double flwidth, double flheight, double dx, double dy) {
-    double X, Y, Z, R, G, B, x, y;
-
-    for (int px = 0; px < fl2fxi(flwidth); px ++) {
-        for (int py = 0; py < fl2fxi(flheight); py ++) {
-            x = double(px) / flwidth;
-            y = double(py) / flheight;
-                    
-            if (x + y <= 1.0) {
-                CIE_xyY_to_XYZ(x, y, &X, &Y, &Z, this->luminance);
-                CIE_XYZ_to_RGB(this->standard, X, Y, Z, &R, &G, &B, true);
-
-                if ((R >= 0.0) && (G >= 0.0) && (B >= 0.0)) {
-                    this->render_dot(dc, x, y, flwidth, flheight, R, G, B, dx, dy);
-                }
-            }
-        }
-    }
-}
-
 void Plteen::Chromalet::draw_spectral_locus(Plteen::dc_t* dc, double flwidth, double flheight, double dx, double dy) {
     double R, G, B, xbar, ybar, zbar, x, y;
     
@@ -459,28 +605,90 @@ void Plteen::Chromalet::draw_spectral_locus(Plteen::dc_t* dc, double flwidth, do
     }
 }
 
-void Plteen::Chromalet::draw_chromaticity(Plteen::dc_t* dc, double flwidth, double flheight, double dx, double dy) {
+void Plteen::Chromalet::draw_chart(Plteen::dc_t* dc, double flwidth, double flheight, double dx, double dy) {
+    int pwidth = fl2fxi(flwidth) + 1;
+    int pheight = fl2fxi(flheight) + 1;
+
+    if (this->chart_dirty || (this->chart.use_count() == 0)) {
+        std::vector<uint32_t> pixels(size_t(pwidth) * size_t(pheight), 0U);
+        int cwidth = 0;
+        int cheight = 0;
+
+        this->render_chromaticity(pixels, pwidth, pheight, flwidth, flheight);
+
+        if (this->chart.use_count() > 0) {
+            this->chart->feed_extent(&cwidth, &cheight);
+        }
+
+        if ((cwidth != pwidth) || (cheight != pheight)) {
+            this->chart = std::make_shared<Texture>(SDL_CreateTexture(dc->unsafe_self(),
+                                SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
+                                pwidth, pheight));
+
+            if (this->chart->okay()) {
+                SDL_SetTextureBlendMode(this->chart->self(), SDL_BLENDMODE_BLEND);
+            }
+        }
+
+        if (this->chart->okay()) {
+            SDL_UpdateTexture(this->chart->self(), nullptr, pixels.data(), pwidth * int(sizeof(uint32_t)));
+        } else {
+            this->log_message(Log::Error, make_nstring("failed to make the chart of %s: %s", this->name(), SDL_GetError()));
+        }
+
+        this->chart_dirty = false;
+    }
+
+    if (this->chart->okay()) {
+        dc->stamp(this->chart->self(), float(dx), float(dy));
+    }
+}
+
+void Plteen::Chromalet::render_chromaticity(std::vector<uint32_t>& pixels, int pwidth, int pheight, double flwidth, double flheight) {
+    std::vector<ChromaticityColumn> columns;
     int slt_idx = this->scanline_idx0;
     int slb_idx = this->scanline_idx0;
-    double X, Y, Z, R, G, B;
-    double fx, fy, ty, by;
+    double ty, by;
+    int ymin = pheight;
+    int ymax = 0;
     
     if (this->locus_xs == nullptr) {
         this->make_locus_polygon(flwidth, flheight);
         slt_idx = slb_idx = this->scanline_idx0;
     }
 
+    /* walking the locus is sequential, but cheap, the conversions are done in bands of rows */
     for (double x = flround(this->scanline_start); x <= this->scanline_end; x += 1.0) {
-        fx = x / flwidth;
         this->spectrum_intersection_vpoints(x, flheight, slt_idx, slb_idx, &ty, &by);
+        columns.push_back({ x, fl2fxi(flfloor(ty)), fl2fxi(flceiling(by)) });
+        ymin = fxmin(ymin, columns.back().top);
+        ymax = fxmax(ymax, columns.back().bottom);
+    }
 
-        for (double y = flfloor(ty); y <= flceiling(by); y += 1.0) {
-            fy = 1.0 - y / flheight;        
-            CIE_xyY_to_XYZ(fx, fy, &X, &Y, &Z, this->luminance);
-            CIE_XYZ_to_RGB(this->standard, X, Y, Z, &R, &G, &B, true);
-            this->render_dot(dc, fx, fy, flwidth, flheight, R, G, B, dx, dy);
+    render_bands(ymin, ymax + 1, [&](int y0, int y1) {
+        ChromaticityRow row;
+        double fx, fy;
+
+        for (int y = y0; y < y1; y ++) {
+            row.clear();
+            fy = 1.0 - double(y) / flheight;
+
+            for (auto& column : columns) {
+                if ((column.top <= y) && (y <= column.bottom)) {
+                    row.push(column.x / flwidth, fy);
+                }
+            }
+
+            row.convert(this->standard, this->luminance);
+
+            for (size_t idx = 0; idx < row.size(); idx ++) {
+                fx = row.x[idx];
+                fy = row.y[idx];
+                this->fix_render_location(&fx, &fy);
+                render_pixel(pixels, pwidth, pheight, fx * flwidth, fy * flheight, row.R[idx], row.G[idx], row.B[idx]);
+            }
         }
-    };
+    });
 }
 
 /*************************************************************************************************/
@@ -596,9 +804,14 @@ void Plteen::Chromalet::invalidate_locus() {
     }
 }
 
+void Plteen::Chromalet::invalidate_chart() {
+    this->chart_dirty = true;
+}
+
 void Plteen::Chromalet::set_luminance(double Y) {
     if (this->luminance != Y) {
         this->luminance = Y;
+        this->invalidate_chart();
         this->dirty_canvas();
     }
 }
@@ -606,6 +819,7 @@ void Plteen::Chromalet::set_luminance(double Y) {
 void Plteen::Chromalet::set_standard(CIE_Standard std) {
     if (this->standard != std) {
         this->standard = std;
+        this->invalidate_chart();
         this->dirty_canvas();
     }    
 }
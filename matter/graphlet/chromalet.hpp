@@ -5,6 +5,9 @@
 #include "../../physics/algebra/point.hpp"
 #include "../../physics/geometry/aabox.hpp"
 
+#include <vector>
+#include <cstdint>
+
 namespace Plteen {
     class __lambda__ Chromalet : public Plteen::ICanvaslet {
     public:
@@ -43,9 +46,11 @@ namespace Plteen {
     
     private:
         void draw_color_triangle(Plteen::dc_t* dc, double dx = 0.0, double dy = 0.0);
-        void draw_color_map(Plteen::dc_t* dc, double width, double height, double dx = 0.0, double dy = 0.0);
         void draw_spectral_locus(Plteen::dc_t* dc, double width, double height, double dx = 0.0, double dy = 0.0);
-        void draw_chromaticity(Plteen::dc_t* dc, double width, double height, double dx = 0.0, double dy = 0.0);
+        void draw_chart(Plteen::dc_t* dc, double width, double height, double dx = 0.0, double dy = 0.0);
+
+    private:
+        void render_chromaticity(std::vector<uint32_t>& pixels, int pwidth, int pheight, double width, double height);
 
     private:
         void fix_render_location(double* x, double* y);
@@ -57,6 +62,7 @@ namespace Plteen {
 
     private:
         void invalidate_locus();
+        void invalidate_chart();
 
     private:
         float width;
@@ -75,5 +81,13 @@ namespace Plteen {
         double scanline_start = 0.0;
         double scanline_end = 0.0;
         int scanline_idx0 = 0U;
+
+    private:
+        /** NOTE
+         * The chart is computed into a pixel buffer and uploaded through a streaming texture,
+         *   which survives refreshing the canvas, and is only recomputed when the luminance, the standard or the size changes.
+         */
+        Plteen::shared_texture_t chart = nullptr;
+        bool chart_dirty = true;
     };
 }
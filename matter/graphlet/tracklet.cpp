@@ -39,19 +39,20 @@ void Plteen::Tracklet::add_line(float x1, float y1, float x2, float y2) {
                 uint8_t r, g, b, a;
 
                 if (this->pen_okay(&r, &g, &b, &a)) {
+                    /* `set_target()` has submitted recorded commands, nothing is recorded in between */
                     master->set_target(this->canvas->self());
                 
                     if (this->line_width <= 1) {
-                        aalineRGBA(master->self(), fx1, fy1, fx2, fy2, r, g, b, a);
+                        aalineRGBA(master->unsafe_self(), fx1, fy1, fx2, fy2, r, g, b, a);
                     } else {
                         int radius = this->line_width / 2;
 
-                        filledCircleRGBA(master->self(), fx1, fy1, radius, r, g, b, a);
-                        filledCircleRGBA(master->self(), fx2, fy2, radius, r, g, b, a);
-                        thickLineRGBA(master->self(), fx1, fy1, fx2, fy2, this->line_width, r, g, b, a);
+                        filledCircleRGBA(master->unsafe_self(), fx1, fy1, radius, r, g, b, a);
+                        filledCircleRGBA(master->unsafe_self(), fx2, fy2, radius, r, g, b, a);
+                        thickLineRGBA(master->unsafe_self(), fx1, fy1, fx2, fy2, this->line_width, r, g, b, a);
                     }
 
-                    SDL_SetRenderTarget(master->self(), origin);
+                    master->set_target(origin);
 
                     this->resolve_boundary(x1, y1);
                     this->resolve_boundary(x2, y2);
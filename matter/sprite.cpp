@@ -283,6 +283,24 @@ int Plteen::ISprite::update(uint64_t count, uint32_t interval, uint64_t uptime)
     return duration;
 }
 
+bool Plteen::ISprite::is_quiescent(uint64_t uptime, uint64_t* wakeup) {
+    bool quiescent = false;
+
+    if ((!this->in_playing()) && (this->frame_refs.size() == 0)) {
+        uint64_t idle_interval = this->preferred_idle_duration();
+
+        if (idle_interval == 0U) {
+            quiescent = true;
+        } else if (this->idle_time0 > 0U) {
+            // the idle animation is due then
+            (*wakeup) = this->idle_time0 + idle_interval;
+            quiescent = true;
+        }
+    }
+
+    return quiescent;
+}
+
 size_t Plteen::ISprite::play(const char* action, int repetition) {
     this->current_action_name.clear();
     this->current_action_name.append((action == nullptr) ? "" : action);
@@ -1,24 +1,283 @@
 #include "folder.hpp"
 
+#include "../../plane.hpp"
+
+#include "../../graphics/packer.hpp"
+
 #include "../../datum/box.hpp"
 #include "../../datum/path.hpp"
 #include "../../datum/string.hpp"
 #include "../../datum/flonum.hpp"
+#include "../../datum/fixnum.hpp"
 
 #include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <map>
 
 using namespace Plteen;
 using namespace std::filesystem;
 
 /*************************************************************************************************/
-Plteen::Sprite::Sprite(const char* pathname_fmt, ...) {
+/* `src` is relative to the costume, and is clipped by it, so that neighbours in the atlas never show up */
+static inline SDL_Rect unsafe_costume_region(const SDL_Rect& region, const SDL_Rect* src) {
+    SDL_Rect self = region;
+
+    if (src != nullptr) {
+        int x = fxmax(src->x, 0);
+        int y = fxmax(src->y, 0);
+
+        self.x += x;
+        self.y += y;
+        self.w = fxmax(fxmin(src->x + src->w, region.w) - x, 0);
+        self.h = fxmax(fxmin(src->y + src->h, region.h) - y, 0);
+    }
+
+    return self;
+}
+
+static const int COMPOSITE_MAX_SIZE = 2048;
+static const int COMPOSITE_PADDING = 1;
+
+static shared_costume_set_t empty_costume_set = std::make_shared<CostumeSet>();
+static std::map<std::string, std::unordered_map<SDL_Renderer*, std::weak_ptr<CostumeSet>>> costume_sets;
+
+/*************************************************************************************************/
+static inline std::string costume_key(const char* name) {
+    std::string key(name);
+
+    for (size_t idx = 0; idx < key.size(); idx ++) {
+        key[idx] = char(std::tolower(static_cast<unsigned char>(key[idx])));
+    }
+
+    return key;
+}
+
+static shared_costume_set_t costume_set_build(const std::string& abspath, SDL_Renderer* renderer, bool async) {
+    shared_costume_set_t set = nullptr;
+    path target = abspath;
+    
+    if (exists(target)) {
+        set = std::make_shared<CostumeSet>();
+
+        if (is_directory(target)) {
+            shared_texture_pack_t pack = async ? atlasdb_ref_async(abspath, renderer) : atlasdb_ref(abspath, renderer);
+
+            if (pack != nullptr) {
+                set->arrivals.assign(pack->regions.begin(), pack->regions.end());
+            }
+        } else {
+            std::string name = file_basename_from_path(abspath);
+            shared_texture_t costume = async ? imgdb_ref_async(abspath, renderer) : imgdb_ref(abspath, renderer);
+
+            set->arrivals.push_back({ name, { costume, { 0, 0, 0, 0 } } });
+        }
+    }
+
+    return set;
+}
+
+/** NOTE
+ * Sets are held weakly, so that they are released along with the last sprite,
+ *   and so are their textures, which are then up to the imgdb and atlasdb.
+ */
+static shared_costume_set_t costume_set_ref(const std::string& abspath, SDL_Renderer* renderer, bool async) {
+    std::weak_ptr<CostumeSet>& ref = costume_sets[abspath][renderer];
+    shared_costume_set_t set = ref.lock();
+
+    if (set == nullptr) {
+        set = costume_set_build(abspath, renderer, async);
+        ref = set;
+    } else if (!async) {
+        for (auto& arrival : set->arrivals) {
+            imgdb_load_pending(arrival.second.atlas);
+        }
+    }
+
+    return set;
+}
+
+/**
+ * Returns `true` if the set is complete, the first caller after all textures arrive completes it.
+ */
+static bool costume_set_load(CostumeSet* set) {
+    bool okay = true;
+
+    for (size_t idx = 0; okay && (idx < set->arrivals.size()); idx ++) {
+        okay = !imgdb_pending(set->arrivals[idx].second.atlas);
+    }
+
+    if (okay && !set->arrivals.empty()) {
+        for (auto& arrival : set->arrivals) {
+            TextureRegion& region = arrival.second;
+            size_t slash = arrival.first.find('/');
+
+            if (region.atlas->okay()) {
+                if ((region.region.w == 0) && (region.region.h == 0)) { // a single image
+                    region.atlas->feed_extent(&region.region.w, &region.region.h);
+                }
+
+                if (slash == std::string::npos) {
+                    if (!arrival.first.empty()) { // ignore dot files
+                        set->costumes.push_back(arrival);
+                    }
+                } else if (slash + 1 < arrival.first.size()) {
+                    set->decorates[arrival.first.substr(0, slash)][arrival.first.substr(slash + 1)] = region;
+                }
+            }
+        }
+
+        std::stable_sort(set->costumes.begin(), set->costumes.end(),
+            [](const std::pair<std::string, TextureRegion>& lhs, const std::pair<std::string, TextureRegion>& rhs) {
+                return lhs.first < rhs.first;
+            });
+
+        for (size_t idx = 0; idx < set->costumes.size(); idx ++) {
+            set->indices.emplace(costume_key(set->costumes[idx].first.c_str()), idx);
+        }
+
+        set->arrivals.clear();
+        set->arrivals.shrink_to_fit();
+    }
+
+    return okay;
+}
+
+/** NOTE
+ * Composites are packed into a few target textures just like the atlases,
+ *   costumes are copied as is, and then decorates are blended over them,
+ *   hence the alpha of the composites are exact only if either of the two pixels is opaque.
+ */
+static shared_costume_composites_t costume_composites_build(CostumeSet* set, const std::string& name, dc_t* dc) {
+    shared_costume_composites_t self = std::make_shared<CostumeComposites>();
+    auto decorate = set->decorates.find(name);
+    size_t n = set->costumes.size();
+
+    for (auto& costume : set->costumes) {
+        self->costumes.push_back(costume.second);
+    }
+
+    if (decorate != set->decorates.end()) {
+        std::vector<const TextureRegion*> overlays(n, nullptr);
+        std::vector<size_t> pages(n, 0U);
+        std::vector<SkylinePacker> packers;
+        std::vector<std::pair<SDL_Texture*, SDL_BlendMode>> bases;
+
+        for (size_t idx = 0U; idx < n; idx ++) {
+            const TextureRegion& costume = set->costumes[idx].second;
+            auto deco_costume = decorate->second.find(set->costumes[idx].first);
+
+            if (deco_costume != decorate->second.end()) {
+                int w = costume.region.w + COMPOSITE_PADDING;
+                int h = costume.region.h + COMPOSITE_PADDING;
+                bool packed = false;
+
+                for (size_t pdx = 0U; (!packed) && (pdx < packers.size()); pdx ++) {
+                    if (packers[pdx].pack(w, h, &self->costumes[idx].region)) {
+                        pages[idx] = pdx;
+                        packed = true;
+                    }
+                }
+
+                if (!packed) {
+                    packers.push_back(SkylinePacker(fxmax(w, COMPOSITE_MAX_SIZE), fxmax(h, COMPOSITE_MAX_SIZE)));
+                    packers.back().pack(w, h, &self->costumes[idx].region);
+                    pages[idx] = packers.size() - 1U;
+                }
+
+                self->costumes[idx].region.w = costume.region.w;
+                self->costumes[idx].region.h = costume.region.h;
+                overlays[idx] = &deco_costume->second;
+
+                if (std::find_if(bases.begin(), bases.end(), [&costume](const std::pair<SDL_Texture*, SDL_BlendMode>& base) {
+                        return base.first == costume.atlas->self(); }) == bases.end()) {
+                    SDL_BlendMode mode = SDL_BLENDMODE_BLEND;
+
+                    SDL_GetTextureBlendMode(costume.atlas->self(), &mode);
+                    bases.push_back({ costume.atlas->self(), mode });
+                }
+            }
+        }
+
+        if (!packers.empty()) {
+            SDL_Texture* origin = dc->get_target();
+            SDL_Rect clip;
+            bool clipping = dc->feed_clipping_region(&clip);
+
+            for (auto& packer : packers) {
+                self->atlases.push_back(std::make_shared<Texture>(dc->create_blank_image(packer.used_width(), packer.used_height())));
+            }
+
+            /* copy costumes without blending, page by page, then blend decorates over them */
+            for (size_t pdx = 0U; pdx < self->atlases.size(); pdx ++) {
+                shared_texture_t atlas = self->atlases[pdx];
+
+                if (atlas->okay()) {
+                    dc->set_target(atlas->self());
+                    dc->clear_clipping_region();
+
+                    for (auto& base : bases) {
+                        SDL_SetTextureBlendMode(base.first, SDL_BLENDMODE_NONE);
+                    }
+
+                    for (size_t idx = 0U; idx < n; idx ++) {
+                        if ((overlays[idx] != nullptr) && (pages[idx] == pdx)) {
+                            SDL_Rect src = set->costumes[idx].second.region;
+                            SDL_FRect dst = { float(self->costumes[idx].region.x), float(self->costumes[idx].region.y),
+                                              float(src.w), float(src.h) };
+                            
+                            dc->stamp(set->costumes[idx].second.atlas->self(), &src, &dst);
+                        }
+                    }
+
+                    dc->flush();
+
+                    for (auto& base : bases) {
+                        SDL_SetTextureBlendMode(base.first, base.second);
+                    }
+
+                    for (size_t idx = 0U; idx < n; idx ++) {
+                        if ((overlays[idx] != nullptr) && (pages[idx] == pdx)) {
+                            SDL_Rect src = overlays[idx]->region;
+                            SDL_FRect dst = { float(self->costumes[idx].region.x), float(self->costumes[idx].region.y),
+                                              float(self->costumes[idx].region.w), float(self->costumes[idx].region.h) };
+
+                            dc->stamp(overlays[idx]->atlas->self(), &src, &dst);
+                        }
+                    }
+                }
+            }
+
+            // the clipping region is dropped by switching targets
+            dc->set_target(origin);
+            dc->set_clipping_region(clipping ? &clip : nullptr);
+
+            for (size_t idx = 0U; idx < n; idx ++) {
+                if (overlays[idx] != nullptr) {
+                    shared_texture_t atlas = self->atlases[pages[idx]];
+
+                    if (atlas->okay()) {
+                        self->costumes[idx].atlas = atlas;
+                    } else { // fallback to the bare costume
+                        self->costumes[idx] = set->costumes[idx].second;
+                    }
+                }
+            }
+        }
+    }
+
+    return self;
+}
+
+/*************************************************************************************************/
+Plteen::Sprite::Sprite(const char* pathname_fmt, ...) : costume_set(empty_costume_set) {
     VSNPRINT(pathname, pathname_fmt);
 
     this->_pathname = pathname;
     this->enable_resize(true);
 }
 
-Plteen::Sprite::Sprite(const std::string& pathname) : _pathname(pathname) {
+Plteen::Sprite::Sprite(const std::string& pathname) : costume_set(empty_costume_set), _pathname(pathname) {
     this->enable_resize(true);
 }
 
@@ -30,60 +289,82 @@ const char* Plteen::Sprite::name() {
     return _name.c_str();
 }
 
+/** NOTE
+ * Costumes and decorates in a folder are packed into a few atlases,
+ *   so that they are drawn with source regions of the shared textures,
+ *   which saves texture memory and allows the drawing context to batch them.
+ *
+ * With async loading enabled, the sprite is not ready until all its textures are uploaded,
+ *   which is checked in `update`, and then the plane is notified.
+ */
 void Plteen::Sprite::construct(Plteen::dc_t* dc) {
-    path target = imgdb_absolute_path(this->_pathname);
+    shared_costume_set_t set = costume_set_ref(imgdb_absolute_path(this->_pathname), dc->unsafe_self(), this->async_loading);
     
-    if (exists(target)) {
-        if (is_directory(target)) {
-            for (auto entry : directory_iterator(target)) {
-                if (entry.is_regular_file()) {
-                    this->load_costume(dc, entry.path().string());
-                } else if (entry.is_directory()) {
-                    std::string decorate_name = file_basename_from_path(entry.path().string());
-
-                    for (auto subentry : directory_iterator(entry)) {
-                        if (subentry.is_regular_file()) {
-                            this->load_decorate(dc, decorate_name, subentry.path().string());
-                        }
-                    }
-                }
-            }
-        } else {
-            this->load_costume(dc, this->_pathname);
-        }
+    if (set != nullptr) {
+        this->costume_set = set;
+        this->costumes_pending = true;
+        this->load_arrived_costumes();
+    }
+}
 
-        this->on_costumes_load();
-        ISprite::construct(dc);
+int Plteen::Sprite::update(uint64_t count, uint32_t interval, uint64_t uptime) {
+    int duration = 0;
+
+    if (!this->costumes_pending) {
+        duration = ISprite::update(count, interval, uptime);
+    } else if (this->load_arrived_costumes()) {
+        IPlane* master = this->master();
+
+        if (master != nullptr) {
+            master->notify_matter_ready(this);
+        }
     }
+
+    return duration;
+}
+
+bool Plteen::Sprite::is_quiescent(uint64_t uptime, uint64_t* wakeup) {
+    return !this->costumes_pending && ISprite::is_quiescent(uptime, wakeup);
 }
 
 void Plteen::Sprite::feed_costume_extent(size_t idx, float* width, float* height) {
-    this->costumes[idx].second->feed_extent(width, height);
+    const SDL_Rect& region = this->costume_set->costumes[idx].second.region;
+
+    SET_VALUES(width, float(region.w), height, float(region.h));
 }
 
+/** NOTE
+ * While wearing, costumes are drawn from the composites,
+ *   which are taken from the costume set, or are made at the first drawing after `wear()`.
+ */
 void Plteen::Sprite::draw_costume(Plteen::dc_t* dc, size_t idx, SDL_Rect* src, SpriteRenderArguments* argv) {
-    dc->stamp(this->costumes[idx].second->self(), src, &argv->dst, argv->flip);
+    if (!this->current_decorate.empty() && (this->composites == nullptr)) {
+        this->composite_costumes(dc);
+    }
 
-    if (this->current_decorate.size() > 0) {
-        std::string c_name = this->costumes[idx].first;
-        auto decorate = this->decorates[this->current_decorate];
+    const TextureRegion& costume = (this->composites == nullptr) ? this->costume_set->costumes[idx].second : this->composites->costumes[idx];
+    SDL_Rect region = unsafe_costume_region(costume.region, src);
 
-        if (decorate.find(c_name) != decorate.end()) {
-            dc->stamp(decorate[c_name]->self(), src, &argv->dst, argv->flip);
-        }
-    }
+    dc->stamp(costume.atlas->self(), &region, &argv->dst, argv->flip);
 }
 
 size_t Plteen::Sprite::costume_count() {
-    return this->costumes.size();
+    return this->costume_set->costumes.size();
 }
 
 const char* Plteen::Sprite::costume_index_to_name(size_t idx) {
-    return this->costumes[idx].first.c_str();
+    return this->costume_set->costumes[idx].first.c_str();
+}
+
+int Plteen::Sprite::costume_name_to_index(const char* name) {
+    auto it = this->costume_set->indices.find(costume_key(name));
+
+    return (it != this->costume_set->indices.end()) ? int(it->second) : ISprite::costume_name_to_index(name);
 }
 
 void Plteen::Sprite::wear(const std::string& name) {
-    if (this->decorates.find(name) != this->decorates.end()) {
+    if ((name != this->current_decorate) && (this->costume_set->decorates.find(name) != this->costume_set->decorates.end())) {
+        this->release_composites();
         this->current_decorate = name;
         this->notify_updated();
     }
@@ -91,48 +372,39 @@ void Plteen::Sprite::wear(const std::string& name) {
 
 void Plteen::Sprite::take_off() {
     if (!this->current_decorate.empty()) {
+        this->release_composites();
         this->current_decorate.clear();
         this->notify_updated();
     }
 }
 
-void Plteen::Sprite::load_costume(Plteen::dc_t* dc, const std::string& png) {
-    std::string name = file_basename_from_path(png);
+/** NOTE
+ * Composites are shared through the costume set by the name of the decorate,
+ *   and, like the sets, they are held weakly and released along with the last sprite wearing them.
+ */
+void Plteen::Sprite::composite_costumes(Plteen::dc_t* dc) {
+    std::weak_ptr<CostumeComposites>& ref = this->costume_set->composites[this->current_decorate];
     
-    if (!name.empty()) { // ignore dot files
-        shared_texture_t costume = imgdb_ref(png, dc->self());
-
-        if (costume->okay()) {
-            auto datum = std::pair<std::string, shared_texture_t>(name, costume);
-        
-            for (auto it = this->costumes.begin(); ; it++) {
-                if (it == this->costumes.end()) {
-                    this->costumes.push_back(datum);
-                    break;
-                } else {
-                    if (name.compare((*it).first) < 0) {
-                        this->costumes.insert(it, datum);
-                        break;
-                    }
-                }
-            }
-        }
+    this->composites = ref.lock();
+
+    if (this->composites == nullptr) {
+        this->composites = costume_composites_build(this->costume_set.get(), this->current_decorate, dc);
+        ref = this->composites;
     }
 }
 
-void Plteen::Sprite::load_decorate(Plteen::dc_t* dc, const std::string& d_name, const std::string& png) {
-    std::string c_name = file_basename_from_path(png);
+void Plteen::Sprite::release_composites() {
+    this->composites.reset();
+}
 
-    if (!c_name.empty()) {
-        shared_texture_t deco_costume = imgdb_ref(png, dc->self());
+bool Plteen::Sprite::load_arrived_costumes() {
+    bool okay = costume_set_load(this->costume_set.get());
 
-        if (deco_costume->okay()) {
-        
-            if (this->decorates.find(d_name) == this->decorates.end()) {
-                this->decorates[d_name] = { { c_name, deco_costume } };
-            } else {
-                this->decorates[d_name][c_name] = deco_costume;
-            }
-        }
+    if (okay) {
+        this->costumes_pending = false;
+        this->on_costumes_load();
+        ISprite::construct(this->drawing_context());
     }
+
+    return okay;
 }
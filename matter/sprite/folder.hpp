@@ -2,11 +2,41 @@
 
 #include "../sprite.hpp"
 #include "../../virtualization/filesystem/imgdb.hpp"
+#include "../../virtualization/filesystem/atlasdb.hpp"
 
 #include <vector>
+#include <memory>
 #include <unordered_map>
 
 namespace Plteen {
+    /** NOTE
+     * Costumes composited with a decorate, in the same order of the costumes,
+     *   costumes that have no matched decorate simply share their original regions.
+     */
+    struct __lambda__ CostumeComposites {
+        std::vector<Plteen::TextureRegion> costumes;
+        std::vector<Plteen::shared_texture_t> atlases;
+    };
+
+    typedef std::shared_ptr<Plteen::CostumeComposites> shared_costume_composites_t;
+
+    /** NOTE
+     * Costumes of a folder (or an image) are shared by all sprites of the same path and renderer,
+     *   the set is built once the textures arrive, and is never changed after that,
+     *   except for the composites, which are made on demand and are indexed by the names of decorates.
+     *
+     * Costumes are sorted by names, and are indexed by their lowercased names.
+     */
+    struct __lambda__ CostumeSet {
+        std::vector<std::pair<std::string, Plteen::TextureRegion>> costumes;
+        std::unordered_map<std::string, size_t> indices;
+        std::unordered_map<std::string, std::unordered_map<std::string, Plteen::TextureRegion>> decorates;
+        std::unordered_map<std::string, std::weak_ptr<Plteen::CostumeComposites>> composites;
+        std::vector<std::pair<std::string, Plteen::TextureRegion>> arrivals;
+    };
+
+    typedef std::shared_ptr<Plteen::CostumeSet> shared_costume_set_t;
+
     class __lambda__ Sprite : public Plteen::ISprite {
     public:
         Sprite(const std::string& pathname);
@@ -15,6 +45,12 @@ namespace Plteen {
 
         void construct(Plteen::dc_t* dc) override;
         const char* name() override;
+
+    public:
+        int update(uint64_t count, uint32_t interval, uint64_t uptime) override;
+        bool is_quiescent(uint64_t uptime, uint64_t* wakeup) override;
+        bool ready() override { return !this->costumes_pending; }
+        void enable_async_loading(bool yes = true) { this->async_loading = yes; }
     
     public:
         void wear(const char* name) { this->wear(std::string(name)); }
@@ -29,19 +65,23 @@ namespace Plteen {
     protected:
         void feed_costume_extent(size_t idx, float* width, float* height) override;
         const char* costume_index_to_name(size_t idx) override;
+        int costume_name_to_index(const char* name) override;
         void draw_costume(Plteen::dc_t* renderer, size_t idx, SDL_Rect* src, SpriteRenderArguments* argv) override;
     
     protected:
         virtual void on_costumes_load() {}
 
     private:
-        void load_costume(Plteen::dc_t* dc, const std::string& png);
-        void load_decorate(Plteen::dc_t* dc, const std::string& d_name, const std::string& png);
+        bool load_arrived_costumes();
+        void composite_costumes(Plteen::dc_t* dc);
+        void release_composites();
         
     private:
-        std::vector<std::pair<std::string, shared_texture_t>> costumes;
-        std::unordered_map<std::string, std::unordered_map<std::string, shared_texture_t>> decorates;
+        Plteen::shared_costume_set_t costume_set;
         std::string current_decorate;
+        Plteen::shared_costume_composites_t composites;
+        bool costumes_pending = false;
+        bool async_loading = false;
 
     private:
         std::string _pathname;
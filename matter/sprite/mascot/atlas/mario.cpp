@@ -43,6 +43,7 @@ Plteen::MarioGroundAtlas::MarioGroundAtlas(size_t slot, int row, int col, float
     this->map_col = col;
     this->map_tile_width = tile_size;
     this->map_tile_height = tile_size;
+    this->enable_map_baking(true);
 }
 
 int Plteen::MarioGroundAtlas::get_atlas_tile_index(size_t map_idx, int& xoff, int& yoff) {
@@ -86,6 +87,7 @@ void Plteen::MarioPipe::set_color(MarioPipeColor color) {
 
     if (idx != this->color_idx) {
         this->color_idx = idx;
+        this->invalidate_map_tiles();
         this->notify_updated();
     }
 }
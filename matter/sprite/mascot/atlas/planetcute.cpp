@@ -17,6 +17,7 @@ Plteen::PlanetCuteAtlas::PlanetCuteAtlas(int row, int col, GroundBlockType defau
     : GridAtlas(GROUND_ATLAS_PATH, 1, 8), default_type(default_type) {
         this->map_row = row;
         this->map_col = col;
+        this->enable_map_baking(true);
 }
 
 Plteen::PlanetCuteAtlas::~PlanetCuteAtlas() {
@@ -43,6 +44,7 @@ void Plteen::PlanetCuteAtlas::set_tile_type(int r, int c, GroundBlockType type)
 
     if (this->tiles[r][c] != type) {
         this->tiles[r][c] = type;
+        this->invalidate_map_tile(r * this->map_col + c);
         this->notify_updated();
     }
 }
@@ -88,6 +90,7 @@ Margin Plteen::PlanetCuteTile::get_original_map_overlay() {
 void Plteen::PlanetCuteTile::set_type(GroundBlockType type) {
     if (this->type != type) {
         this->type = type;
+        this->invalidate_map_tiles();
         this->notify_updated();
     }
 }
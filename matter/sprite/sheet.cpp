@@ -23,7 +23,7 @@ const char* Plteen::ISpriteSheet::name() {
 }
 
 void Plteen::ISpriteSheet::construct(Plteen::dc_t* dc) {
-    this->sprite_sheet = imgdb_ref(this->_pathname, dc->self());
+    this->sprite_sheet = imgdb_ref(this->_pathname, dc->unsafe_self());
 
     if (this->sprite_sheet->okay()) {
         this->on_sheet_load(this->sprite_sheet);
@@ -4,15 +4,59 @@
 
 #include "../mathematics.hpp"
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CIE_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
 using namespace Plteen;
 
 /*************************************************************************************************/
+static const double cie_xyz_to_rgb_matrices[][9] = {
+    { // CIE_Standard::Primary
+        +2.36461, -0.89654, -0.46807,
+        -0.51517, +1.42641, +0.08876,
+        +0.00520, -0.01441, +1.00920
+    },
+    { // CIE_Standard::D65
+        +3.240479, -1.537150, -0.498535,
+        -0.969256, +1.875991, +0.041556,
+        +0.055648, -0.204043, +1.057311
+    }
+};
+
+static const double cie_rgb_to_xyz_matrices[][9] = {
+    { // CIE_Standard::Primary
+        0.49000, 0.31000, 0.20000,
+        0.17697, 0.81240, 0.01063,
+        0.00000, 0.01000, 0.99000
+    },
+    { // CIE_Standard::D65
+        0.412453, 0.357580, 0.180423,
+        0.212671, 0.715160, 0.072169,
+        0.019334, 0.119193, 0.950227
+    }
+};
+
+static inline const double* cie_xyz_to_rgb_matrix(CIE_Standard type) {
+    return cie_xyz_to_rgb_matrices[(type == CIE_Standard::D65) ? 1 : 0];
+}
+
+static inline const double* cie_rgb_to_xyz_matrix(CIE_Standard type) {
+    return cie_rgb_to_xyz_matrices[(type == CIE_Standard::D65) ? 1 : 0];
+}
+
+/*************************************************************************************************/
+static const double gamma_encode_threshold = 0.0031308;
+static const double gamma_decode_threshold = 0.04045;
+static const int gamma_lut_size = 4096;
+
 static inline double color_gamma_encode(double c) {
-    return (c <= 0.0031308) ? c * 12.92 : flexpt(c, 1.0 / 2.4 ) * 1.055 - 0.055;
+    return (c <= gamma_encode_threshold) ? c * 12.92 : flexpt(c, 1.0 / 2.4 ) * 1.055 - 0.055;
 }
 
 static inline double color_gamma_decode(double c) {
-    return (c <= 0.04045) ? c / 12.92 : flexpt((c + 0.055) / 1.055, 2.4);
+    return (c <= gamma_decode_threshold) ? c / 12.92 : flexpt((c + 0.055) / 1.055, 2.4);
 }
 
 static inline void cie_rgb_normalize(double* R, double* G, double* B) {
@@ -23,21 +67,295 @@ static inline void cie_rgb_normalize(double* R, double* G, double* B) {
     SET_BOX(B, *B / L);
 }
 
+/** NOTE
+ * Gamma tables sample the curves over [0.0, 1.0] with an extra entry for interpolating the last interval,
+ *   the linear segments near zero and values out of the range are computed exactly instead.
+ */
+static const double* gamma_lut(bool encoding) {
+    static const struct GammaLUTs {
+        GammaLUTs() {
+            for (int idx = 0; idx <= gamma_lut_size; idx ++) {
+                double c = double(idx) / double(gamma_lut_size);
+
+                this->encoding[idx] = color_gamma_encode(c);
+                this->decoding[idx] = color_gamma_decode(c);
+            }
+        }
+
+        double encoding[gamma_lut_size + 1];
+        double decoding[gamma_lut_size + 1];
+    } luts;
+
+    return encoding ? luts.encoding : luts.decoding;
+}
+
+static inline double gamma_lookup(const double* lut, double c) {
+    double t = c * double(gamma_lut_size);
+    int idx = int(t);
+
+    if (idx >= gamma_lut_size) {
+        idx = gamma_lut_size - 1;
+    }
+
+    return lut[idx] + (lut[idx + 1] - lut[idx]) * (t - double(idx));
+}
+
+static inline double color_gamma_encode(const double* lut, double c) {
+    return ((c > gamma_encode_threshold) && (c <= 1.0)) ? gamma_lookup(lut, c) : color_gamma_encode(c);
+}
+
+static inline double color_gamma_decode(const double* lut, double c) {
+    return ((c > gamma_decode_threshold) && (c <= 1.0)) ? gamma_lookup(lut, c) : color_gamma_decode(c);
+}
+
 /*************************************************************************************************/
-void Plteen::CIE_XYZ_to_RGB(CIE_Standard type, double X, double Y, double Z, double* R, double* G, double* B, bool gamma) {
-    switch (type) {
-    case CIE_Standard::Primary: {
-        SET_BOX(R, +2.36461 * X - 0.89654 * Y - 0.46807 * Z);
-        SET_BOX(G, -0.51517 * X + 1.42641 * Y + 0.08876 * Z);
-        SET_BOX(B, +0.00520 * X - 0.01441 * Y + 1.00920 * Z);
-    }; break;
-    case CIE_Standard::D65: {
-        SET_BOX(R, +3.240479 * X - 1.537150 * Y - 0.498535 * Z);
-        SET_BOX(G, -0.969256 * X + 1.875991 * Y + 0.041556 * Z);
-        SET_BOX(B, +0.055648 * X - 0.204043 * Y + 1.057311 * Z);
-    }; break;
+static void cie_xyz_to_rgb_scalar(const double* m, const double* lut, const double* X, const double* Y, const double* Z, double* R, double* G, double* B, size_t start, size_t n) {
+    for (size_t idx = start; idx < n; idx ++) {
+        double x = X[idx];
+        double y = Y[idx];
+        double z = Z[idx];
+        double r = m[0] * x + m[1] * y + m[2] * z;
+        double g = m[3] * x + m[4] * y + m[5] * z;
+        double b = m[6] * x + m[7] * y + m[8] * z;
+
+        cie_rgb_normalize(&r, &g, &b);
+
+        if (lut != nullptr) {
+            if (r >= 0.0) r = color_gamma_encode(lut, r);
+            if (g >= 0.0) g = color_gamma_encode(lut, g);
+            if (b >= 0.0) b = color_gamma_encode(lut, b);
+        }
+
+        R[idx] = r;
+        G[idx] = g;
+        B[idx] = b;
+    }
+}
+
+static void cie_rgb_to_xyz_scalar(const double* m, const double* lut, const double* R, const double* G, const double* B, double* X, double* Y, double* Z, size_t start, size_t n) {
+    for (size_t idx = start; idx < n; idx ++) {
+        double r = R[idx];
+        double g = G[idx];
+        double b = B[idx];
+
+        if (lut != nullptr) {
+            r = color_gamma_decode(lut, r);
+            g = color_gamma_decode(lut, g);
+            b = color_gamma_decode(lut, b);
+        }
+
+        X[idx] = m[0] * r + m[1] * g + m[2] * b;
+        Y[idx] = m[3] * r + m[4] * g + m[5] * b;
+        Z[idx] = m[6] * r + m[7] * g + m[8] * b;
+    }
+}
+
+static void cie_xyY_to_XYZ_scalar(const double* x, const double* y, double* X, double* Y, double* Z, double L, size_t start, size_t n) {
+    for (size_t idx = start; idx < n; idx ++) {
+        double fx = x[idx];
+        double fy = y[idx];
+
+        X[idx] = L * fx / fy;
+        Y[idx] = L;
+        Z[idx] = L * (1.0 - fx - fy) / fy;
+    }
+}
+
+static void cie_XYZ_to_xyY_scalar(const double* X, const double* Y, const double* Z, double* x, double* y, size_t start, size_t n) {
+    for (size_t idx = start; idx < n; idx ++) {
+        double L = X[idx] + Y[idx] + Z[idx];
+        double fy = Y[idx] / L;
+
+        x[idx] = X[idx] / L;
+        y[idx] = fy;
+    }
+}
+
+/*************************************************************************************************/
+#ifdef CIE_AVX2_KERNELS
+static bool cie_avx2_okay() {
+    static const bool okay = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+    return okay;
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d gamma_lookup_avx2(const double* lut, __m256d c) {
+    __m256d t = _mm256_mul_pd(_mm256_min_pd(_mm256_max_pd(c, _mm256_setzero_pd()), _mm256_set1_pd(1.0)), _mm256_set1_pd(double(gamma_lut_size)));
+    __m128i idx = _mm_min_epi32(_mm256_cvttpd_epi32(t), _mm_set1_epi32(gamma_lut_size - 1));
+    __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    // the masked form, with a defined source, keeps GCC from warning `-Wmaybe-uninitialized`
+    __m256d v0 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), lut, idx, all, 8);
+    __m256d v1 = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), lut + 1, idx, all, 8);
+
+    return _mm256_fmadd_pd(_mm256_sub_pd(v1, v0), _mm256_sub_pd(t, _mm256_cvtepi32_pd(idx)), v0);
+}
+
+/* lanes in the linear segment or out of [0.0, 1.0] take the exact formula, which are rare */
+__attribute__((target("avx2,fma")))
+static inline __m256d gamma_encode_avx2(const double* lut, __m256d c) {
+    __m256d ones = _mm256_set1_pd(1.0);
+    __m256d threshold = _mm256_set1_pd(gamma_encode_threshold);
+    __m256d linear = _mm256_and_pd(_mm256_cmp_pd(c, threshold, _CMP_LE_OQ), _mm256_cmp_pd(c, _mm256_setzero_pd(), _CMP_GE_OQ));
+    __m256d curved = _mm256_and_pd(_mm256_cmp_pd(c, threshold, _CMP_GT_OQ), _mm256_cmp_pd(c, ones, _CMP_LE_OQ));
+    __m256d result = _mm256_blendv_pd(c, _mm256_mul_pd(c, _mm256_set1_pd(12.92)), linear);
+    __m256d beyond = _mm256_cmp_pd(c, ones, _CMP_GT_OQ);
+
+    result = _mm256_blendv_pd(result, gamma_lookup_avx2(lut, c), curved);
+
+    if (_mm256_movemask_pd(beyond) != 0) {
+        alignas(32) double lanes[4];
+        alignas(32) double encoded[4];
+
+        _mm256_store_pd(lanes, c);
+        _mm256_store_pd(encoded, result);
+
+        for (int idx = 0; idx < 4; idx ++) {
+            if (lanes[idx] > 1.0) {
+                encoded[idx] = color_gamma_encode(lanes[idx]);
+            }
+        }
+
+        result = _mm256_load_pd(encoded);
+    }
+
+    return result;
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d gamma_decode_avx2(const double* lut, __m256d c) {
+    __m256d ones = _mm256_set1_pd(1.0);
+    __m256d threshold = _mm256_set1_pd(gamma_decode_threshold);
+    __m256d curved = _mm256_and_pd(_mm256_cmp_pd(c, threshold, _CMP_GT_OQ), _mm256_cmp_pd(c, ones, _CMP_LE_OQ));
+    __m256d result = _mm256_div_pd(c, _mm256_set1_pd(12.92));
+    __m256d beyond = _mm256_cmp_pd(c, ones, _CMP_GT_OQ);
+
+    result = _mm256_blendv_pd(result, gamma_lookup_avx2(lut, c), curved);
+
+    if (_mm256_movemask_pd(beyond) != 0) {
+        alignas(32) double lanes[4];
+        alignas(32) double decoded[4];
+
+        _mm256_store_pd(lanes, c);
+        _mm256_store_pd(decoded, result);
+
+        for (int idx = 0; idx < 4; idx ++) {
+            if (lanes[idx] > 1.0) {
+                decoded[idx] = color_gamma_decode(lanes[idx]);
+            }
+        }
+
+        result = _mm256_load_pd(decoded);
+    }
+
+    return result;
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d matrix_row_avx2(const double* row, __m256d a, __m256d b, __m256d c) {
+    return _mm256_fmadd_pd(_mm256_set1_pd(row[2]), c,
+            _mm256_fmadd_pd(_mm256_set1_pd(row[1]), b,
+                _mm256_mul_pd(_mm256_set1_pd(row[0]), a)));
+}
+
+__attribute__((target("avx2,fma")))
+static size_t cie_xyz_to_rgb_avx2(const double* m, const double* lut, const double* X, const double* Y, const double* Z, double* R, double* G, double* B, size_t n) {
+    size_t idx = 0U;
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m256d x = _mm256_loadu_pd(X + idx);
+        __m256d y = _mm256_loadu_pd(Y + idx);
+        __m256d z = _mm256_loadu_pd(Z + idx);
+        __m256d r = matrix_row_avx2(m + 0, x, y, z);
+        __m256d g = matrix_row_avx2(m + 3, x, y, z);
+        __m256d b = matrix_row_avx2(m + 6, x, y, z);
+        __m256d L = _mm256_max_pd(r, _mm256_max_pd(g, b));
+
+        r = _mm256_div_pd(r, L);
+        g = _mm256_div_pd(g, L);
+        b = _mm256_div_pd(b, L);
+
+        if (lut != nullptr) {
+            r = gamma_encode_avx2(lut, r);
+            g = gamma_encode_avx2(lut, g);
+            b = gamma_encode_avx2(lut, b);
+        }
+
+        _mm256_storeu_pd(R + idx, r);
+        _mm256_storeu_pd(G + idx, g);
+        _mm256_storeu_pd(B + idx, b);
+    }
+
+    return idx;
+}
+
+__attribute__((target("avx2,fma")))
+static size_t cie_rgb_to_xyz_avx2(const double* m, const double* lut, const double* R, const double* G, const double* B, double* X, double* Y, double* Z, size_t n) {
+    size_t idx = 0U;
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m256d r = _mm256_loadu_pd(R + idx);
+        __m256d g = _mm256_loadu_pd(G + idx);
+        __m256d b = _mm256_loadu_pd(B + idx);
+
+        if (lut != nullptr) {
+            r = gamma_decode_avx2(lut, r);
+            g = gamma_decode_avx2(lut, g);
+            b = gamma_decode_avx2(lut, b);
+        }
+
+        _mm256_storeu_pd(X + idx, matrix_row_avx2(m + 0, r, g, b));
+        _mm256_storeu_pd(Y + idx, matrix_row_avx2(m + 3, r, g, b));
+        _mm256_storeu_pd(Z + idx, matrix_row_avx2(m + 6, r, g, b));
+    }
+
+    return idx;
+}
+
+__attribute__((target("avx2,fma")))
+static size_t cie_xyY_to_XYZ_avx2(const double* x, const double* y, double* X, double* Y, double* Z, double L, size_t n) {
+    __m256d l = _mm256_set1_pd(L);
+    __m256d ones = _mm256_set1_pd(1.0);
+    size_t idx = 0U;
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m256d fx = _mm256_loadu_pd(x + idx);
+        __m256d fy = _mm256_loadu_pd(y + idx);
+        __m256d fz = _mm256_sub_pd(_mm256_sub_pd(ones, fx), fy);
+
+        _mm256_storeu_pd(X + idx, _mm256_div_pd(_mm256_mul_pd(l, fx), fy));
+        _mm256_storeu_pd(Y + idx, l);
+        _mm256_storeu_pd(Z + idx, _mm256_div_pd(_mm256_mul_pd(l, fz), fy));
+    }
+
+    return idx;
+}
+
+__attribute__((target("avx2,fma")))
+static size_t cie_XYZ_to_xyY_avx2(const double* X, const double* Y, const double* Z, double* x, double* y, size_t n) {
+    size_t idx = 0U;
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m256d vX = _mm256_loadu_pd(X + idx);
+        __m256d vY = _mm256_loadu_pd(Y + idx);
+        __m256d L = _mm256_add_pd(_mm256_add_pd(vX, vY), _mm256_loadu_pd(Z + idx));
+
+        _mm256_storeu_pd(x + idx, _mm256_div_pd(vX, L));
+        _mm256_storeu_pd(y + idx, _mm256_div_pd(vY, L));
     }
 
+    return idx;
+}
+#endif
+
+/*************************************************************************************************/
+void Plteen::CIE_XYZ_to_RGB(CIE_Standard type, double X, double Y, double Z, double* R, double* G, double* B, bool gamma) {
+    const double* m = cie_xyz_to_rgb_matrix(type);
+
+    SET_BOX(R, m[0] * X + m[1] * Y + m[2] * Z);
+    SET_BOX(G, m[3] * X + m[4] * Y + m[5] * Z);
+    SET_BOX(B, m[6] * X + m[7] * Y + m[8] * Z);
+
     cie_rgb_normalize(R, G, B);
     
     if (gamma) {
@@ -48,24 +366,17 @@ void Plteen::CIE_XYZ_to_RGB(CIE_Standard type, double X, double Y, double Z, dou
 }
 
 void Plteen::CIE_RGB_to_XYZ(CIE_Standard type, double R, double G, double B, double* X, double* Y, double* Z, bool gamma) {
+    const double* m = cie_rgb_to_xyz_matrix(type);
+
     if (gamma) {
         R = color_gamma_decode(R);
         G = color_gamma_decode(G);
         B = color_gamma_decode(B);
     }
 
-    switch (type) {
-    case CIE_Standard::Primary: {
-        SET_BOX(X, 0.49000 * R + 0.31000 * G + 0.20000 * B);
-        SET_BOX(Y, 0.17697 * R + 0.81240 * G + 0.01063 * B);
-        SET_BOX(Z, 0.00000 * R + 0.01000 * G + 0.99000 * B);
-    }; break;
-    case CIE_Standard::D65: {
-        SET_BOX(X, 0.412453 * R + 0.357580 * G + 0.180423 * B);
-        SET_BOX(Y, 0.212671 * R + 0.715160 * G + 0.072169 * B);
-        SET_BOX(Z, 0.019334 * R + 0.119193 * G + 0.950227 * B);
-    }; break;
-    }
+    SET_BOX(X, m[0] * R + m[1] * G + m[2] * B);
+    SET_BOX(Y, m[3] * R + m[4] * G + m[5] * B);
+    SET_BOX(Z, m[6] * R + m[7] * G + m[8] * B);
 }
 
 void Plteen::CIE_xyY_to_XYZ(double x, double y, double* X, double* Y, double* Z, double L) {
@@ -82,3 +393,56 @@ void Plteen::CIE_XYZ_to_xyY(double X, double Y, double Z, double* x, double* y)
     SET_BOX(x, X / L);
     SET_BOX(y, Y / L);
 }
+
+/*************************************************************************************************/
+void Plteen::CIE_XYZ_to_RGB(CIE_Standard type, const double* X, const double* Y, const double* Z, double* R, double* G, double* B, size_t n, bool gamma) {
+    const double* m = cie_xyz_to_rgb_matrix(type);
+    const double* lut = gamma ? gamma_lut(true) : nullptr;
+    size_t done = 0U;
+
+#ifdef CIE_AVX2_KERNELS
+    if (cie_avx2_okay()) {
+        done = cie_xyz_to_rgb_avx2(m, lut, X, Y, Z, R, G, B, n);
+    }
+#endif
+
+    cie_xyz_to_rgb_scalar(m, lut, X, Y, Z, R, G, B, done, n);
+}
+
+void Plteen::CIE_RGB_to_XYZ(CIE_Standard type, const double* R, const double* G, const double* B, double* X, double* Y, double* Z, size_t n, bool gamma) {
+    const double* m = cie_rgb_to_xyz_matrix(type);
+    const double* lut = gamma ? gamma_lut(false) : nullptr;
+    size_t done = 0U;
+
+#ifdef CIE_AVX2_KERNELS
+    if (cie_avx2_okay()) {
+        done = cie_rgb_to_xyz_avx2(m, lut, R, G, B, X, Y, Z, n);
+    }
+#endif
+
+    cie_rgb_to_xyz_scalar(m, lut, R, G, B, X, Y, Z, done, n);
+}
+
+void Plteen::CIE_xyY_to_XYZ(const double* x, const double* y, double* X, double* Y, double* Z, size_t n, double L) {
+    size_t done = 0U;
+
+#ifdef CIE_AVX2_KERNELS
+    if (cie_avx2_okay()) {
+        done = cie_xyY_to_XYZ_avx2(x, y, X, Y, Z, L, n);
+    }
+#endif
+
+    cie_xyY_to_XYZ_scalar(x, y, X, Y, Z, L, done, n);
+}
+
+void Plteen::CIE_XYZ_to_xyY(const double* X, const double* Y, const double* Z, double* x, double* y, size_t n) {
+    size_t done = 0U;
+
+#ifdef CIE_AVX2_KERNELS
+    if (cie_avx2_okay()) {
+        done = cie_XYZ_to_xyY_avx2(X, Y, Z, x, y, n);
+    }
+#endif
+
+    cie_XYZ_to_xyY_scalar(X, Y, Z, x, y, done, n);
+}
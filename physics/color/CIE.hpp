@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace Plteen {
     enum class CIE_Standard { Primary , D65 };
 
@@ -7,4 +9,15 @@ namespace Plteen {
     __lambda__ void CIE_RGB_to_XYZ(CIE_Standard type, double R, double G, double B, double* X, double* Y, double* Z, bool gamma = true);
     __lambda__ void CIE_xyY_to_XYZ(double x, double y, double* X, double* Y, double* Z, double L = 1.0);
     __lambda__ void CIE_XYZ_to_xyY(double X, double Y, double Z, double* x, double* y);
+
+    /** NOTE
+     * Batch variants convert `n` samples of SoA arrays at once, outputs may alias inputs of the same position.
+     * They run on AVX2 if the CPU supports it, and fall back to plain loops otherwise,
+     *   the gamma curves are looked up in tables instead of calling `pow`,
+     *   which differ from the scalar ones by less than 1/10000, far below an 8-bit channel.
+     */
+    __lambda__ void CIE_XYZ_to_RGB(CIE_Standard type, const double* X, const double* Y, const double* Z, double* R, double* G, double* B, size_t n, bool gamma = true);
+    __lambda__ void CIE_RGB_to_XYZ(CIE_Standard type, const double* R, const double* G, const double* B, double* X, double* Y, double* Z, size_t n, bool gamma = true);
+    __lambda__ void CIE_xyY_to_XYZ(const double* x, const double* y, double* X, double* Y, double* Z, size_t n, double L = 1.0);
+    __lambda__ void CIE_XYZ_to_xyY(const double* X, const double* Y, const double* Z, double* x, double* y, size_t n);
 }
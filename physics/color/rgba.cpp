@@ -7,6 +7,11 @@
 
 #include "../mathematics.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RGBA_SSE2_KERNELS
+#include <emmintrin.h>
+#endif
+
 using namespace Plteen;
 
 /*************************************************************************************************/
@@ -409,3 +414,161 @@ std::string Plteen::RGBA::hexstring(bool needs_alpha, const char* fmt) const {
 
     return representation;
 }
+
+/*************************************************************************************************/
+void Plteen::HSV_to_RGB(const double* hue, const double* saturation, const double* brightness, double* R, double* G, double* B, size_t n) {
+    for (size_t idx = 0; idx < n; idx ++) {
+        hsv_to_rgb(hue[idx], saturation[idx], brightness[idx], R + idx, G + idx, B + idx);
+    }
+}
+
+void Plteen::HSL_to_RGB(const double* hue, const double* saturation, const double* lightness, double* R, double* G, double* B, size_t n) {
+    for (size_t idx = 0; idx < n; idx ++) {
+        hsl_to_rgb(hue[idx], saturation[idx], lightness[idx], R + idx, G + idx, B + idx);
+    }
+}
+
+void Plteen::HSI_to_RGB(const double* hue, const double* saturation, const double* intensity, double* R, double* G, double* B, size_t n) {
+    for (size_t idx = 0; idx < n; idx ++) {
+        hsi_to_rgb(hue[idx], saturation[idx], intensity[idx], R + idx, G + idx, B + idx);
+    }
+}
+
+void Plteen::RGB_to_HSV(const double* R, const double* G, const double* B, double* hue, double* saturation, double* brightness, size_t n) {
+    for (size_t idx = 0; idx < n; idx ++) {
+        rgb_to_hsv(R[idx], G[idx], B[idx], hue + idx, saturation + idx, brightness + idx);
+    }
+}
+
+/*************************************************************************************************/
+static inline uint32_t div255(uint32_t x) {
+    x += 128U;
+
+    return (x + (x >> 8U)) >> 8U;
+}
+
+static inline uint32_t pixel_premultiply(uint32_t px) {
+    uint32_t a = px & 0xFFU;
+    uint32_t r = div255((px >> 24U) * a);
+    uint32_t g = div255(((px >> 16U) & 0xFFU) * a);
+    uint32_t b = div255(((px >> 8U) & 0xFFU) * a);
+
+    return (r << 24U) | (g << 16U) | (b << 8U) | a;
+}
+
+static inline uint32_t pixel_blend(uint32_t dst, uint32_t src) {
+    uint32_t inv = 255U - (src & 0xFFU);
+    uint32_t px = 0U;
+
+    for (uint32_t shift = 0U; shift < 32U; shift += 8U) {
+        uint32_t c = ((src >> shift) & 0xFFU) + div255(((dst >> shift) & 0xFFU) * inv);
+
+        px |= ((c > 255U) ? 255U : c) << shift;
+    }
+
+    return px;
+}
+
+static inline uint32_t pixel_mix(uint32_t src1, uint32_t src2, uint32_t t) {
+    uint32_t px = 0U;
+
+    for (uint32_t shift = 0U; shift < 32U; shift += 8U) {
+        px |= div255(((src1 >> shift) & 0xFFU) * (255U - t) + ((src2 >> shift) & 0xFFU) * t) << shift;
+    }
+
+    return px;
+}
+
+#ifdef RGBA_SSE2_KERNELS
+/* 8 channels of 2 pixels in 16-bit lanes, the alpha goes to the first lane of each pixel in little-endian */
+static inline __m128i div255_sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static inline __m128i broadcast_alpha_sse2(__m128i x) {
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+static inline __m128i premultiply_sse2(__m128i x, __m128i alpha_lanes) {
+    __m128i product = div255_sse2(_mm_mullo_epi16(x, broadcast_alpha_sse2(x)));
+
+    return _mm_or_si128(_mm_andnot_si128(alpha_lanes, product), _mm_and_si128(alpha_lanes, x));
+}
+
+static inline __m128i blend_sse2(__m128i d, __m128i s) {
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), broadcast_alpha_sse2(s));
+
+    return _mm_add_epi16(s, div255_sse2(_mm_mullo_epi16(d, inv)));
+}
+
+static inline __m128i mix_sse2(__m128i s1, __m128i s2, __m128i t, __m128i inv) {
+    return div255_sse2(_mm_add_epi16(_mm_mullo_epi16(s1, inv), _mm_mullo_epi16(s2, t)));
+}
+#endif
+
+void Plteen::premultiply_pixels(uint32_t* pixels, size_t n) {
+    size_t idx = 0U;
+
+#ifdef RGBA_SSE2_KERNELS
+    __m128i zero = _mm_setzero_si128();
+    __m128i alpha_lanes = _mm_set_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + idx));
+        __m128i lo = premultiply_sse2(_mm_unpacklo_epi8(px, zero), alpha_lanes);
+        __m128i hi = premultiply_sse2(_mm_unpackhi_epi8(px, zero), alpha_lanes);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + idx), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; idx < n; idx ++) {
+        pixels[idx] = pixel_premultiply(pixels[idx]);
+    }
+}
+
+void Plteen::blend_pixels(uint32_t* dst, const uint32_t* src, size_t n) {
+    size_t idx = 0U;
+
+#ifdef RGBA_SSE2_KERNELS
+    __m128i zero = _mm_setzero_si128();
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + idx));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx));
+        __m128i lo = blend_sse2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+        __m128i hi = blend_sse2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; idx < n; idx ++) {
+        dst[idx] = pixel_blend(dst[idx], src[idx]);
+    }
+}
+
+void Plteen::mix_pixels(uint32_t* dst, const uint32_t* src1, const uint32_t* src2, uint8_t t, size_t n) {
+    size_t idx = 0U;
+
+#ifdef RGBA_SSE2_KERNELS
+    __m128i zero = _mm_setzero_si128();
+    __m128i vt = _mm_set1_epi16(short(t));
+    __m128i inv = _mm_set1_epi16(short(255 - t));
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + idx));
+        __m128i s2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + idx));
+        __m128i lo = mix_sse2(_mm_unpacklo_epi8(s1, zero), _mm_unpacklo_epi8(s2, zero), vt, inv);
+        __m128i hi = mix_sse2(_mm_unpackhi_epi8(s1, zero), _mm_unpackhi_epi8(s2, zero), vt, inv);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; idx < n; idx ++) {
+        dst[idx] = pixel_mix(src1[idx], src2[idx], t);
+    }
+}
@@ -108,4 +108,66 @@ namespace Plteen {
 
     /*********************************************************************************************/
     const Plteen::RGBA transparent;
+
+    /** NOTE
+     * A color packed as `0xRRGGBBAA`, the same layout as `RGBA::rgba()` and `SDL_PIXELFORMAT_RGBA8888`,
+     *   which is what the renderer wants in the end, so it goes to SDL without rounding doubles per call.
+     * Hex constants of `names.hpp` are opaque colors, and are packed at compile time.
+     * Converting to `RGBA` is lossless, converting from `RGBA` rounds the channels once.
+     */
+    class __lambda__ RGBA32 {
+    public:
+        static constexpr Plteen::RGBA32 from_rgba(uint32_t rgba) { return RGBA32(rgba >> 8U, uint8_t(rgba & 0xFFU)); }
+
+    public:
+        constexpr RGBA32() : value(0U) { /* transparent color */ }
+        constexpr RGBA32(uint32_t hex, uint8_t alpha = 0xFFU) : value(((hex & 0xFFFFFFU) << 8U) | alpha) {}
+        RGBA32(const Plteen::RGBA& c) : value(c.rgba()) {}
+
+        operator Plteen::RGBA() const { return Plteen::RGBA(this->R(), this->G(), this->B(), int(this->A())); }
+
+    public:
+        friend constexpr bool operator==(const RGBA32& lhs, const RGBA32& rhs) { return lhs.value == rhs.value; }
+        friend constexpr bool operator!=(const RGBA32& lhs, const RGBA32& rhs) { return lhs.value != rhs.value; }
+
+    public:
+        constexpr uint8_t R() const { return uint8_t(this->value >> 24U); }
+        constexpr uint8_t G() const { return uint8_t(this->value >> 16U); }
+        constexpr uint8_t B() const { return uint8_t(this->value >> 8U); }
+        constexpr uint8_t A() const { return uint8_t(this->value); }
+        constexpr uint32_t rgb() const { return this->value >> 8U; }
+        constexpr uint32_t rgba() const { return this->value; }
+
+        constexpr bool is_transparent() const { return this->A() == 0U; }
+        constexpr bool is_opacity() const { return !this->is_transparent(); }
+
+        void unbox(uint8_t* r = nullptr, uint8_t* g = nullptr, uint8_t* b = nullptr, uint8_t* a = nullptr) const {
+            if (r != nullptr) (*r) = this->R();
+            if (g != nullptr) (*g) = this->G();
+            if (b != nullptr) (*b) = this->B();
+            if (a != nullptr) (*a) = this->A();
+        }
+
+    private:
+        uint32_t value;
+    };
+
+    /** NOTE
+     * Batch variants of `RGBA::HSV/HSL/HSI` and `RGBA::hue/saturation/brightness`,
+     *   which convert `n` samples of SoA arrays at once, without making `RGBA`s.
+     */
+    __lambda__ void HSV_to_RGB(const double* hue, const double* saturation, const double* brightness, double* R, double* G, double* B, size_t n);
+    __lambda__ void HSL_to_RGB(const double* hue, const double* saturation, const double* lightness, double* R, double* G, double* B, size_t n);
+    __lambda__ void HSI_to_RGB(const double* hue, const double* saturation, const double* intensity, double* R, double* G, double* B, size_t n);
+    __lambda__ void RGB_to_HSV(const double* R, const double* G, const double* B, double* hue, double* saturation, double* brightness, size_t n);
+
+    /** NOTE
+     * Kernels for buffers of `RGBA32` pixels, which run on SSE2 where available.
+     * `blend_pixels` composes premultiplied `src` over `dst`,
+     *   `mix_pixels` interpolates `src1` and `src2` by `t`, 0 for `src1`, and 255 for `src2`, the result goes to `dst`.
+     * All of them divide by 255 with rounding, and produce identical results with or without SIMD.
+     */
+    __lambda__ void premultiply_pixels(uint32_t* pixels, size_t n);
+    __lambda__ void blend_pixels(uint32_t* dst, const uint32_t* src, size_t n);
+    __lambda__ void mix_pixels(uint32_t* dst, const uint32_t* src1, const uint32_t* src2, uint8_t t, size_t n);
 }
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "aabox.hpp"
+
+#include "../../datum/flonum.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace Plteen {
+    /** NOTE
+     * A uniform grid that buckets objects by the cells their bounding boxes cover.
+     *   Boxes that are not finite or that cover too many cells are kept in a separate list,
+     *   which is always visited by queries, so that huge backgrounds do not flood the grid.
+     *
+     * Queries report each object at most once, in no particular order,
+     *   and only guarantee that the reported boxes overlap (or contain) the target,
+     *   precise tests are left to the client.
+     */
+    template<typename T>
+    class __lambda__ SpatialGrid {
+    private:
+        struct Entry {
+            T* key;
+            Plteen::Box box;
+            int c0, r0, c1, r1;
+            bool oversized;
+            uint32_t mark;
+        };
+
+    public:
+        SpatialGrid(float cell_size = 64.0F, int max_span = 16) : cell_size(cell_size), max_span(max_span) {}
+        ~SpatialGrid() noexcept {}
+
+    public:
+        bool contains(T* key) const { return this->entries.find(key) != this->entries.end(); }
+        size_t size() const { return this->entries.size(); }
+
+        bool feed_box(T* key, Plteen::Box* box) const {
+            auto it = this->entries.find(key);
+            bool found = (it != this->entries.end());
+
+            if (found) {
+                (*box) = it->second.box;
+            }
+
+            return found;
+        }
+
+        void clear() {
+            this->entries.clear();
+            this->cells.clear();
+            this->oversized.clear();
+        }
+
+        void insert(T* key, const Plteen::Box& box) {
+            auto it = this->entries.find(key);
+
+            if (it == this->entries.end()) {
+                Entry* e = &this->entries[key];
+
+                e->key = key;
+                e->mark = 0U;
+                this->place(e, box);
+            } else {
+                this->update(key, box);
+            }
+        }
+
+        void update(T* key, const Plteen::Box& box) {
+            auto it = this->entries.find(key);
+
+            if (it != this->entries.end()) {
+                Entry* e = &it->second;
+
+                if (e->box != box) {
+                    int c0, r0, c1, r1;
+                    bool oversized = !this->cell_range(box, &c0, &r0, &c1, &r1);
+
+                    if ((oversized == e->oversized) && (oversized || ((c0 == e->c0) && (r0 == e->r0) && (c1 == e->c1) && (r1 == e->r1)))) {
+                        e->box = box;
+                    } else {
+                        this->displace(e);
+                        this->place(e, box);
+                    }
+                }
+            }
+        }
+
+        void remove(T* key) {
+            auto it = this->entries.find(key);
+
+            if (it != this->entries.end()) {
+                this->displace(&it->second);
+                this->entries.erase(it);
+            }
+        }
+
+    public:
+        void query(const Plteen::Dot& pt, std::vector<T*>& found) {
+            found.clear();
+
+            if (flisfinite(pt.x) && flisfinite(pt.y)) {
+                auto it = this->cells.find(this->cell_key(this->cell_index(pt.x), this->cell_index(pt.y)));
+
+                if (it != this->cells.end()) {
+                    for (Entry* e : it->second) {
+                        if (e->box.contain(pt)) {
+                            found.push_back(e->key);
+                        }
+                    }
+                }
+
+                for (Entry* e : this->oversized) {
+                    if (e->box.contain(pt)) {
+                        found.push_back(e->key);
+                    }
+                }
+            }
+        }
+
+        void query(const Plteen::Box& box, std::vector<T*>& found) {
+            int c0, r0, c1, r1;
+
+            found.clear();
+            this->next_mark();
+
+            if (this->cell_range(box, &c0, &r0, &c1, &r1)) {
+                for (int r = r0; r <= r1; r ++) {
+                    for (int c = c0; c <= c1; c ++) {
+                        auto it = this->cells.find(this->cell_key(c, r));
+
+                        if (it != this->cells.end()) {
+                            this->collect(it->second, box, found);
+                        }
+                    }
+                }
+            } else {
+                /* the target is huge itself, a plain scan is cheaper than walking the cells */
+                for (auto& kv : this->entries) {
+                    if ((kv.second.mark != this->mark) && kv.second.box.overlay(box)) {
+                        kv.second.mark = this->mark;
+                        found.push_back(kv.first);
+                    }
+                }
+            }
+
+            this->collect(this->oversized, box, found);
+        }
+
+    private:
+        int cell_index(float v) const {
+            return int(flfloor(v / this->cell_size));
+        }
+
+        int64_t cell_key(int c, int r) const {
+            return (int64_t(r) << 32) | int64_t(uint32_t(c));
+        }
+
+        bool cell_range(const Plteen::Box& box, int* c0, int* r0, int* c1, int* r1) const {
+            bool okay = false;
+
+            if (flisfinite(box.ltdot.x) && flisfinite(box.ltdot.y) && flisfinite(box.rbdot.x) && flisfinite(box.rbdot.y)
+                    && (box.ltdot.x <= box.rbdot.x) && (box.ltdot.y <= box.rbdot.y)) {
+                float xspan = (box.rbdot.x - box.ltdot.x) / this->cell_size;
+                float yspan = (box.rbdot.y - box.ltdot.y) / this->cell_size;
+
+                if ((xspan < float(this->max_span)) && (yspan < float(this->max_span))) {
+                    (*c0) = this->cell_index(box.ltdot.x);
+                    (*r0) = this->cell_index(box.ltdot.y);
+                    (*c1) = this->cell_index(box.rbdot.x);
+                    (*r1) = this->cell_index(box.rbdot.y);
+                    okay = true;
+                }
+            }
+
+            return okay;
+        }
+
+        void place(Entry* e, const Plteen::Box& box) {
+            e->box = box;
+            e->oversized = !this->cell_range(box, &e->c0, &e->r0, &e->c1, &e->r1);
+
+            if (e->oversized) {
+                this->oversized.push_back(e);
+            } else {
+                for (int r = e->r0; r <= e->r1; r ++) {
+                    for (int c = e->c0; c <= e->c1; c ++) {
+                        this->cells[this->cell_key(c, r)].push_back(e);
+                    }
+                }
+            }
+        }
+
+        void displace(Entry* e) {
+            if (e->oversized) {
+                unsafe_erase(this->oversized, e);
+            } else {
+                for (int r = e->r0; r <= e->r1; r ++) {
+                    for (int c = e->c0; c <= e->c1; c ++) {
+                        auto it = this->cells.find(this->cell_key(c, r));
+
+                        if (it != this->cells.end()) {
+                            unsafe_erase(it->second, e);
+
+                            if (it->second.empty()) {
+                                this->cells.erase(it);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        void collect(std::vector<Entry*>& bucket, const Plteen::Box& box, std::vector<T*>& found) {
+            for (Entry* e : bucket) {
+                if ((e->mark != this->mark) && e->box.overlay(box)) {
+                    e->mark = this->mark;
+                    found.push_back(e->key);
+                }
+            }
+        }
+
+        void next_mark() {
+            this->mark ++;
+
+            if (this->mark == 0U) { /* wrapped around, forget the stale marks */
+                for (auto& kv : this->entries) {
+                    kv.second.mark = 0U;
+                }
+
+                this->mark = 1U;
+            }
+        }
+
+    private:
+        static void unsafe_erase(std::vector<Entry*>& bucket, Entry* e) {
+            for (size_t idx = 0; idx < bucket.size(); idx ++) {
+                if (bucket[idx] == e) {
+                    bucket[idx] = bucket.back();
+                    bucket.pop_back();
+                    break;
+                }
+            }
+        }
+
+    private:
+        std::unordered_map<T*, Entry> entries;
+        std::unordered_map<int64_t, std::vector<Entry*>> cells;
+        std::vector<Entry*> oversized;
+        float cell_size;
+        int max_span;
+        uint32_t mark = 0U;
+    };
+}
@@ -4,8 +4,158 @@
 
 #include "../physics/mathematics.hpp"
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MOTION_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
 using namespace Plteen;
 
+/*************************************************************************************************/
+static inline void step_kinematics(double* vx, double ax, double tvx, float* x) {
+    if (ax != 0.0) (*vx) = vector_clamp((*vx) + ax, tvx);
+    if ((*vx) != 0.0) (*x) = float(double(*x) + (*vx));
+}
+
+static inline float border_distance(float x, float w, float dw) {
+    float dist = 0.0F;
+
+    if (x < 0.0F) {
+        dist = x;
+    } else if (x + w > dw) {
+        dist = x + w - dw;
+    }
+
+    return dist;
+}
+
+/**
+ * Both of the vectorized versions do exactly what the scalar `step_kinematics` does,
+ *   the rest that cannot fill a register is left to the scalar one.
+ *
+ * Kernels are chosen at runtime, so that the default build still takes the AVX path on machines that have it.
+ */
+#ifdef MOTION_SIMD_KERNELS
+static bool motion_avx_okay() {
+    static const bool okay = __builtin_cpu_supports("avx");
+
+    return okay;
+}
+
+static bool motion_sse2_okay() {
+    static const bool okay = __builtin_cpu_supports("sse2");
+
+    return okay;
+}
+
+__attribute__((target("avx")))
+static size_t step_kinematics_avx(double* vxs, const double* axs, const double* tvxs, float* xs, size_t n) {
+    __m256d zero = _mm256_setzero_pd();
+    size_t idx = 0U;
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m256d v = _mm256_loadu_pd(vxs + idx);
+        __m256d a = _mm256_loadu_pd(axs + idx);
+        __m256d tv = _mm256_loadu_pd(tvxs + idx);
+        __m256d nv = _mm256_min_pd(_mm256_max_pd(_mm256_add_pd(v, a), _mm256_sub_pd(zero, tv)), tv);
+
+        v = _mm256_blendv_pd(v, nv, _mm256_cmp_pd(a, zero, _CMP_NEQ_UQ));
+        _mm256_storeu_pd(vxs + idx, v);
+        _mm_storeu_ps(xs + idx, _mm256_cvtpd_ps(_mm256_add_pd(_mm256_cvtps_pd(_mm_loadu_ps(xs + idx)), v)));
+    }
+
+    return idx;
+}
+
+__attribute__((target("sse2")))
+static size_t step_kinematics_sse2(double* vxs, const double* axs, const double* tvxs, float* xs, size_t n) {
+    __m128d zero = _mm_setzero_pd();
+    size_t idx = 0U;
+
+    for (; idx + 2U <= n; idx += 2U) {
+        __m128d v = _mm_loadu_pd(vxs + idx);
+        __m128d a = _mm_loadu_pd(axs + idx);
+        __m128d tv = _mm_loadu_pd(tvxs + idx);
+        __m128d nv = _mm_min_pd(_mm_max_pd(_mm_add_pd(v, a), _mm_sub_pd(zero, tv)), tv);
+        __m128d accelerating = _mm_cmpneq_pd(a, zero);
+        __m128d x = _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(xs + idx))));
+
+        v = _mm_or_pd(_mm_and_pd(accelerating, nv), _mm_andnot_pd(accelerating, v));
+        _mm_storeu_pd(vxs + idx, v);
+        _mm_store_sd(reinterpret_cast<double*>(xs + idx), _mm_castps_pd(_mm_cvtpd_ps(_mm_add_pd(x, v))));
+    }
+
+    return idx;
+}
+
+__attribute__((target("avx")))
+static size_t border_distance_avx(const float* xs, const float* ws, float dw, float* dists, size_t n) {
+    __m256 zero = _mm256_setzero_ps();
+    __m256 border = _mm256_set1_ps(dw);
+    size_t idx = 0U;
+
+    for (; idx + 8U <= n; idx += 8U) {
+        __m256 x = _mm256_loadu_ps(xs + idx);
+        __m256 over = _mm256_sub_ps(_mm256_add_ps(x, _mm256_loadu_ps(ws + idx)), border);
+        __m256 dist = _mm256_and_ps(_mm256_cmp_ps(over, zero, _CMP_GT_OQ), over);
+
+        _mm256_storeu_ps(dists + idx, _mm256_blendv_ps(dist, x, _mm256_cmp_ps(x, zero, _CMP_LT_OQ)));
+    }
+
+    return idx;
+}
+
+__attribute__((target("sse2")))
+static size_t border_distance_sse2(const float* xs, const float* ws, float dw, float* dists, size_t n) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 border = _mm_set1_ps(dw);
+    size_t idx = 0U;
+
+    for (; idx + 4U <= n; idx += 4U) {
+        __m128 x = _mm_loadu_ps(xs + idx);
+        __m128 over = _mm_sub_ps(_mm_add_ps(x, _mm_loadu_ps(ws + idx)), border);
+        __m128 dist = _mm_and_ps(_mm_cmpgt_ps(over, zero), over);
+        __m128 outside = _mm_cmplt_ps(x, zero);
+
+        _mm_storeu_ps(dists + idx, _mm_or_ps(_mm_and_ps(outside, x), _mm_andnot_ps(outside, dist)));
+    }
+
+    return idx;
+}
+#endif
+
+static void step_kinematics_packed(double* vxs, const double* axs, const double* tvxs, float* xs, size_t n) {
+    size_t idx = 0U;
+
+#ifdef MOTION_SIMD_KERNELS
+    if (motion_avx_okay()) {
+        idx = step_kinematics_avx(vxs, axs, tvxs, xs, n);
+    } else if (motion_sse2_okay()) {
+        idx = step_kinematics_sse2(vxs, axs, tvxs, xs, n);
+    }
+#endif
+
+    for (; idx < n; idx ++) {
+        step_kinematics(vxs + idx, axs[idx], tvxs[idx], xs + idx);
+    }
+}
+
+static void border_distance_packed(const float* xs, const float* ws, float dw, float* dists, size_t n) {
+    size_t idx = 0U;
+
+#ifdef MOTION_SIMD_KERNELS
+    if (motion_avx_okay()) {
+        idx = border_distance_avx(xs, ws, dw, dists, n);
+    } else if (motion_sse2_okay()) {
+        idx = border_distance_sse2(xs, ws, dw, dists, n);
+    }
+#endif
+
+    for (; idx < n; idx ++) {
+        dists[idx] = border_distance(xs[idx], ws[idx], dw);
+    }
+}
+
 /*************************************************************************************************/
 Plteen::IMovable::IMovable() {
     this->set_border_strategy(BorderStrategy::IGNORE);
@@ -155,6 +305,8 @@ void Plteen::IMovable::set_terminal_speed(double mxspd, double myspd) {
 
     if (changed) {
         this->on_velocity_changed(false);
+    } else {
+        this->on_motion_changed();
     }
 }
 
@@ -240,6 +392,11 @@ void Plteen::IMovable::step(float* sx, float* sy) {
 void Plteen::IMovable::step(double* sx, double* sy) {
     if (this->ax != 0.0) this->vx = vector_clamp(this->vx + this->ax, this->tvx);
     if (this->ay != 0.0) this->vy = vector_clamp(this->vy + this->ay, this->tvy);
+
+    if ((this->ax != 0.0) || (this->ay != 0.0)) {
+        this->on_motion_changed();
+    }
+
     this->check_velocity_changing();
 
     if (this->vx != 0.0) (*sx) += this->vx;
@@ -286,6 +443,7 @@ void Plteen::IMovable::motion_stop(bool horizon, bool vertical) {
     if (horizon && vertical) {
         this->ar = flnan;
         // this->vr = flnan; // leaving it for heading
+        this->on_motion_changed();
         this->on_motion_stopped();
     } else {
         this->on_acceleration_changed();
@@ -296,11 +454,14 @@ void Plteen::IMovable::motion_stop(bool horizon, bool vertical) {
 /*************************************************************************************************/
 void Plteen::IMovable::on_acceleration_changed() {
     this->ar = flatan(this->ay, this->ax);
+    this->on_motion_changed();
 }
 
 void Plteen::IMovable::on_velocity_changed(bool always_trigger_heading_event) {
     double rad = flatan(this->vy, this->vx);
 
+    // the owner should know it before heading events
+    this->on_motion_changed();
     this->check_heading_changing(rad, always_trigger_heading_event);
 }
 
@@ -322,3 +483,35 @@ void Plteen::IMovable::check_heading_changing(double rad, bool always_trigger_ev
         this->on_heading_changed(this->vr, this->vx, this->vy, this->vr);
     }
 }
+
+/*************************************************************************************************/
+void Plteen::MotionBatch::clear() {
+    this->oxs.clear();
+    this->oys.clear();
+    this->hdists.clear();
+    this->vdists.clear();
+}
+
+void Plteen::MotionBatch::integrate(double* vxs, double* vys, const double* axs, const double* ays, const double* tvxs, const double* tvys,
+        float* xs, float* ys, const float* widths, const float* heights, size_t n, float border_width, float border_height) {
+    size_t base = this->oxs.size();
+
+    this->oxs.insert(this->oxs.end(), xs, xs + n);
+    this->oys.insert(this->oys.end(), ys, ys + n);
+    this->hdists.resize(base + n);
+    this->vdists.resize(base + n);
+
+    step_kinematics_packed(vxs, axs, tvxs, xs, n);
+    step_kinematics_packed(vys, ays, tvys, ys, n);
+    border_distance_packed(xs, widths, border_width, this->hdists.data() + base, n);
+    border_distance_packed(ys, heights, border_height, this->vdists.data() + base, n);
+}
+
+void Plteen::MotionBatch::write_back(IMovable* mover, double vx, double vy) {
+    mover->vx = vx;
+    mover->vy = vy;
+}
+
+void Plteen::MotionBatch::commit(IMovable* mover) {
+    mover->check_velocity_changing();
+}
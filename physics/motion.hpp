@@ -2,7 +2,12 @@
 
 #include "../forward.hpp"
 
+#include <vector>
+#include <cstdint>
+
 namespace Plteen {
+    class MotionBatch;
+
     class __lambda__ IMovable {
     public:
         IMovable();
@@ -40,6 +45,8 @@ namespace Plteen {
     public:
         void set_terminal_velocity(double max_spd, double direction, bool is_radian = false);
         void set_terminal_speed(double mxspd, double myspd);
+        double x_terminal_speed() { return this->tvx; }
+        double y_terminal_speed() { return this->tvy; }
         double get_heading(bool need_radian = true) { return this->get_velocity_direction(need_radian); }
         void set_heading(double dx, double dy);
         void set_heading(double direction, bool is_radian = false);
@@ -67,12 +74,19 @@ namespace Plteen {
         virtual void on_heading_changed(double theta_rad, double vx, double vy, double prev_vr) {}
         virtual void on_motion_stopped() {}
 
+    private:
+        /* for the owner who keeps a copy of velocities and accelerations, fired whenever any of them changes */
+        virtual void on_motion_changed() {}
+
     private:
         void on_acceleration_changed();
         void check_velocity_changing();
         void check_heading_changing(double rad, bool always_trigger_event);
         void on_velocity_changed(bool always_trigger_heading_event);
 
+    private:
+        friend class Plteen::MotionBatch;
+
     private:
         Plteen::BorderStrategy border_strategies[4];
         bool bounce_acc = false;
@@ -85,4 +99,43 @@ namespace Plteen {
         double tvx;
         double tvy;
     };
+
+    /*********************************************************************************************/
+    /** NOTE
+     * Steps lots of movers together in place over the packed arrays of the client,
+     *   which is equivalent to `IMovable::step` followed by the border checking,
+     *   entries that neither move nor accelerate are left as they are.
+     *
+     * The client may integrate several runs of its arrays in one round,
+     *   the results are appended in order until `clear`.
+     *
+     * Events are left to the client:
+     *   `write_back` hands the stepped velocities over to movers silently,
+     *   `commit` fires heading events if the headings do change,
+     *   and the movers with non-zero offsets need to be passed to `IMovable::on_border`.
+     */
+    class __lambda__ MotionBatch {
+    public:
+        MotionBatch() {}
+
+    public:
+        void clear();
+        void integrate(double* vxs, double* vys, const double* axs, const double* ays, const double* tvxs, const double* tvys,
+            float* xs, float* ys, const float* widths, const float* heights, size_t n, float border_width, float border_height);
+        void write_back(Plteen::IMovable* mover, double vx, double vy);
+        void commit(Plteen::IMovable* mover);
+
+    public:
+        size_t size() const { return this->oxs.size(); }
+        float ox(size_t idx) const { return this->oxs[idx]; }
+        float oy(size_t idx) const { return this->oys[idx]; }
+        float hoffset(size_t idx) const { return this->hdists[idx]; }
+        float voffset(size_t idx) const { return this->vdists[idx]; }
+
+    private:
+        std::vector<float> oxs; // before stepping
+        std::vector<float> oys; // before stepping
+        std::vector<float> hdists;
+        std::vector<float> vdists;
+    };
 }
@@ -18,8 +18,12 @@
 #include "datum/fixnum.hpp"
 #include "datum/box.hpp"
 #include "datum/time.hpp"
+#include "datum/wheel.hpp"
 
 #include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
 
 using namespace Plteen;
 
@@ -112,12 +116,228 @@ namespace Plteen {
         };
     };
 
+    /** NOTE
+     * The hot states of matters are stored column by column and addressed by slots,
+     *   so that `on_elapse` walks through contiguous arrays instead of chasing scattered `MatterInfo`s,
+     *   and only visits the slots listed as awake or moving, idle matters cost nothing per round.
+     *
+     * Slots are kept in the z-order (bottom first) as `on_elapse` always does,
+     *   removed slots are left as holes, and both are fixed lazily once `disordered`.
+     */
+    struct MatterStates {
+        size_t size() const { return this->owners.size(); }
+
+        size_t allocate(IMatter* m) {
+            this->owners.push_back(m);
+            this->x.push_back(0.0F);
+            this->y.push_back(0.0F);
+            this->width.push_back(0.0F);
+            this->height.push_back(0.0F);
+            this->px.push_back(0.0F);
+            this->py.push_back(0.0F);
+            this->vx.push_back(0.0);
+            this->vy.push_back(0.0);
+            this->ax.push_back(0.0);
+            this->ay.push_back(0.0);
+            this->tvx.push_back(0.0);
+            this->tvy.push_back(0.0);
+            this->local_frame_delta.push_back(0U);
+            this->local_frame_count.push_back(0U);
+            this->timeline_origin.push_back(0U);
+            this->due.push_back(0U);
+            this->duration.push_back(0);
+            this->awake.push_back(0U);
+            this->mover.push_back(0U);
+            this->gliding.push_back(0U);
+            this->gliding_tx.push_back(0.0F);
+            this->gliding_ty.push_back(0.0F);
+            this->current_step.push_back(1.0);
+            this->progress_total.push_back(1.0);
+
+            return this->owners.size() - 1U;
+        }
+
+        size_t transfer(size_t idx, MatterStates* target) {
+            target->owners.push_back(this->owners[idx]);
+            target->x.push_back(this->x[idx]);
+            target->y.push_back(this->y[idx]);
+            target->width.push_back(this->width[idx]);
+            target->height.push_back(this->height[idx]);
+            target->px.push_back(this->px[idx]);
+            target->py.push_back(this->py[idx]);
+            target->vx.push_back(this->vx[idx]);
+            target->vy.push_back(this->vy[idx]);
+            target->ax.push_back(this->ax[idx]);
+            target->ay.push_back(this->ay[idx]);
+            target->tvx.push_back(this->tvx[idx]);
+            target->tvy.push_back(this->tvy[idx]);
+            target->local_frame_delta.push_back(this->local_frame_delta[idx]);
+            target->local_frame_count.push_back(this->local_frame_count[idx]);
+            target->timeline_origin.push_back(this->timeline_origin[idx]);
+            target->due.push_back(this->due[idx]);
+            target->duration.push_back(this->duration[idx]);
+            target->awake.push_back(this->awake[idx]);
+            target->mover.push_back(this->mover[idx]);
+            target->gliding.push_back(this->gliding[idx]);
+            target->gliding_tx.push_back(this->gliding_tx[idx]);
+            target->gliding_ty.push_back(this->gliding_ty[idx]);
+            target->current_step.push_back(this->current_step[idx]);
+            target->progress_total.push_back(this->progress_total[idx]);
+
+            if (this->awake[idx] != 0U) {
+                target->awake_slots.push_back(target->owners.size() - 1U);
+            }
+
+            if (this->mover[idx] != 0U) {
+                target->mover_slots.push_back(target->owners.size() - 1U);
+            }
+
+            return target->owners.size() - 1U;
+        }
+
+        void swap(MatterStates& other) {
+            this->owners.swap(other.owners);
+            this->x.swap(other.x);
+            this->y.swap(other.y);
+            this->width.swap(other.width);
+            this->height.swap(other.height);
+            this->px.swap(other.px);
+            this->py.swap(other.py);
+            this->vx.swap(other.vx);
+            this->vy.swap(other.vy);
+            this->ax.swap(other.ax);
+            this->ay.swap(other.ay);
+            this->tvx.swap(other.tvx);
+            this->tvy.swap(other.tvy);
+            this->local_frame_delta.swap(other.local_frame_delta);
+            this->local_frame_count.swap(other.local_frame_count);
+            this->timeline_origin.swap(other.timeline_origin);
+            this->due.swap(other.due);
+            this->duration.swap(other.duration);
+            this->awake.swap(other.awake);
+            this->mover.swap(other.mover);
+            this->awake_slots.swap(other.awake_slots);
+            this->mover_slots.swap(other.mover_slots);
+            this->gliding.swap(other.gliding);
+            this->gliding_tx.swap(other.gliding_tx);
+            this->gliding_ty.swap(other.gliding_ty);
+            this->current_step.swap(other.current_step);
+            this->progress_total.swap(other.progress_total);
+        }
+
+        void clear() {
+            MatterStates empty;
+
+            this->swap(empty);
+            this->disordered = false;
+        }
+
+        std::vector<IMatter*> owners; // `nullptr` for holes
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> width;  // as indexed
+        std::vector<float> height; // as indexed
+        std::vector<float> px;     // before the latest step
+        std::vector<float> py;     // before the latest step
+
+        // for free motions, copied from `IMovable`s whenever they change,
+        //   gliding matters are stepped on their own and keep zeros here
+        std::vector<double> vx;
+        std::vector<double> vy;
+        std::vector<double> ax;
+        std::vector<double> ay;
+        std::vector<double> tvx;
+        std::vector<double> tvy;
+        
+        // for animation
+        std::vector<uint32_t> local_frame_delta;
+        std::vector<uint32_t> local_frame_count;
+        std::vector<uint64_t> timeline_origin; // uptime of the last update
+        std::vector<uint8_t> due;              // set by the scheduler
+        std::vector<int> duration;
+
+        // for the work of each round, flags tell whether slots are already in the lists,
+        //   which are pruned lazily when visited
+        std::vector<uint8_t> awake;       // updated every frame, due, or gliding
+        std::vector<uint8_t> mover;       // moving freely
+        std::vector<size_t> awake_slots;
+        std::vector<size_t> mover_slots;
+
+        // for queued motions
+        std::vector<uint8_t> gliding;
+        std::vector<float> gliding_tx;
+        std::vector<float> gliding_ty;
+
+        // gliding progressbar
+        std::vector<double> current_step;
+        std::vector<double> progress_total;
+
+        bool disordered = false;
+    };
+
+    /*********************************************************************************************/
+    enum class ScheduleType { Timeline, Bubble, Callback };
+
+    struct PlaneSchedule {
+        IMatter* target; // `nullptr` for callbacks
+        uint64_t ticket;
+        ScheduleType type;
+    };
+
+    struct ScheduledCallback {
+        uint64_t due;
+        std::function<void()> proc;
+    };
+
+    /** NOTE
+     * All time-driven things of a plane are queued in a timing wheel by their due times (uptime in milliseconds),
+     *   so that a tick only touches the ones that are due, instead of asking every matter.
+     *
+     * Entries in the wheel cannot be cancelled, instead, each of them carries a ticket,
+     *   and the stale ones are told by comparing tickets when they are fired.
+     */
+    struct PlaneScheduler {
+        PlaneScheduler(uint64_t now) : wheel(now), uptime(now) {}
+
+        Plteen::TimingWheel<PlaneSchedule> wheel;
+        std::vector<PlaneSchedule> fired;
+        std::unordered_map<uint64_t, ScheduledCallback> callbacks;
+        uint64_t ticket = 0U;
+        uint64_t uptime;
+        uint64_t round = 0U; // counted by `on_elapse`
+    };
+
     struct MatterInfo : public Plteen::IMatterInfo {
-        MatterInfo(Plteen::IPlane* master) : IMatterInfo(master) {}
+        MatterInfo(Plteen::IPlane* master, MatterStates* states, IMatter* self)
+            : IMatterInfo(master), states(states), slot(states->allocate(self)) {}
         virtual ~MatterInfo() noexcept;
 
-        float x = 0.0F;
-        float y = 0.0F;
+        // the hot states, see `MatterStates`
+        float& x() { return this->states->x[this->slot]; }
+        float& y() { return this->states->y[this->slot]; }
+        float& width() { return this->states->width[this->slot]; }
+        float& height() { return this->states->height[this->slot]; }
+        float& px() { return this->states->px[this->slot]; }
+        float& py() { return this->states->py[this->slot]; }
+        double& vx() { return this->states->vx[this->slot]; }
+        double& vy() { return this->states->vy[this->slot]; }
+        double& ax() { return this->states->ax[this->slot]; }
+        double& ay() { return this->states->ay[this->slot]; }
+        double& tvx() { return this->states->tvx[this->slot]; }
+        double& tvy() { return this->states->tvy[this->slot]; }
+        uint32_t& local_frame_delta() { return this->states->local_frame_delta[this->slot]; }
+        uint32_t& local_frame_count() { return this->states->local_frame_count[this->slot]; }
+        uint64_t& timeline_origin() { return this->states->timeline_origin[this->slot]; }
+        int& duration() { return this->states->duration[this->slot]; }
+        uint8_t& gliding() { return this->states->gliding[this->slot]; }
+        float& gliding_tx() { return this->states->gliding_tx[this->slot]; }
+        float& gliding_ty() { return this->states->gliding_ty[this->slot]; }
+        double& current_step() { return this->states->current_step[this->slot]; }
+        double& progress_total() { return this->states->progress_total[this->slot]; }
+
+        MatterStates* states;
+        size_t slot;
+        bool detached = false; // removed from the plane but not deleted
 
         // for mouse selection
         bool selected = false;
@@ -126,18 +346,13 @@ namespace Plteen {
         // for speech bubble
         IMatter* bubble = nullptr;
         SpeechBubble bubble_type = SpeechBubble::Default;
-        long long bubble_expiration_time = 0;
-        
-        // for animation
-        uint32_t local_frame_delta = 0U;
-        uint32_t local_frame_count = 0U;
-        uint32_t local_elapse = 0U;
-        int duration = 0;
+        uint64_t bubble_expiration_time = 0U;
+        uint64_t bubble_ticket = 0U;
 
+        // for timeline
+        uint64_t timeline_ticket = 0U;
+        
         // for queued motions
-        bool gliding = false;
-        float gliding_tx = 0.0F;
-        float gliding_ty = 0.0F;
         std::deque<MotionAction> motion_actions;
 
         // for track
@@ -148,13 +363,23 @@ namespace Plteen {
         RGBA draw_color = 0x0U;
         uint8_t draw_width = 1U;
 
-        // gliding progressbar
-        double current_step = 1.0;
-        double progress_total = 1.0;
-
         // as linked list
         IMatter* next = nullptr;
         IMatter* prev = nullptr;
+
+        // for spatial queries, larger is closer to the top
+        uint32_t zorder = 0U;
+
+        // for the static layer
+        bool is_static = false;
+        bool in_static_layer = false;
+        uint64_t indexed_round = 0U; // idle since then
+
+        // for broad-phase collision, `0` means not participating
+        uint32_t collision_layer = 0U;
+        uint32_t collision_mask = 0xFFFFFFFFU;
+        uint64_t collision_ticket = 0U; // the order of joining
+        Box collision_box;
     };
 
     class SpeechInfo : public Plteen::IMatterInfo {
@@ -184,6 +409,10 @@ namespace Plteen {
     };
 
     Plteen::MatterInfo::~MatterInfo() noexcept {
+        if (this->detached) {
+            delete this->states;
+        }
+
         if (this->bubble != nullptr) {
             auto speech_info = dynamic_cast<SpeechInfo*>(this->bubble->info);
 
@@ -213,8 +442,76 @@ static inline void unsafe_set_local_fps(int fps, bool restart, uint32_t& frame_d
     }
 }
 
-static inline void unsafe_set_matter_fps(MatterInfo* info, int fps, bool restart) {
-    unsafe_set_local_fps(fps, restart, info->local_frame_delta, info->local_frame_count, info->local_elapse);
+static inline void unsafe_set_matter_fps(MatterInfo* info, int fps, bool restart, uint64_t now) {
+    info->local_frame_delta() = (fps > 0) ? (1000U / fps) : 0U;
+
+    if (restart) {
+        info->local_frame_count() = 0U;
+        info->timeline_origin() = now;
+    }
+}
+
+static inline void unsafe_wake_slot(MatterStates* states, size_t idx) {
+    if (states->awake[idx] == 0U) {
+        states->awake[idx] = 1U;
+        states->awake_slots.push_back(idx);
+    }
+}
+
+/** NOTE
+ * Matters that have their own timelines are updated only when the scheduler says they are due,
+ *   the others are updated every frame and therefore kept awake.
+ */
+static inline void unsafe_schedule_timeline(PlaneScheduler* scheduler, IMatter* m, MatterInfo* info) {
+    uint32_t threshold = (info->duration() > 0) ? uint32_t(info->duration()) : info->local_frame_delta();
+
+    info->timeline_ticket = ++ scheduler->ticket;
+
+    if (threshold > 0U) {
+        scheduler->wheel.insert(info->timeline_origin() + threshold, { m, info->timeline_ticket, ScheduleType::Timeline });
+    } else {
+        unsafe_wake_slot(info->states, info->slot);
+    }
+}
+
+static inline bool unsafe_slot_moving(MatterStates* states, size_t idx) {
+    return (states->vx[idx] != 0.0) || (states->vy[idx] != 0.0) || (states->ax[idx] != 0.0) || (states->ay[idx] != 0.0);
+}
+
+static inline bool unsafe_matter_awake(MatterInfo* info) {
+    return ((info->local_frame_delta() == 0U) && (info->duration() <= 0))
+            || (info->gliding() != 0U) || !info->motion_actions.empty();
+}
+
+static inline void unsafe_sync_motion(IMatter* m, MatterInfo* info) {
+    if (info->gliding()) {
+        info->vx() = 0.0;
+        info->vy() = 0.0;
+        info->ax() = 0.0;
+        info->ay() = 0.0;
+    } else {
+        info->vx() = m->x_speed();
+        info->vy() = m->y_speed();
+        info->ax() = m->x_delta_speed();
+        info->ay() = m->y_delta_speed();
+    }
+
+    info->tvx() = m->x_terminal_speed();
+    info->tvy() = m->y_terminal_speed();
+
+    if (unsafe_slot_moving(info->states, info->slot) && (info->states->mover[info->slot] == 0U)) {
+        info->states->mover[info->slot] = 1U;
+        info->states->mover_slots.push_back(info->slot);
+    }
+}
+
+static inline void unsafe_set_gliding(IMatter* m, MatterInfo* info, bool yes) {
+    info->gliding() = yes;
+    unsafe_sync_motion(m, info);
+
+    if (yes) {
+        unsafe_wake_slot(info->states, info->slot);
+    }
 }
 
 static uint32_t local_timeline_elapse(uint32_t global_interval, uint32_t local_frame_delta, uint32_t& local_elapse, int duration) {
@@ -264,7 +561,7 @@ static void unsafe_canvas_info_do_setting(IPlane* self, IMatter* m, MatterInfo*
 }
 
 static void unsafe_do_canvas_setting(Plane* self, IMatter* m, MatterInfo* info, const MotionAction& op) {
-    if (info->gliding) {
+    if (info->gliding()) {
         info->motion_actions.push_back(op);
     } else {
         unsafe_canvas_info_do_setting(self, m, info, op);
@@ -286,21 +583,27 @@ static void unsafe_canvas_do_drawing(IMatter* m, MatterInfo* info, float x1, flo
 }
 
 static inline void unsafe_location_changed(IMatter* m, MatterInfo* info, float ox, float oy, bool ignore_track) {
-    m->on_location_changed(info->x, info->y, ox, oy);
+    m->on_location_changed(info->x(), info->y(), ox, oy);
 
     if ((info->canvas != nullptr) && (!ignore_track)) {
         if (info->shared_canvas) {
             unsafe_canvas_sync_settings(info);
         }
 
-        unsafe_canvas_do_drawing(m, info, ox, oy, info->x, info->y);
+        unsafe_canvas_do_drawing(m, info, ox, oy, info->x(), info->y());
+    }
+}
+
+static inline void unsafe_earlier_wakeup(uint64_t* wakeup, uint64_t time) {
+    if ((time > 0U) && (((*wakeup) == 0U) || (time < (*wakeup)))) {
+        (*wakeup) = time;
     }
 }
 
-static inline MatterInfo* bind_matter_ownership(IPlane* master, IMatter* m) {
-    auto info = new MatterInfo(master);
+static inline MatterInfo* bind_matter_ownership(IPlane* master, MatterStates* states, IMatter* m) {
+    auto info = new MatterInfo(master, states, m);
     
-    unsafe_set_matter_fps(info, m->preferred_local_fps(), true);
+    unsafe_set_matter_fps(info, m->preferred_local_fps(), true, 0U);
     m->info = info;
 
     return info;
@@ -327,11 +630,13 @@ static inline MatterInfo* plane_matter_info(IPlane* master, IMatter* m) {
     return info;
 }
 
-static inline void bubble_start(ISprite* m, MatterInfo* info, double sec, SpeechBubble type, double default_duration) {
+static inline void bubble_start(PlaneScheduler* scheduler, ISprite* m, MatterInfo* info, double sec, SpeechBubble type, double default_duration) {
     double duration = (sec > 0.0) ? sec : default_duration;
 
     info->bubble_type = type;            
-    info->bubble_expiration_time = current_milliseconds() + fl2fx<long long>(duration * 1000.0);
+    info->bubble_expiration_time = scheduler->uptime + fl2fx<uint64_t>(duration * 1000.0);
+    info->bubble_ticket = ++ scheduler->ticket;
+    scheduler->wheel.insert(info->bubble_expiration_time, { m, info->bubble_ticket, ScheduleType::Bubble });
 
     if (type == SpeechBubble::Default) {
         m->play_speaking(1);
@@ -341,14 +646,14 @@ static inline void bubble_start(ISprite* m, MatterInfo* info, double sec, Speech
 }
 
 static inline void bubble_expire(IMatter* m, MatterInfo* info) {
-    info->bubble_expiration_time = 0LL;
+    info->bubble_expiration_time = 0U;
 }
 
 static inline bool is_matter_bubble_showing(IMatter* m, MatterInfo* info) {
     bool yes = false;
 
     if (info->bubble != nullptr) {
-        if (info->bubble_expiration_time > 0LL) {
+        if (info->bubble_expiration_time > 0U) {
             yes = true;
         }
     }
@@ -357,7 +662,49 @@ static inline bool is_matter_bubble_showing(IMatter* m, MatterInfo* info) {
 }
 
 static inline Box unsafe_get_matter_bound(IMatter* m, MatterInfo* info) {
-    return m->get_bounding_box() + Dot(info->x, info->y);
+    return m->get_bounding_box() + Dot(info->x(), info->y());
+}
+
+static inline void unsafe_set_clipping_region(dc_t* dc, SDL_Rect* clip, const SDL_Rect* region) {
+    if (region != nullptr) {
+        SDL_Rect self = (*clip);
+
+        if (!SDL_IntersectRect(&self, region, clip)) {
+            clip->w = 0;
+            clip->h = 0;
+        }
+    }
+
+    dc->set_clipping_region(clip);
+}
+
+static inline void unsafe_clear_clipping_region(dc_t* dc, SDL_Rect* region) {
+    if (region != nullptr) {
+        dc->set_clipping_region(region);
+    } else {
+        dc->clear_clipping_region();
+    }
+}
+
+static inline void unsafe_sort_by_zorder(std::vector<IMatter*>& matters) {
+    std::sort(matters.begin(), matters.end(), [](IMatter* lhs, IMatter* rhs) {
+        return MATTER_INFO(lhs)->zorder > MATTER_INFO(rhs)->zorder;
+    });
+}
+
+static inline void unsafe_forget_matter(std::vector<IMatter*>& matters, IMatter* m) {
+    auto it = std::find(matters.begin(), matters.end(), m);
+
+    if (it != matters.end()) {
+        matters.erase(it);
+    }
+}
+
+static inline bool unsafe_collision_pair_less(const std::pair<IMatter*, IMatter*>& lhs, const std::pair<IMatter*, IMatter*>& rhs) {
+    uint64_t lfirst = MATTER_INFO(lhs.first)->collision_ticket;
+    uint64_t rfirst = MATTER_INFO(rhs.first)->collision_ticket;
+
+    return (lfirst < rfirst) || ((lfirst == rfirst) && (MATTER_INFO(lhs.second)->collision_ticket < MATTER_INFO(rhs.second)->collision_ticket));
 }
 
 static inline void unsafe_add_selected(Plteen::IPlane* master, IMatter* m, MatterInfo* info, bool selected) {
@@ -395,12 +742,17 @@ static IMatter* do_search_selected_matter(IMatter* start, IMatter* terminator) {
 /*************************************************************************************************/
 Plane::Plane(const std::string& name) : Plane(name.c_str()) {}
 Plane::Plane(const char* name) : IPlane(name), head_matter(nullptr) {
+    this->states = new MatterStates();
+    this->scheduler = new PlaneScheduler(SDL_GetTicks64());
     this->bubble_font = GameFont::Tooltip(FontSize::medium);
     this->set_bubble_duration();
 }
 
 Plane::~Plane() {
     this->erase();
+    this->static_layer.reset();
+    delete this->states;
+    delete this->scheduler;
 }
 
 void Plteen::Plane::notify_matter_ready(IMatter* m) {
@@ -408,6 +760,7 @@ void Plteen::Plane::notify_matter_ready(IMatter* m) {
 
     if (info != nullptr) {
         this->size_cache_invalid();
+        this->update_matter_index(m, info);
         this->begin_update_sequence();
         this->notify_updated();
         this->on_matter_ready(m);
@@ -439,6 +792,9 @@ void Plteen::Plane::bring_to_front(IMatter* m, IMatter* target) {
                 this->head_matter = sinfo->next;
             }
             
+            this->zorder_invalid = true;
+            this->static_layer_dirty = true;
+            this->states->disordered = true;
             this->notify_updated();
         }
     }
@@ -484,6 +840,9 @@ void Plteen::Plane::send_to_back(IMatter* m, IMatter* target) {
                 this->head_matter = m;
             }
 
+            this->zorder_invalid = true;
+            this->static_layer_dirty = true;
+            this->states->disordered = true;
             this->notify_updated();
         }
     }
@@ -506,7 +865,7 @@ void Plteen::Plane::send_backward(IMatter* m, int n) {
 
 void Plteen::Plane::insert_at(IMatter* m, const Position& pos, const Port& p, const Vector& vec) {
     if (m->info == nullptr) {
-        MatterInfo* info = bind_matter_ownership(this, m);
+        MatterInfo* info = bind_matter_ownership(this, this->states, m);
         
         if (this->head_matter == nullptr) {
             this->head_matter = m;
@@ -522,7 +881,12 @@ void Plteen::Plane::insert_at(IMatter* m, const Position& pos, const Port& p, co
             head_info->prev = m;
         }
 
+        info->zorder = ++ this->zorder_top;
+        info->timeline_origin() = this->scheduler->uptime;
+        unsafe_schedule_timeline(this->scheduler, m, info);
         this->handle_new_matter(m, info, pos, p, vec.x, vec.y);
+        this->update_matter_index(m, info);
+        unsafe_sync_motion(m, info);
     }
 }
 
@@ -561,28 +925,83 @@ void Plteen::Plane::handle_new_matter(IMatter* m, SpeechInfo* info) {
 void Plteen::Plane::remove(IMatter* m, bool needs_delete) {
     MatterInfo* info = plane_matter_info(this, m);
 
-    if (info != nullptr) {
-        MATTER_INFO(info->prev)->next = info->next;
-        MATTER_INFO(info->next)->prev = info->prev;
+    if ((info != nullptr) && info->detached) {
+        /* it has been removed already, and is no longer linked */
+        if (needs_delete) {
+            this->delete_matter(m);
+        }
+    } else if ((info != nullptr) && this->collision_dispatching) {
+        /* the matter might still be referenced by the collisions being dispatched */
+        auto it = std::find_if(this->collision_removals.begin(), this->collision_removals.end(),
+            [m](const std::pair<IMatter*, bool>& removal) { return removal.first == m; });
 
-        if (this->head_matter == m) {
-            if (this->head_matter == info->next) {
-                this->head_matter = nullptr;
-            } else {
-                this->head_matter = info->next;
-            }
+        if (it == this->collision_removals.end()) {
+            this->collision_removals.push_back({ m, needs_delete });
+        } else {
+            it->second = it->second || needs_delete;
         }
+    } else if (info != nullptr) {
+        uint64_t generation = this->erase_generation;
+
+        if (info->collision_layer != 0U) {
+            /* collisions end while the matter is still in the plane, other matters removed meanwhile go after it */
+            this->collision_dispatching = true;
+            this->forget_collisions(m);
+            this->collision_dispatching = false;
 
-        if (this->hovering_matter == m) {
-            this->hovering_matter = nullptr;
+            for (auto it = this->collision_removals.begin(); it != this->collision_removals.end(); ++ it) {
+                if (it->first == m) {
+                    needs_delete = needs_delete || it->second;
+                    this->collision_removals.erase(it);
+                    break;
+                }
+            }
         }
+
+        /* the matter has gone with the plane if the plane is erased in its collision events */
+        if (generation == this->erase_generation) {
+            MATTER_INFO(info->prev)->next = info->next;
+            MATTER_INFO(info->next)->prev = info->prev;
+
+            if (this->head_matter == m) {
+                if (this->head_matter == info->next) {
+                    this->head_matter = nullptr;
+                } else {
+                    this->head_matter = info->next;
+                }
+            }
+
+            if (this->hovering_matter == m) {
+                this->hovering_matter = nullptr;
+            }
+
+            this->spatial_index.remove(m);
+            unsafe_forget_matter(this->selection_hits, m);
+
+            if (info->in_static_layer) {
+                this->static_layer_dirty = true;
+            }
+
+            this->states->owners[info->slot] = nullptr;
+            this->states->disordered = true;
+
+            if (!needs_delete) {
+                // the matter might still be asked for its location
+                MatterStates* own = new MatterStates();
+
+                info->slot = this->states->transfer(info->slot, own);
+                info->states = own;
+                info->detached = true;
+            }
         
-        if (needs_delete) {
-            this->delete_matter(m);
-        }
+            if (needs_delete) {
+                this->delete_matter(m);
+            }
 
-        this->notify_updated();
-        this->size_cache_invalid();
+            this->notify_updated();
+            this->size_cache_invalid();
+            this->remove_collided_matters();
+        }
     }
 }
 
@@ -595,6 +1014,16 @@ void Plteen::Plane::erase() {
 
         this->head_matter = nullptr;
         prev_info->next = nullptr;
+        this->spatial_index.clear();
+        this->selection_hits.clear();
+        this->zorder_top = 0U;
+        this->zorder_invalid = false;
+        this->collision_sweep.clear();
+        this->colliding_pairs.clear();
+        this->collision_removals.clear();
+        this->erase_generation ++;
+        this->static_layer_size = 0U;
+        this->static_layer_dirty = true;
 
         do {
             IMatter* child = temp_head;
@@ -603,6 +1032,9 @@ void Plteen::Plane::erase() {
             this->delete_matter(child);
         } while (temp_head != nullptr);
 
+        // matters might still ask for their states while being deleted
+        this->states->clear();
+
         this->size_cache_invalid();
     }
 
@@ -619,7 +1051,7 @@ void Plteen::Plane::move(IMatter* m, double length, bool ignore_gliding) {
 
         if (info != nullptr) {
             if (this->move_matter_via_info(m, info, length, ignore_gliding, false)) {
-                this->notify_updated();
+                this->notify_updated(m);
             }
         }
     } else if (this->head_matter != nullptr) {
@@ -645,7 +1077,7 @@ void Plteen::Plane::move(IMatter* m, const Vector& vec, bool ignore_gliding) {
 
         if (info != nullptr) {
             if (this->move_matter_via_info(m, info, vec, false, ignore_gliding, false)) {
-                this->notify_updated();
+                this->notify_updated(m);
             }
         }
     } else if (this->head_matter != nullptr) {
@@ -670,7 +1102,7 @@ void Plteen::Plane::move_to(IMatter* m, const Position& pos, const Port& p, cons
     
     if (info != nullptr) {
         if (this->move_matter_to_location_via_info(m, info, pos, p, vec.x, vec.y)) {
-            this->notify_updated();
+            this->notify_updated(m);
         }
     }
 }
@@ -735,27 +1167,33 @@ void Plteen::Plane::clear_motion_actions(IMatter* m) {
     }
 }
 
+/** NOTE
+ * Queries collect candidates from the spatial index and then check them from top to bottom,
+ *   matters below `after` have smaller z-orders, and the `head_matter` as `after` means searching all,
+ *   just like walking the circular list backward.
+ */
 IMatter* Plteen::Plane::find_matter(const Position& pos, IMatter* after) {
     IMatter* found = nullptr;
 
     if (this->head_matter != nullptr) {
-        MatterInfo* head_info = MATTER_INFO(this->head_matter);
         MatterInfo* aftr_info = plane_matter_info(this, after);
-        IMatter* child = (aftr_info == nullptr) ? head_info->prev : aftr_info->prev;
+        uint32_t ceiling = ((aftr_info == nullptr) || (after == this->head_matter)) ? 0xFFFFFFFFU : aftr_info->zorder;
         Dot dot = pos.calculate_point();
 
-        do {
+        this->recalculate_matters_zorder_when_invalid();
+        this->spatial_index.query(dot, this->spatial_candidates);
+        unsafe_sort_by_zorder(this->spatial_candidates);
+
+        for (IMatter* child : this->spatial_candidates) {
             MatterInfo* info = MATTER_INFO(child);
 
-            if (child->visible() && !child->concealled()) {
+            if ((info->zorder < ceiling) && child->visible() && !child->concealled()) {
                 if (this->is_matter_found(child, info, dot)) {
                     found = child;
                     break;
                 }
             }
-
-            child = info->prev;
-        } while (child != head_info->prev);
+        }
     }
 
     return found;
@@ -766,14 +1204,17 @@ IMatter* Plteen::Plane::find_matter(IMatter* collided_matter, IMatter* after) {
     Box self = this->get_matter_bounding_box(collided_matter);
 
     if ((!self.is_empty()) && (this->head_matter != nullptr)) {
-        MatterInfo* head_info = MATTER_INFO(this->head_matter);
         MatterInfo* aftr_info = plane_matter_info(this, after);
-        IMatter* child = (aftr_info == nullptr) ? head_info->prev : aftr_info->prev;
+        uint32_t ceiling = ((aftr_info == nullptr) || (after == this->head_matter)) ? 0xFFFFFFFFU : aftr_info->zorder;
 
-        do {
+        this->recalculate_matters_zorder_when_invalid();
+        this->spatial_index.query(self, this->spatial_candidates);
+        unsafe_sort_by_zorder(this->spatial_candidates);
+
+        for (IMatter* child : this->spatial_candidates) {
             MatterInfo* info = MATTER_INFO(child);
 
-            if (child->visible() && !child->concealled()) {
+            if ((info->zorder < ceiling) && child->visible() && !child->concealled()) {
                 Box box = unsafe_get_matter_bound(child, info);
 
                 if (self.overlay(box) && (collided_matter != child)) {
@@ -781,9 +1222,7 @@ IMatter* Plteen::Plane::find_matter(IMatter* collided_matter, IMatter* after) {
                     break;
                 }
             }
-
-            child = info->prev;
-        } while (child != head_info->prev);
+        }
     }
 
     return found;
@@ -794,58 +1233,72 @@ IMatter* Plteen::Plane::find_least_recent_matter(const Dot& pos) {
     uint32_t found_hit = 0xFFFFFFFFU;
 
     if (this->head_matter != nullptr) {
-        MatterInfo* head_info = MATTER_INFO(this->head_matter);
-        IMatter* child = head_info->prev;
+        this->recalculate_matters_zorder_when_invalid();
+        this->spatial_index.query(pos, this->spatial_candidates);
+        unsafe_sort_by_zorder(this->spatial_candidates);
 
-        do {
+        for (auto it = this->spatial_candidates.begin(); it != this->spatial_candidates.end(); ) {
+            IMatter* child = (*it);
             MatterInfo* info = MATTER_INFO(child);
 
-            if (child->visible() && !child->concealled()) {
-                if (this->is_matter_found(child, info, pos)) {
-                    if (info->selection_hit < found_hit) {
-                        found = child;
-                        found_hit = info->selection_hit;
-                    }
-                } else {
-                    info->selection_hit = 0U;
+            if (child->visible() && !child->concealled() && this->is_matter_found(child, info, pos)) {
+                if (info->selection_hit < found_hit) {
+                    found = child;
+                    found_hit = info->selection_hit;
                 }
+
+                ++ it;
             } else {
-                info->selection_hit = 0U;
+                it = this->spatial_candidates.erase(it);
             }
+        }
+    }
 
-            child = info->prev;
-        } while (child != head_info->prev);
+    /** NOTE
+     * Only the matters that have ever been hit need to be reset,
+     *   `selection_hits` keeps track of them instead of visiting all matters.
+     */
+    for (auto it = this->selection_hits.begin(); it != this->selection_hits.end(); ) {
+        if (std::find(this->spatial_candidates.begin(), this->spatial_candidates.end(), (*it)) == this->spatial_candidates.end()) {
+            MATTER_INFO((*it))->selection_hit = 0U;
+            it = this->selection_hits.erase(it);
+        } else {
+            ++ it;
+        }
     }
 
     if (found != nullptr) {
-        MATTER_INFO(found)->selection_hit ++;
+        MatterInfo* info = MATTER_INFO(found);
+
+        if (info->selection_hit == 0U) {
+            this->selection_hits.push_back(found);
+        }
+
+        info->selection_hit ++;
     }
 
     return found;
 }
 
 /**
- * TODO: if we need to check selected matters first? 
+ * TODO: if we need to check selected matters first?
  */
 IMatter* Plteen::Plane::find_matter_for_tooltip(const Dot& pos) {
     IMatter* found = nullptr;
 
     if (this->head_matter != nullptr) {
-        MatterInfo* head_info = MATTER_INFO(this->head_matter);
-        IMatter* child = head_info->prev;
-
-        do {
-            MatterInfo* info = MATTER_INFO(child);
+        this->recalculate_matters_zorder_when_invalid();
+        this->spatial_index.query(pos, this->spatial_candidates);
+        unsafe_sort_by_zorder(this->spatial_candidates);
 
+        for (IMatter* child : this->spatial_candidates) {
             if (child->visible()) {
-                if (this->is_matter_found(child, info, pos)) {
+                if (this->is_matter_found(child, MATTER_INFO(child), pos)) {
                     found = child;
                     break;
                 }
             }
-
-            child = info->prev;
-        } while (child != head_info->prev);
+        }
     }
 
     return found;
@@ -918,6 +1371,99 @@ void Plteen::Plane::recalculate_matters_extent_when_invalid() {
     }
 }
 
+void Plteen::Plane::recalculate_matters_zorder_when_invalid() {
+    if (this->zorder_invalid) {
+        this->zorder_top = 0U;
+
+        if (this->head_matter != nullptr) {
+            IMatter* child = this->head_matter;
+
+            do {
+                MatterInfo* info = MATTER_INFO(child);
+
+                info->zorder = ++ this->zorder_top;
+                child = info->next;
+            } while (child != this->head_matter);
+        }
+
+        this->zorder_invalid = false;
+    }
+}
+
+void Plteen::Plane::rearrange_matter_states_when_invalid() {
+    if (this->states->disordered) {
+        MatterStates ordered;
+
+        if (this->head_matter != nullptr) {
+            IMatter* child = this->head_matter;
+
+            do {
+                MatterInfo* info = MATTER_INFO(child);
+
+                info->slot = this->states->transfer(info->slot, &ordered);
+                child = info->next;
+            } while (child != this->head_matter);
+        }
+
+        this->states->swap(ordered);
+        this->states->disordered = false;
+    }
+}
+
+void Plteen::Plane::update_matter_index(IMatter* m, MatterInfo* info) {
+    Box box = unsafe_get_matter_bound(m, info);
+    Box obox;
+
+    /* both the previous and the current bounds need redrawing */
+    if (this->spatial_index.feed_box(m, &obox)) {
+        this->damaged_region += obox;
+    }
+
+    this->damaged_region += box;
+    this->spatial_index.insert(m, box);
+    info->width() = box.width();
+    info->height() = box.height();
+
+    info->indexed_round = this->scheduler->round;
+    if (info->in_static_layer) {
+        this->static_layer_dirty = true;
+    }
+}
+
+void Plteen::Plane::notify_matter_updated(IMatter* m) {
+    bool partial = false;
+
+    /** NOTE
+     * Speech bubbles are not indexed, and their infos are not `MatterInfo`s,
+     *   so check the index before trusting `plane_matter_info()`.
+     */
+    if (this->spatial_index.contains(m)) {
+        MatterInfo* info = plane_matter_info(this, m);
+
+        if (info != nullptr) {
+            this->update_matter_index(m, info);
+
+            // speech bubbles are drawn outside their speakers
+            partial = (info->bubble == nullptr);
+        }
+    }
+
+    this->notify_damaged_region(partial);
+}
+
+void Plteen::Plane::notify_damaged_region(bool partial) {
+    if (partial && (this->info != nullptr)) {
+        /* for the selection frame and anti-aliasing */
+        Dot pad(2.0F, 2.0F);
+        Box region(this->damaged_region.ltdot - pad, this->damaged_region.rbdot + pad);
+
+        this->damaged_region.invalidate();
+        this->info->master->notify_updated(region + this->translate);
+    } else {
+        this->notify_updated();
+    }
+}
+
 void Plteen::Plane::add_selected(IMatter* m) {
     if (this->can_select_multiple()) {
         MatterInfo* info = plane_matter_info(this, m);
@@ -1066,7 +1612,7 @@ void Plteen::Plane::on_tap(IMatter* m, float local_x, float local_y) {
                 }
 
                 if ((this->tooltip != nullptr) && (this->tooltip->visible())) {
-                    this->update_tooltip(m, local_x, local_y, local_x + info->x, local_y + info->y);
+                    this->update_tooltip(m, local_x, local_y, local_x + info->x(), local_y + info->y());
                     this->place_tooltip(m);
                 }
             } else if (!this->can_select_multiple()) {
@@ -1096,8 +1642,8 @@ bool Plteen::Plane::on_pointer_pressed(uint8_t button, float x, float y, uint8_t
             if (self_matter->low_level_events_allowed()) {
                 MatterInfo* info = MATTER_INFO(self_matter);
 
-                float local_x = x - info->x;
-                float local_y = y - info->y;
+                float local_x = x - info->x();
+                float local_y = y - info->y();
 
                 handled = self_matter->on_pointer_pressed(button, local_x, local_y, clicks);
             }
@@ -1130,8 +1676,8 @@ bool Plteen::Plane::on_pointer_move(uint32_t state, float x, float y, float dx,
 
         if (self_matter != nullptr) {
             MatterInfo* info = MATTER_INFO(self_matter);
-            float local_x = x - info->x;
-            float local_y = y - info->y;
+            float local_x = x - info->x();
+            float local_y = y - info->y();
 
             if (!self_matter->concealled()) {
                 this->hovering_matter = self_matter;
@@ -1175,8 +1721,8 @@ bool Plteen::Plane::on_pointer_released(uint8_t button, float x, float y, uint8_
 
         if (self_matter != nullptr) {
             MatterInfo* info = MATTER_INFO(self_matter);
-            float local_x = x - info->x;
-            float local_y = y - info->y;
+            float local_x = x - info->x();
+            float local_y = y - info->y();
 
             if (self_matter->events_allowed()) {
                 if (clicks == 1) {
@@ -1221,8 +1767,8 @@ bool Plteen::Plane::say_goodbye_to_hover_matter(uint32_t state, float x, float y
 
     if (this->hovering_matter != nullptr) {
         MatterInfo* info = MATTER_INFO(this->hovering_matter);
-        float local_x = x - info->x;
-        float local_y = y - info->y;
+        float local_x = x - info->x();
+        float local_y = y - info->y();
 
         if (this->hovering_matter->events_allowed()) {
             done |= this->hovering_matter->on_goodbye(local_x, local_y);
@@ -1311,7 +1857,8 @@ void Plteen::Plane::set_matter_fps(IMatter* m, int fps, bool restart) {
     MatterInfo* info = plane_matter_info(this, m);
 
     if (info != nullptr) {
-        unsafe_set_matter_fps(info, fps, restart);
+        unsafe_set_matter_fps(info, fps, restart, this->scheduler->uptime);
+        unsafe_schedule_timeline(this->scheduler, m, info);
     }
 }
 
@@ -1320,45 +1867,121 @@ void Plteen::Plane::set_local_fps(int fps, bool restart) {
 }
 
 
+/** NOTE
+ * Speech bubbles are not indexed, and nor are matters that are not yet or no longer in the plane,
+ *   the latter are synchronized when they are inserted.
+ */
+void Plteen::Plane::notify_matter_motion_changed(IMatter* m) {
+    if (this->spatial_index.contains(m)) {
+        unsafe_sync_motion(m, MATTER_INFO(m));
+    }
+}
+
 void Plteen::Plane::notify_matter_timeline_restart(IMatter* m, uint32_t count0, int duration) {
     MatterInfo* info = plane_matter_info(this, m);
 
     if (info != nullptr) {
-        info->duration = duration;
-        reset_timeline(info->local_frame_count, info->local_elapse, count0);
+        info->duration() = duration;
+        info->local_frame_count() = count0;
+        info->timeline_origin() = this->scheduler->uptime;
+        unsafe_schedule_timeline(this->scheduler, m, info);
     }
 }
 
 void Plteen::Plane::on_elapse(uint64_t count, uint32_t interval, uint64_t uptime) {
     uint32_t elapse = 0U;
 
+    this->rearrange_matter_states_when_invalid();
+    this->scheduler->round ++;
+    this->dispatch_schedules(uptime);
+
     if (this->head_matter != nullptr) {
-        IMatter* child = this->head_matter;
+        MatterStates* states = this->states;
+        uint64_t generation = this->erase_generation;
+        size_t kept = 0U;
+        size_t next = 0U;
         float dwidth, dheight;
 
         this->info->master->feed_client_extent(&dwidth, &dheight);
 
-        do {
-            MatterInfo* info = MATTER_INFO(child);
-            
-            elapse = local_timeline_elapse(interval, info->local_frame_delta, info->local_elapse, info->duration);
-                
-            if (elapse > 0U) {
-                info->duration = child->update(info->local_frame_count ++, elapse, uptime);
-            }
+        /* only the steps of this round are interpolated when drawing, and the last interpolated frame needs erasing */
+        if (this->interpolation_alpha < 1.0F) {
+            this->notify_interpolated();
+        }
+
+        states->px = states->x;
+        states->py = states->y;
+
+        /** NOTE
+         * Only awake slots are visited, from bottom to top just like walking the linked list,
+         *   matters woken or inserted during this round are appended and also visited if their turns have not passed,
+         *   matters removed during this round leave holes, and all of them are pruned along the way.
+         */
+        std::sort(states->awake_slots.begin(), states->awake_slots.end());
+
+        for (size_t pos = 0U; (pos < states->awake_slots.size()) && (generation == this->erase_generation); pos ++) {
+            size_t idx = states->awake_slots[pos];
+            IMatter* child = states->owners[idx];
+            bool awake = false;
+
+            if (idx < next) {
+                // woken after its turn, left to the next round
+                awake = true;
+            } else if (child != nullptr) {
+                MatterInfo* info = MATTER_INFO(child);
+
+                next = idx + 1U;
+
+                if (states->due[idx] != 0U) {
+                    elapse = uint32_t(uptime - states->timeline_origin[idx]);
+                    states->due[idx] = 0U;
+                    states->timeline_origin[idx] = uptime;
+                    states->duration[idx] = child->update(states->local_frame_count[idx] ++, elapse, uptime);
+
+                    if (states->owners[idx] == child) {
+                        unsafe_schedule_timeline(this->scheduler, child, info);
+                    }
+                } else if ((states->local_frame_delta[idx] == 0U) && (states->duration[idx] <= 0)) {
+                    states->duration[idx] = child->update(states->local_frame_count[idx] ++, interval, uptime);
+
+                    if ((states->owners[idx] == child) && (states->duration[idx] > 0)) {
+                        states->timeline_origin[idx] = uptime;
+                        unsafe_schedule_timeline(this->scheduler, child, info);
+                    }
+                }
 
-            /* controlling motion via global timeline makes it more smooth */
-            this->handle_queued_motion(child, info, dwidth, dheight);
+                if (states->owners[idx] == child) {
+                    /* controlling motion via global timeline makes it more smooth, free movers go with the batch */
+                    if (!unsafe_slot_moving(states, idx)) {
+                        this->handle_queued_motion(child, info, dwidth, dheight);
+                    }
 
-            if (is_matter_bubble_showing(child, info)) {
-                if (current_milliseconds() >= info->bubble_expiration_time) {
-                    bubble_expire(child, info);
-                    this->notify_updated(child);
+                    awake = (states->owners[idx] == child) && unsafe_matter_awake(info);
                 }
             }
 
-            child = info->next;
-        } while (child != this->head_matter);
+            // the states have gone with the plane if the plane is erased meanwhile
+            if (generation == this->erase_generation) {
+                if (awake) {
+                    states->awake_slots[kept ++] = idx;
+                } else {
+                    states->awake[idx] = 0U;
+                }
+            }
+        }
+
+        if (generation == this->erase_generation) {
+            states->awake_slots.resize(kept);
+        }
+
+        /** NOTE
+         * Unlike gliding ones, free movers are not stepped in their own turns,
+         *   they are stepped together after all matters are updated, so that
+         *   `update()` of any matter sees the locations of the last round,
+         *   and the heading events and `on_border()` are fired after the integration.
+         */
+        this->handle_batched_motions(dwidth, dheight);
+        this->detect_collisions();
     }
 
     elapse = local_timeline_elapse(interval, this->local_frame_delta, this->local_elapse, 0);
@@ -1374,32 +1997,184 @@ void Plteen::Plane::on_elapse(uint64_t count, uint32_t interval, uint64_t uptime
     }
 }
 
+/** NOTE
+ * The plane is quiescent if none of its matters is moving, waiting for queued motions or busy on its own,
+ *   the earliest expiration of speech bubbles is also a wake-up.
+ *
+ * Work done in `update()` of subclasses is invisible here,
+ *   planes animating on their own have to override this, or they freeze under idle pacing.
+ */
+bool Plteen::Plane::is_quiescent(uint64_t uptime, uint64_t* wakeup) {
+    bool quiescent = true;
+
+    if ((this->tooltip != nullptr) && this->tooltip->visible() && (this->hovering_matter != nullptr)) {
+        quiescent = false;
+    } else if (this->head_matter != nullptr) {
+        IMatter* child = this->head_matter;
+
+        do {
+            MatterInfo* info = MATTER_INFO(child);
+            uint64_t mwakeup = 0U;
+
+            if (!child->motion_stopped() || info->gliding() || !info->motion_actions.empty()) {
+                quiescent = false;
+            } else if (!child->is_quiescent(uptime, &mwakeup)) {
+                quiescent = false;
+            } else {
+                if (is_matter_bubble_showing(child, info)) {
+                    unsafe_earlier_wakeup(wakeup, info->bubble_expiration_time);
+                }
+
+                unsafe_earlier_wakeup(wakeup, mwakeup);
+            }
+
+            child = info->next;
+        } while (quiescent && (child != this->head_matter));
+    }
+
+    if (quiescent) {
+        for (auto& cb : this->scheduler->callbacks) {
+            unsafe_earlier_wakeup(wakeup, cb.second.due);
+        }
+    }
+
+    return quiescent;
+}
+
+/** NOTE
+ * A matter drawn between its last two steps may appear anywhere in between,
+ *   so the region it sweeps through is damaged, matters staying still are left alone.
+ */
+bool Plteen::Plane::notify_interpolated() {
+    bool moving = false;
+
+    if (this->head_matter != nullptr) {
+        MatterStates* states = this->states;
+        Box box;
+
+        for (size_t idx = 0U; idx < states->size(); idx ++) {
+            IMatter* child = states->owners[idx];
+
+            if ((child != nullptr) && ((states->px[idx] != states->x[idx]) || (states->py[idx] != states->y[idx]))) {
+                if (this->spatial_index.feed_box(child, &box)) {
+                    this->damaged_region += box;
+                    this->damaged_region += box + Dot(states->px[idx] - states->x[idx], states->py[idx] - states->y[idx]);
+                    moving = true;
+                }
+            }
+        }
+
+        if (moving) {
+            this->notify_damaged_region(true);
+        }
+    }
+
+    return moving;
+}
+
+/*************************************************************************************************/
+uint64_t Plteen::Plane::schedule_after(uint32_t ms, const std::function<void()>& callback) {
+    PlaneScheduler* scheduler = this->scheduler;
+    uint64_t id = ++ scheduler->ticket;
+    uint64_t due = scheduler->uptime + ms;
+
+    scheduler->callbacks[id] = { due, callback };
+    scheduler->wheel.insert(due, { nullptr, id, ScheduleType::Callback });
+
+    return id;
+}
+
+void Plteen::Plane::cancel_schedule(uint64_t id) {
+    this->scheduler->callbacks.erase(id);
+}
+
+void Plteen::Plane::dispatch_schedules(uint64_t uptime) {
+    PlaneScheduler* scheduler = this->scheduler;
+    
+    scheduler->uptime = uptime;
+    scheduler->fired.clear();
+    scheduler->wheel.advance(uptime, scheduler->fired);
+
+    /** NOTE
+     * Fired entries are copied out before handling,
+     *   since callbacks and matters might schedule new things or remove matters.
+     */
+    for (size_t idx = 0U; idx < scheduler->fired.size(); idx ++) {
+        PlaneSchedule s = scheduler->fired[idx];
+
+        if (s.type == ScheduleType::Callback) {
+            auto it = scheduler->callbacks.find(s.ticket);
+
+            if (it != scheduler->callbacks.end()) {
+                std::function<void()> proc = it->second.proc;
+
+                scheduler->callbacks.erase(it);
+                proc();
+            }
+        } else if (this->spatial_index.contains(s.target)) {
+            MatterInfo* info = MATTER_INFO(s.target);
+
+            if (s.type == ScheduleType::Timeline) {
+                if (info->timeline_ticket == s.ticket) {
+                    info->states->due[info->slot] = 1U;
+                    unsafe_wake_slot(info->states, info->slot);
+                }
+            } else if (info->bubble_ticket == s.ticket) {
+                if (is_matter_bubble_showing(s.target, info)) {
+                    bubble_expire(s.target, info);
+                    this->notify_updated(s.target);
+                }
+            }
+        }
+    }
+}
+
 void Plteen::Plane::draw(dc_t* dc, float X, float Y, float Width, float Height) {
     float dsX = flmax(0.0F, X);
     float dsY = flmax(0.0F, Y);
     float dsWidth = X + Width;
     float dsHeight = Y + Height;
-    
-    if (this->background.is_opacity()) {
-        dc->fill_rect(dsX, dsY, dsWidth, dsHeight, this->background);
+
+    /** NOTE
+     * A clipping region set by the display means only that region is damaged,
+     *   matters outside it are skipped and the others are clipped into it.
+     */
+    this->redraw_partially = dc->feed_clipping_region(&this->redraw_clip);
+    this->interpolation_alpha = ((this->info != nullptr) ? this->info->master->display()->get_interpolation_alpha() : 1.0F);
+    if (this->redraw_partially) {
+        dsX = flmax(dsX, float(this->redraw_clip.x));
+        dsY = flmax(dsY, float(this->redraw_clip.y));
+        dsWidth = flmin(dsWidth, float(this->redraw_clip.x + this->redraw_clip.w));
+        dsHeight = flmin(dsHeight, float(this->redraw_clip.y + this->redraw_clip.h));
     }
+    
+    IMatter* dynamic_head = this->head_matter;
+
+    /* primitives of matters are merged into batches, and are submitted when the plane is done */
+    dc->begin_recording();
 
-    if (this->grid_color.is_opacity()
-            && (this->column > 0) && (this->row > 0)
-            && (this->cell_width > 0.0F) && (this->cell_height > 0.0F)) {
-        dc->draw_grid(this->row, this->column,
-                        this->cell_width, this->cell_height,
-                        this->grid_color,
-                        this->grid_x, this->grid_y);
+    if (!this->draw_static_layer(dc, X, Y, Width, Height, &dynamic_head)) {
+        if (this->background.is_opacity()) {
+            dc->fill_rect(dsX, dsY, dsWidth, dsHeight, this->background);
+        }
+
+        if (this->grid_color.is_opacity()
+                && (this->column > 0) && (this->row > 0)
+                && (this->cell_width > 0.0F) && (this->cell_height > 0.0F)) {
+            dc->draw_cached_grid(this->row, this->column,
+                                   this->cell_width, this->cell_height,
+                                   this->grid_color,
+                                   this->grid_x, this->grid_y);
+        }
     }
 
     if (this->head_matter != nullptr) {
         IMatter* speech_head = nullptr;
         IMatter* speech_nil = nullptr;
-        IMatter* child = this->head_matter;
+        IMatter* child = dynamic_head;
         MatterInfo* info = nullptr;
         
-        do {
+        while (child != nullptr) {
             info = MATTER_INFO(child);
 
             if (this->tooltip != child) {
@@ -1414,8 +2189,8 @@ void Plteen::Plane::draw(dc_t* dc, float X, float Y, float Width, float Height)
                 this->draw_matter(dc, child, info, X, Y, dsX, dsY, dsWidth, dsHeight);
             }
 
-            child = info->next;
-        } while (child != this->head_matter);
+            child = (info->next == this->head_matter) ? nullptr : info->next;
+        }
 
         if (speech_head != nullptr) {
             child = speech_head;
@@ -1431,7 +2206,131 @@ void Plteen::Plane::draw(dc_t* dc, float X, float Y, float Width, float Height)
             this->draw_matter(dc, this->tooltip, MATTER_INFO(this->tooltip), X, Y, dsX, dsY, dsWidth, dsHeight);
         }
 
-        dc->clear_clipping_region();
+        unsafe_clear_clipping_region(dc, this->redraw_partially ? &this->redraw_clip : nullptr);
+    }
+
+    dc->end_recording();
+    this->redraw_partially = false;
+}
+
+/** NOTE
+ * Only the bottommost run of static matters could be composited into the layer,
+ *   otherwise the layer would cover dynamic matters that are below static ones.
+ */
+bool Plteen::Plane::draw_static_layer(dc_t* dc, float X, float Y, float Width, float Height, IMatter** rest) {
+    IMatter* child = this->head_matter;
+    size_t n = 0U;
+    bool layered = false;
+
+    if (child != nullptr) {
+        do {
+            MatterInfo* info = MATTER_INFO(child);
+
+            if (!this->is_matter_static(child, info)) {
+                break;
+            }
+
+            n ++;
+            child = info->next;
+        } while (child != this->head_matter);
+    }
+
+    if (n > 0U) {
+        int width = fl2fxi(flceiling(Width));
+        int height = fl2fxi(flceiling(Height));
+        int lwidth = 0;
+        int lheight = 0;
+
+        if (this->static_layer.use_count() > 0) {
+            this->static_layer->feed_extent(&lwidth, &lheight);
+        }
+
+        if ((lwidth != width) || (lheight != height)) {
+            this->static_layer = std::make_shared<Texture>(dc->create_blank_image(width, height));
+            this->static_layer_dirty = true;
+        }
+
+        if ((n != this->static_layer_size)
+                || (this->static_layer_background != this->background)
+                || (this->static_layer_grid_color != this->grid_color)) {
+            this->static_layer_dirty = true;
+        }
+
+        if (this->static_layer->okay()) {
+            if (this->static_layer_dirty) {
+                SDL_Texture* origin = dc->get_target();
+                bool partially = this->redraw_partially;
+                IMatter* self = this->head_matter;
+                size_t idx = 0U;
+
+                dc->set_target(this->static_layer->self());
+                dc->clear(RGBA(0x0U, 0.0));
+                this->redraw_partially = false;
+
+                if (this->background.is_opacity()) {
+                    dc->fill_rect(0.0F, 0.0F, Width, Height, this->background);
+                }
+
+                if (this->grid_color.is_opacity()
+                        && (this->column > 0) && (this->row > 0)
+                        && (this->cell_width > 0.0F) && (this->cell_height > 0.0F)) {
+                    dc->draw_grid(this->row, this->column,
+                                    this->cell_width, this->cell_height,
+                                    this->grid_color,
+                                    this->grid_x, this->grid_y);
+                }
+
+                do {
+                    MatterInfo* info = MATTER_INFO(self);
+
+                    info->in_static_layer = (idx < n);
+
+                    if (info->in_static_layer) {
+                        this->draw_matter(dc, self, info, 0.0F, 0.0F, 0.0F, 0.0F, Width, Height);
+                    }
+
+                    idx ++;
+                    self = info->next;
+                } while (self != this->head_matter);
+
+                // the clipping region is dropped by switching targets
+                dc->set_target(origin);
+                this->redraw_partially = partially;
+                unsafe_clear_clipping_region(dc, this->redraw_partially ? &this->redraw_clip : nullptr);
+
+                this->static_layer_background = this->background;
+                this->static_layer_grid_color = this->grid_color;
+                this->static_layer_size = n;
+                this->static_layer_dirty = false;
+            }
+
+            dc->stamp(this->static_layer->self(), X, Y, float(width), float(height));
+            (*rest) = (child == this->head_matter) ? nullptr : child;
+            layered = true;
+        }
+    }
+
+    return layered;
+}
+
+bool Plteen::Plane::is_matter_static(IMatter* m, MatterInfo* info) {
+    bool yes = info->is_static;
+
+    if ((!yes) && (this->static_layer_threshold > 0U)) {
+        yes = ((this->scheduler->round - info->indexed_round) >= this->static_layer_threshold);
+    }
+
+    // selections, speech bubbles and the tooltip are drawn over other matters
+    return yes && (!info->selected) && (info->bubble == nullptr) && (m != this->tooltip);
+}
+
+void Plteen::Plane::set_static_matter(IMatter* m, bool yes_or_no) {
+    MatterInfo* info = plane_matter_info(this, m);
+
+    if ((info != nullptr) && (info->is_static != yes_or_no)) {
+        info->is_static = yes_or_no;
+        this->static_layer_dirty = true;
+        this->notify_updated(m);
     }
 }
 
@@ -1448,8 +2347,13 @@ void Plteen::Plane::draw_matter(dc_t* dc, IMatter* child, MatterInfo* info, floa
         float mwidth = box.width();
         float mheight = box.height();
 
-        mx = (info->x + this->translate.x) + X;
-        my = (info->y + this->translate.y) + Y;
+        if (this->interpolation_alpha < 1.0F) {
+            mx = (info->px() + (info->x() - info->px()) * this->interpolation_alpha + this->translate.x) + X;
+            my = (info->py() + (info->y() - info->py()) * this->interpolation_alpha + this->translate.y) + Y;
+        } else {
+            mx = (info->x() + this->translate.x) + X;
+            my = (info->y() + this->translate.y) + Y;
+        }
                 
         if (rectangle_overlay(mx, my, mx + mwidth, my + mheight, dsX, dsY, dsWidth, dsHeight)) {
             clip.x = fl2fxi(flfloor(mx));
@@ -1457,7 +2361,7 @@ void Plteen::Plane::draw_matter(dc_t* dc, IMatter* child, MatterInfo* info, floa
             clip.w = fl2fxi(flceiling(mwidth));
             clip.h = fl2fxi(flceiling(mheight));
 
-            dc->set_clipping_region(&clip);
+            unsafe_set_clipping_region(dc, &clip, this->redraw_partially ? &this->redraw_clip : nullptr);
 
             if (child->ready()) {
                 child->draw(dc, mx, my, mwidth, mheight);
@@ -1466,7 +2370,7 @@ void Plteen::Plane::draw_matter(dc_t* dc, IMatter* child, MatterInfo* info, floa
             }
 
             if (info->selected) {
-                dc->clear_clipping_region();
+                unsafe_clear_clipping_region(dc, this->redraw_partially ? &this->redraw_clip : nullptr);
                 this->draw_visible_selection(dc, mx, my, mwidth, mheight);
             }
         }
@@ -1489,8 +2393,8 @@ void Plteen::Plane::draw_speech(dc_t* dc, IMatter* child, MatterInfo* info, floa
         bwidth =  iwidth +  this->bubble_margin.horizon();
         bheight = iheight + this->bubble_margin.vertical();
         this->place_speech_bubble(child, bwidth, bheight, Width, Height, &mp, &bp, &dx, &dy);
-        bx = info->x + mwidth  * mp.fx - bwidth  * bp.fx + dx;
-        by = info->y + mheight * mp.fy - bheight * bp.fy + dy;
+        bx = info->x() + mwidth  * mp.fx - bwidth  * bp.fx + dx;
+        by = info->y() + mheight * mp.fy - bheight * bp.fy + dy;
         bx = (bx + this->translate.x) + X;
         by = (by + this->translate.y) + Y;
 
@@ -1506,12 +2410,12 @@ void Plteen::Plane::draw_speech(dc_t* dc, IMatter* child, MatterInfo* info, floa
             clip.w = fl2fxi(flceiling(iwidth));
             clip.h = fl2fxi(flceiling(iheight));
 
-            dc->clear_clipping_region();
+            unsafe_clear_clipping_region(dc, this->redraw_partially ? &this->redraw_clip : nullptr);
 
             dc->fill_rounded_rect(bx, by, bwidth, bheight, -0.25F, this->bubble_color);
             dc->draw_rounded_rect(bx, by, bwidth, bheight, -0.25F, this->bubble_border);
 
-            dc->set_clipping_region(&clip);
+            unsafe_set_clipping_region(dc, &clip, this->redraw_partially ? &this->redraw_clip : nullptr);
             
             if (info->bubble->ready()) {
                 info->bubble->draw(dc, ix, iy, iwidth, iheight);
@@ -1530,22 +2434,27 @@ bool Plteen::Plane::do_moving_via_info(IMatter* m, MatterInfo* info, const Posit
     float y = dot.y;
     
     if (!absolute) {
-        x += info->x;
-        y += info->y;
+        x += info->x();
+        y += info->y();
     }    
     
-    if ((info->x != x) || (info->y != y)) {
-        float ox = info->x;
-        float oy = info->y;
+    if ((info->x() != x) || (info->y() != y)) {
+        float ox = info->x();
+        float oy = info->y();
+
+        info->x() = x;
+        info->y() = y;
 
-        info->x = x;
-        info->y = y;
+        /* moving directly is not interpolated */
+        info->px() = x;
+        info->py() = y;
 
         if (heading) {
             m->set_heading(x - ox, y - oy);
         }
 
         unsafe_location_changed(m, info, ox, oy, ignore_track);
+        this->update_matter_index(m, info);
         this->size_cache_invalid();
         moved = true;
     }
@@ -1560,34 +2469,35 @@ bool Plteen::Plane::do_gliding_via_info(IMatter* m, MatterInfo* info, const Posi
     float y = dot.y;
     
     if (!absolute) {
-        x += info->x;
-        y += info->y;
+        x += info->x();
+        y += info->y();
     }    
 
-    if ((info->x != x) || (info->y != y)) {
+    if ((info->x() != x) || (info->y() != y)) {
         /** WARNING
          * Meanwhile the gliding time is not accurate
          * `flfloor` makes it more accurate than `flceiling`
          **/
         double n = flfloor(sec / sec_delta);
-        float dx = x - info->x;
-        float dy = y - info->y;
+        float dx = x - info->x();
+        float dy = y - info->y();
         double xspd = dx / n;
         double yspd = dy / n;
 
         m->set_delta_speed(0.0, 0.0);
         m->set_speed(xspd, yspd);
                 
-        info->gliding = true;
-        info->gliding_tx = x;
-        info->gliding_ty = y;
-        info->current_step = 1.0;
-        info->progress_total = n;
-
-        this->on_motion_start(m, sec, info->x, info->y, xspd, yspd);
-        m->step(&info->x, &info->y);
-        this->on_motion_step(m, info->x, info->y, xspd, yspd, info->current_step / info->progress_total);
+        unsafe_set_gliding(m, info, true);
+        info->gliding_tx() = x;
+        info->gliding_ty() = y;
+        info->current_step() = 1.0;
+        info->progress_total() = n;
+
+        this->on_motion_start(m, sec, info->x(), info->y(), xspd, yspd);
+        this->step_matter(m, info);
+        this->on_motion_step(m, info->x(), info->y(), xspd, yspd, info->current_step() / info->progress_total());
         unsafe_location_changed(m, info, x - dx, y - dy, ignore_track);
+        this->update_matter_index(m, info);
         this->size_cache_invalid();
         moved = true;
     }
@@ -1598,7 +2508,7 @@ bool Plteen::Plane::do_gliding_via_info(IMatter* m, MatterInfo* info, const Posi
 bool Plteen::Plane::move_matter_via_info(IMatter* m, MatterInfo* info, double length, bool ignore_gliding, bool heading) {
     bool moved = false;
 
-    if ((!info->gliding) || ignore_gliding) {
+    if ((!info->gliding()) || ignore_gliding) {
         moved = this->do_vector_moving(m, info, length, heading);
     } else {
         double x, y;
@@ -1614,7 +2524,7 @@ bool Plteen::Plane::move_matter_via_info(IMatter* m, MatterInfo* info, double le
 bool Plteen::Plane::move_matter_via_info(IMatter* m, MatterInfo* info, const Position& pos, bool absolute, bool ignore_gliding, bool heading) {
     bool moved = false;
 
-    if ((!info->gliding) || ignore_gliding) {
+    if ((!info->gliding()) || ignore_gliding) {
         moved = this->do_moving_via_info(m, info, pos, absolute, false, heading);
     } else if (m == this->tooltip) {
         moved = this->do_moving_via_info(m, info, pos, absolute, true, heading);
@@ -1628,7 +2538,7 @@ bool Plteen::Plane::move_matter_via_info(IMatter* m, MatterInfo* info, const Pos
 bool Plteen::Plane::glide_matter_via_info(IMatter* m, MatterInfo* info, double sec, double length) {
     bool moved = false;
 
-    if (!info->gliding) {
+    if (!info->gliding()) {
         this->do_vector_gliding(m, info, length, sec);
     } else {
         info->motion_actions.push_back(MotionAction(GlidingMotion(length, sec, false, true)));
@@ -1649,7 +2559,7 @@ bool Plteen::Plane::glide_matter_via_info(IMatter* m, MatterInfo* info, double s
         if ((sec <= sec_delta) || (sec_delta == 0.0)) {
             moved = this->move_matter_via_info(m, info, pos, absolute, false, heading);
         } else {
-            if (!info->gliding) {
+            if (!info->gliding()) {
                 moved = this->do_gliding_via_info(m, info, pos, sec, sec_delta, absolute, false);
             } else {
                 info->motion_actions.push_back(MotionAction(GlidingMotion(pos, sec, sec_delta, absolute, heading)));
@@ -1688,6 +2598,127 @@ bool Plteen::Plane::move_matter_to_location_via_info(IMatter* m, MatterInfo* inf
     return this->glide_matter_to_location_via_info(m, info, 0.0F, pos, p, dx, dy, false);
 }
 
+void Plteen::Plane::step_matter(IMatter* m, MatterInfo* info) {
+    /** WARNING
+     * Don't step on the states directly,
+     *   heading events might insert matters and therefore reallocate the states.
+     */
+    float x = info->x();
+    float y = info->y();
+
+    m->step(&x, &y);
+    info->x() = x;
+    info->y() = y;
+}
+
+/** NOTE
+ * Free movers are stepped together in place after all matters have been updated,
+ *   the events are fired only for those whose headings change or who cross the border,
+ *   and all of them are reported to the master as a single damaged region.
+ * 
+ * Stepped velocities are handed back to movers before any event is fired in slot order,
+ *   so that velocities changed by events, of the movers themselves or others, take effect in the next round.
+ */
+void Plteen::Plane::handle_batched_motions(float dwidth, float dheight) {
+    MatterStates* states = this->states;
+    MotionBatch* batch = &this->motion_batch;
+
+    this->motion_slots.clear();
+
+    // movers are listed when they start moving, and the stopped or removed ones are pruned here
+    for (size_t slot : states->mover_slots) {
+        if ((states->owners[slot] != nullptr) && unsafe_slot_moving(states, slot)) {
+            this->motion_slots.push_back(slot);
+        } else {
+            states->mover[slot] = 0U;
+        }
+    }
+
+    std::sort(this->motion_slots.begin(), this->motion_slots.end());
+    states->mover_slots = this->motion_slots;
+
+    if (!this->motion_slots.empty()) {
+        uint64_t generation = this->erase_generation;
+        bool moved = false;
+        bool partial = true;
+
+        batch->clear();
+
+        // runs of adjacent slots are stepped together, entries of the batch are in the order of `motion_slots`
+        for (size_t idx = 0U; idx < this->motion_slots.size(); ) {
+            size_t first = this->motion_slots[idx];
+            size_t n = 1U;
+
+            while ((idx + n < this->motion_slots.size()) && (this->motion_slots[idx + n] == first + n)) {
+                n ++;
+            }
+
+            batch->integrate(states->vx.data() + first, states->vy.data() + first,
+                states->ax.data() + first, states->ay.data() + first,
+                states->tvx.data() + first, states->tvy.data() + first,
+                states->x.data() + first, states->y.data() + first,
+                states->width.data() + first, states->height.data() + first,
+                n, dwidth, dheight);
+
+            idx += n;
+        }
+
+        for (size_t slot : this->motion_slots) {
+            if ((states->ax[slot] != 0.0) || (states->ay[slot] != 0.0)) {
+                batch->write_back(states->owners[slot], states->vx[slot], states->vy[slot]);
+            }
+        }
+
+        for (size_t idx = 0U; (idx < this->motion_slots.size()) && (generation == this->erase_generation); idx ++) {
+            size_t slot = this->motion_slots[idx];
+            IMatter* child = states->owners[slot];
+
+            // matters might be removed by the events of others
+            if (child != nullptr) {
+                MatterInfo* info = MATTER_INFO(child);
+                float hoffset = batch->hoffset(idx);
+                float voffset = batch->voffset(idx);
+                float ox = batch->ox(idx);
+                float oy = batch->oy(idx);
+
+                batch->commit(child);
+
+                if ((hoffset != 0.0F) || (voffset != 0.0F)) {
+                    child->on_border(hoffset, voffset);
+
+                    if (child->x_stopped()) {
+                        if (info->x() < 0.0F) {
+                            info->x() = 0.0F;
+                        } else if (info->x() + info->width() > dwidth) {
+                            info->x() = dwidth - info->width();
+                        }
+                    }
+
+                    if (child->y_stopped()) {
+                        if (info->y() < 0.0F) {
+                            info->y() = 0.0F;
+                        } else if (info->y() + info->height() > dheight) {
+                            info->y() = dheight - info->height();
+                        }
+                    }
+                }
+
+                if ((info->x() != ox) || (info->y() != oy)) {
+                    unsafe_location_changed(child, info, ox, oy, false);
+                    this->update_matter_index(child, info);
+                    partial = partial && (info->bubble == nullptr);
+                    moved = true;
+                }
+            }
+        }
+
+        if (moved) {
+            this->size_cache_invalid();
+            this->notify_damaged_region(partial);
+        }
+    }
+}
+
 void Plteen::Plane::handle_queued_motion(IMatter* m, MatterInfo* info, float dwidth, float dheight) {
     if (!m->motion_stopped()) {
         Box box = m->get_bounding_box();
@@ -1695,39 +2726,39 @@ void Plteen::Plane::handle_queued_motion(IMatter* m, MatterInfo* info, float dwi
         float cheight = box.height();
         double xspd = m->x_speed();
         double yspd = m->y_speed();
-        float ox = info->x;
-        float oy = info->y;
+        float ox = info->x();
+        float oy = info->y();
         float hdist, vdist;
         
-        m->step(&info->x, &info->y);
+        this->step_matter(m, info);
         
-        if (info->gliding) {
-            if (over_stepped(info->gliding_tx, info->x, xspd)
-                    || over_stepped(info->gliding_ty, info->y, yspd)) {
-                info->x = info->gliding_tx;
-                info->y = info->gliding_ty;
-                this->on_motion_step(m, info->x, info->y, xspd, yspd, 1.0);
+        if (info->gliding()) {
+            if (over_stepped(info->gliding_tx(), info->x(), xspd)
+                    || over_stepped(info->gliding_ty(), info->y(), yspd)) {
+                info->x() = info->gliding_tx();
+                info->y() = info->gliding_ty();
+                this->on_motion_step(m, info->x(), info->y(), xspd, yspd, 1.0);
                 m->motion_stop();
-                info->gliding = false;
-                this->on_motion_complete(m, info->x, info->y, xspd, yspd);
+                unsafe_set_gliding(m, info, false);
+                this->on_motion_complete(m, info->x(), info->y(), xspd, yspd);
             } else {
-                info->current_step += 1.0F;
-                this->on_motion_step(m, info->x, info->y, xspd, yspd, info->current_step / info->progress_total);
+                info->current_step() += 1.0F;
+                this->on_motion_step(m, info->x(), info->y(), xspd, yspd, info->current_step() / info->progress_total());
             }
         }
 
-        if (info->x < 0.0F) {
-            hdist = info->x;
-        } else if (info->x + cwidth > dwidth) {
-            hdist = info->x + cwidth - dwidth;
+        if (info->x() < 0.0F) {
+            hdist = info->x();
+        } else if (info->x() + cwidth > dwidth) {
+            hdist = info->x() + cwidth - dwidth;
         } else {
             hdist = 0.0F;
         }
 
-        if (info->y < 0.0F) {
-            vdist = info->y;
-        } else if (info->y + cheight > dheight) {
-            vdist = info->y + cheight - dheight;
+        if (info->y() < 0.0F) {
+            vdist = info->y();
+        } else if (info->y() + cheight > dheight) {
+            vdist = info->y() + cheight - dheight;
         } else {
             vdist = 0.0F;
         }
@@ -1736,31 +2767,32 @@ void Plteen::Plane::handle_queued_motion(IMatter* m, MatterInfo* info, float dwi
             m->on_border(hdist, vdist);
                         
             if (m->x_stopped()) {
-                if (info->x < 0.0F) {
-                    info->x = 0.0F;
-                } else if (info->x + cwidth > dwidth) {
-                    info->x = dwidth - cwidth;
+                if (info->x() < 0.0F) {
+                    info->x() = 0.0F;
+                } else if (info->x() + cwidth > dwidth) {
+                    info->x() = dwidth - cwidth;
                 }
             }
 
             if (m->y_stopped()) {
-                if (info->y < 0.0F) {
-                    info->y = 0.0F;
-                } else if (info->y + cheight > dheight) {
-                    info->y = dheight - cheight;
+                if (info->y() < 0.0F) {
+                    info->y() = 0.0F;
+                } else if (info->y() + cheight > dheight) {
+                    info->y() = dheight - cheight;
                 }
             }
         }
 
         // TODO: dealing with bounce and glide
-        if (info->gliding && m->motion_stopped()) {
-            info->gliding = false;
+        if (info->gliding() && m->motion_stopped()) {
+            unsafe_set_gliding(m, info, false);
         }
 
-        if ((info->x != ox) || (info->y != oy)) {
+        if ((info->x() != ox) || (info->y() != oy)) {
             unsafe_location_changed(m, info, ox, oy, false);
+            this->update_matter_index(m, info);
             this->size_cache_invalid();
-            this->notify_updated();
+            this->notify_updated(m);
         }
     } else {
         while (!info->motion_actions.empty()) {
@@ -1774,17 +2806,17 @@ void Plteen::Plane::handle_queued_motion(IMatter* m, MatterInfo* info, float dwi
                 if (gm.second > 0.0) {
                     if (gm.sec_delta > 0.0) {
                         if (this->do_gliding_via_info(m, info, gm.target, gm.second, gm.sec_delta, gm.absolute, false)) {
-                            this->notify_updated();
+                            this->notify_updated(m);
                             break;
                         }
                     } else {
                         if (this->do_vector_gliding(m, info, gm.length, gm.second)) {
-                            this->notify_updated();
+                            this->notify_updated(m);
                             break;
                         }
                     }
                 } else if (this->do_moving_via_info(m, info, gm.target, gm.absolute, false, gm.heading)) {
-                    this->notify_updated();
+                    this->notify_updated(m);
                 }
             } else {
                 unsafe_canvas_info_do_setting(this, m, info, next_move);
@@ -1814,7 +2846,7 @@ bool Plteen::Plane::do_vector_gliding(IMatter* m, MatterInfo* info, double lengt
 }
 
 bool Plteen::Plane::is_matter_found(IMatter* m, MatterInfo* info, const Dot& dot) {
-    Dot lp = Dot(dot.x - info->x, dot.y - info->y);
+    Dot lp = Dot(dot.x - info->x(), dot.y - info->y());
 
     /** NOTE:
      * the translation should only affect view poisition(say, mouse position for instance)
@@ -1823,6 +2855,174 @@ bool Plteen::Plane::is_matter_found(IMatter* m, MatterInfo* info, const Dot& dot
     return m->is_colliding(lp);
 }
 
+/*************************************************************************************************/
+void Plteen::Plane::set_collision_layer(IMatter* m, uint32_t layer, uint32_t mask) {
+    MatterInfo* info = plane_matter_info(this, m);
+
+    if (info != nullptr) {
+        bool joined = (info->collision_layer != 0U);
+
+        info->collision_layer = layer;
+        info->collision_mask = mask;
+
+        if (layer == 0U) {
+            if (joined) {
+                this->forget_collisions(m);
+            }
+        } else if (!joined) {
+            info->collision_ticket = ++ this->collision_ticket;
+            this->collision_sweep.push_back(m);
+        }
+    }
+}
+
+uint32_t Plteen::Plane::get_collision_layer(IMatter* m) {
+    MatterInfo* info = plane_matter_info(this, m);
+
+    return (info != nullptr) ? info->collision_layer : 0U;
+}
+
+/** NOTE
+ * Collisions of the leaving matter end here, while it is still in the plane.
+ */
+void Plteen::Plane::forget_collisions(IMatter* m) {
+    std::vector<std::pair<IMatter*, IMatter*>> ended;
+
+    unsafe_forget_matter(this->collision_sweep, m);
+
+    for (auto it = this->colliding_pairs.begin(); it != this->colliding_pairs.end(); ) {
+        if ((it->first == m) || (it->second == m)) {
+            ended.push_back((*it));
+            it = this->colliding_pairs.erase(it);
+        } else {
+            ++ it;
+        }
+    }
+
+    if (!ended.empty()) {
+        this->dispatch_collisions(ended, { });
+    }
+}
+
+/** NOTE
+ * The sweep list is kept sorted by the left edges of the bounding boxes among frames,
+ *   since matters move only a little per frame, the insertion sort runs in almost linear time,
+ *   and only the matters whose x-extents overlap are then tested by layers, masks, and y-extents.
+ *
+ * Bounding boxes are taken from the spatial index, which is always kept up to date.
+ * Pairs are ordered by the order of joining rather than the addresses,
+ *   so that the events are dispatched in the same order among runs.
+ */
+void Plteen::Plane::detect_collisions() {
+    std::vector<std::pair<IMatter*, IMatter*>> pairs;
+    size_t n = this->collision_sweep.size();
+
+    pairs.reserve(this->colliding_pairs.size());
+
+    for (IMatter* m : this->collision_sweep) {
+        MatterInfo* info = MATTER_INFO(m);
+
+        if (!this->spatial_index.feed_box(m, &info->collision_box)) {
+            info->collision_box = unsafe_get_matter_bound(m, info);
+        }
+    }
+
+    for (size_t i = 1; i < n; i ++) {
+        IMatter* m = this->collision_sweep[i];
+        float left = MATTER_INFO(m)->collision_box.ltdot.x;
+        size_t j = i;
+
+        while ((j > 0) && (MATTER_INFO(this->collision_sweep[j - 1])->collision_box.ltdot.x > left)) {
+            this->collision_sweep[j] = this->collision_sweep[j - 1];
+            j --;
+        }
+
+        this->collision_sweep[j] = m;
+    }
+
+    for (size_t i = 0; i < n; i ++) {
+        IMatter* self = this->collision_sweep[i];
+        MatterInfo* sinfo = MATTER_INFO(self);
+
+        if (self->visible() && !self->concealled()) {
+            for (size_t j = i + 1; j < n; j ++) {
+                IMatter* target = this->collision_sweep[j];
+                MatterInfo* tinfo = MATTER_INFO(target);
+
+                if (tinfo->collision_box.ltdot.x > sinfo->collision_box.rbdot.x) {
+                    break;
+                }
+
+                if ((sinfo->collision_layer & tinfo->collision_mask) && (tinfo->collision_layer & sinfo->collision_mask)) {
+                    if (target->visible() && !target->concealled()) {
+                        if ((tinfo->collision_box.ltdot.y <= sinfo->collision_box.rbdot.y)
+                                && (sinfo->collision_box.ltdot.y <= tinfo->collision_box.rbdot.y)) {
+                            if (sinfo->collision_ticket < tinfo->collision_ticket) {
+                                pairs.push_back({ self, target });
+                            } else {
+                                pairs.push_back({ target, self });
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end(), unsafe_collision_pair_less);
+    this->colliding_pairs.swap(pairs);
+
+    { // `pairs` holds the previous pairs now
+        std::vector<std::pair<IMatter*, IMatter*>> ended;
+        std::vector<std::pair<IMatter*, IMatter*>> begun;
+
+        std::set_difference(pairs.begin(), pairs.end(), this->colliding_pairs.begin(), this->colliding_pairs.end(),
+            std::back_inserter(ended), unsafe_collision_pair_less);
+        std::set_difference(this->colliding_pairs.begin(), this->colliding_pairs.end(), pairs.begin(), pairs.end(),
+            std::back_inserter(begun), unsafe_collision_pair_less);
+
+        if (!(ended.empty() && begun.empty())) {
+            this->dispatch_collisions(ended, begun);
+        }
+    }
+}
+
+/** NOTE
+ * Matters removed in `on_collision_begin` and `on_collision_end` are not removed until all events are dispatched,
+ *   and then their collisions end as well.
+ * Erasing the plane in a handler stops the dispatching, along with the pending removals.
+ */
+void Plteen::Plane::dispatch_collisions(const std::vector<std::pair<IMatter*, IMatter*>>& ended, const std::vector<std::pair<IMatter*, IMatter*>>& begun) {
+    uint64_t generation = this->erase_generation;
+    bool nested = this->collision_dispatching;
+
+    this->collision_dispatching = true;
+
+    // the plane might be erased by any handler, and then the rest of pairs are dangling
+    for (size_t idx = 0U; (idx < ended.size()) && (generation == this->erase_generation); idx ++) {
+        this->on_collision_end(ended[idx].first, ended[idx].second);
+    }
+
+    for (size_t idx = 0U; (idx < begun.size()) && (generation == this->erase_generation); idx ++) {
+        this->on_collision_begin(begun[idx].first, begun[idx].second);
+    }
+
+    this->collision_dispatching = nested;
+
+    if (!nested) {
+        this->remove_collided_matters();
+    }
+}
+
+void Plteen::Plane::remove_collided_matters() {
+    while (!this->collision_removals.empty()) {
+        std::pair<IMatter*, bool> removal = this->collision_removals.front();
+
+        this->collision_removals.erase(this->collision_removals.begin());
+        this->remove(removal.first, removal.second);
+    }
+}
+
 /*************************************************************************************************/
 void Plteen::Plane::bind_canvas(IMatter* m, Plteen::Tracklet* canvas, const Port& p, bool shared) {
     MatterInfo* info = plane_matter_info(this, m);
@@ -1943,7 +3143,7 @@ void Plteen::Plane::say(ISprite* m, double sec, IMatter* message, SpeechBubble t
                 info->bubble = message;
             }
 
-            bubble_start(m, info, sec, type, this->bubble_second);
+            bubble_start(this->scheduler, m, info, sec, type, this->bubble_second);
         }
     }
 }
@@ -1955,7 +3155,7 @@ void Plteen::Plane::say(ISprite* m, double sec, const std::string& message, cons
         if (message.empty()) {
             this->shh(m);
         } else if (this->merge_bubble_text(info->bubble, message, color)) {
-            bubble_start(m, info, sec, type, this->bubble_second);
+            bubble_start(this->scheduler, m, info, sec, type, this->bubble_second);
         } else {
             this->say(m, sec, this->make_bubble_text(message, color), type);
         }
@@ -2154,7 +3354,9 @@ bool Plteen::IPlane::should_update() {
 }
 
 void Plteen::IPlane::notify_updated(IMatter* m) {
-    if (this->info != nullptr) {
+    if (m != nullptr) {
+        this->notify_matter_updated(m);
+    } else if (this->info != nullptr) {
         this->info->master->notify_updated();
     }
 }
@@ -2244,8 +3446,8 @@ void Plteen::IPlane::create_grid(int row, int col, IMatter* m) {
     MatterInfo* info = plane_matter_info(this, m);
 
     if (info != nullptr) {
-        float x = info->x;
-        float y = info->y;
+        float x = info->x();
+        float y = info->y();
         Box box = m->get_bounding_box();
 
         this->create_grid(row, col, x, y, box.width(), box.height());
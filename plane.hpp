@@ -2,6 +2,7 @@
 
 #include "graphics/dc.hpp"
 #include "graphics/font.hpp"
+#include "graphics/texture.hpp"
 #include "physics/color/rgba.hpp"
 #include "physics/color/names.hpp"
 #include "physics/algebra/point.hpp"
@@ -9,10 +10,14 @@
 #include "physics/geometry/port.hpp"
 #include "physics/geometry/aabox.hpp"
 #include "physics/geometry/margin.hpp"
+#include "physics/geometry/spatial.hpp"
+#include "physics/motion.hpp"
 
 #include "virtualization/screen.hpp"
 #include "virtualization/position.hpp"
 
+#include <functional>
+
 namespace Plteen {
     class __lambda__ IPlaneInfo {
     public:
@@ -24,6 +29,8 @@ namespace Plteen {
     };
 
     struct MatterInfo;
+    struct MatterStates;
+    struct PlaneScheduler;
     class SpeechInfo;
 
     /** Note
@@ -53,6 +60,8 @@ namespace Plteen {
         virtual void load(float Width, float Height) {}
         virtual void reflow(float width, float height) {}
         virtual void update(uint64_t count, uint32_t interval, uint64_t uptime) {}
+        virtual bool is_quiescent(uint64_t uptime, uint64_t* wakeup) { return true; }
+        virtual bool notify_interpolated() { return false; }
         virtual void draw(Plteen::dc_t* dc, float X, float Y, float Width, float Height) {}
     
     public:
@@ -96,7 +105,9 @@ namespace Plteen {
         virtual Plteen::IMatter* get_focused_matter() = 0;
         virtual void set_caret_owner(IMatter* m) = 0;
         virtual void notify_matter_ready(IMatter* m) = 0;
+        virtual void notify_matter_updated(IMatter* m) = 0;
         virtual void notify_matter_timeline_restart(IMatter* m, uint32_t count0, int duration = 0) = 0;
+        virtual void notify_matter_motion_changed(IMatter* m) = 0;
 
     public:
         virtual void shh(ISprite* m) = 0;
@@ -176,6 +187,8 @@ namespace Plteen {
         virtual void on_motion_start(Plteen::IMatter* m, double sec, float x, float y, double xspd, double yspd) {}
         virtual void on_motion_step(Plteen::IMatter* m, float x, float y, double xspd, double yspd, double percentage) {}
         virtual void on_motion_complete(Plteen::IMatter* m, float x, float y, double xspd, double yspd) {}
+        virtual void on_collision_begin(Plteen::IMatter* m, Plteen::IMatter* target) {}
+        virtual void on_collision_end(Plteen::IMatter* m, Plteen::IMatter* target) {}
         
     protected:
         virtual void on_enter(Plteen::IPlane* from);
@@ -264,6 +277,8 @@ namespace Plteen {
         
     public:
         void draw(Plteen::dc_t* renderer, float X, float Y, float Width, float Height) override;
+        bool is_quiescent(uint64_t uptime, uint64_t* wakeup) override;
+        bool notify_interpolated() override;
         
     public:
         bool is_colliding_with_mouse(IMatter* m);
@@ -293,6 +308,15 @@ namespace Plteen {
         void size_cache_invalid();
         void clear_motion_actions(IMatter* m);
 
+    public:
+        void set_collision_layer(IMatter* m, uint32_t layer, uint32_t mask = 0xFFFFFFFFU);
+        uint32_t get_collision_layer(IMatter* m);
+        const std::vector<std::pair<Plteen::IMatter*, Plteen::IMatter*>>& get_colliding_pairs() { return this->colliding_pairs; }
+
+    public:
+        void set_static_matter(IMatter* m, bool yes_or_no = true);
+        void set_static_layer_threshold(uint32_t frames) { this->static_layer_threshold = frames; }
+
     public:
         void bind_canvas(IMatter* m, Plteen::Tracklet* canvas, const Plteen::Port& anchor = 0.5F, bool shared = false);
         void reset_pen(IMatter* m);
@@ -326,12 +350,18 @@ namespace Plteen {
         Plteen::IMatter* get_focused_matter() override;
         void set_caret_owner(IMatter* m) override;
         void notify_matter_ready(IMatter* m) override;
+        void notify_matter_updated(IMatter* m) override;
         void notify_matter_timeline_restart(IMatter* m, uint32_t count0 = 1, int duration = 0) override;
+        void notify_matter_motion_changed(IMatter* m) override;
 
     public:
         void set_matter_fps(IMatter* m, int fps, bool restart = false);
         void set_local_fps(int fps, bool restart = false);
 
+    public:
+        uint64_t schedule_after(uint32_t ms, const std::function<void()>& callback);
+        void cancel_schedule(uint64_t id);
+
     protected:
         void draw_visible_selection(Plteen::dc_t* renderer, float x, float y, float width, float height) override;
         virtual bool update_tooltip(IMatter* m, float local_x, float local_y, float global_x, float global_y) { return false; }
@@ -366,6 +396,8 @@ namespace Plteen {
 
     private:
         void handle_queued_motion(IMatter* m, MatterInfo* info, float dwidth, float dheight);
+        void handle_batched_motions(float dwidth, float dheight);
+        void step_matter(IMatter* m, MatterInfo* info);
         bool move_matter_via_info(IMatter* m, MatterInfo* info, double length, bool ignore_gliding, bool heading);
         bool move_matter_via_info(IMatter* m, MatterInfo* info, const Position& pos, bool absolute, bool ignore_gliding, bool heading);
         bool move_matter_to_location_via_info(IMatter* m, MatterInfo* info, const Position& pos, const Port& p, float dx, float dy);
@@ -382,7 +414,18 @@ namespace Plteen {
         void handle_new_matter(IMatter* m, MatterInfo* info, const Position& pos, const Port& p, float dx, float dy);
         void draw_matter(Plteen::dc_t* renderer, IMatter* self, MatterInfo* info, float X, float Y, float dsX, float dsY, float dsWidth, float dsHeight);
         void draw_speech(Plteen::dc_t* renderer, IMatter* self, MatterInfo* info, float Width, float Height, float X, float Y, float dsX, float dsY, float dsWidth, float dsHeight);
+        bool draw_static_layer(Plteen::dc_t* renderer, float X, float Y, float Width, float Height, IMatter** rest);
+        bool is_matter_static(IMatter* m, MatterInfo* info);
         void recalculate_matters_extent_when_invalid();
+        void recalculate_matters_zorder_when_invalid();
+        void rearrange_matter_states_when_invalid();
+        void dispatch_schedules(uint64_t uptime);
+        void detect_collisions();
+        void forget_collisions(IMatter* m);
+        void dispatch_collisions(const std::vector<std::pair<IMatter*, IMatter*>>& ended, const std::vector<std::pair<IMatter*, IMatter*>>& begun);
+        void remove_collided_matters();
+        void update_matter_index(IMatter* m, MatterInfo* info);
+        void notify_damaged_region(bool partial);
         bool say_goodbye_to_hover_matter(uint32_t state, float x, float y, float dx, float dy);
         bool is_matter_found(IMatter* m, MatterInfo* info, const Dot& dot);
         Plteen::IMatter* find_matter_for_tooltip(const Plteen::Dot& pos);
@@ -393,8 +436,39 @@ namespace Plteen {
 
     private:
         Plteen::Box extent;
+        Plteen::Box damaged_region;
+        SDL_Rect redraw_clip;
+        bool redraw_partially = false;
+        float interpolation_alpha = 1.0F;
+
+    private:
+        Plteen::shared_texture_t static_layer;
+        Plteen::RGBA static_layer_background;
+        Plteen::RGBA static_layer_grid_color;
+        size_t static_layer_size = 0U;
+        uint32_t static_layer_threshold = 0U;
+        bool static_layer_dirty = true;
+
+    private:
+        Plteen::SpatialGrid<Plteen::IMatter> spatial_index;
+        std::vector<Plteen::IMatter*> spatial_candidates;
+        std::vector<Plteen::IMatter*> selection_hits;
+        uint32_t zorder_top = 0U;
+        bool zorder_invalid = false;
+
+    private:
+        std::vector<Plteen::IMatter*> collision_sweep;
+        std::vector<std::pair<Plteen::IMatter*, Plteen::IMatter*>> colliding_pairs;
+        std::vector<std::pair<Plteen::IMatter*, bool>> collision_removals;
+        uint64_t collision_ticket = 0U;
+        bool collision_dispatching = false;
 
     private:
+        Plteen::MatterStates* states = nullptr;
+        Plteen::PlaneScheduler* scheduler = nullptr;
+        Plteen::MotionBatch motion_batch;
+        std::vector<size_t> motion_slots;
+        uint64_t erase_generation = 0U; // bumped by `erase`, things kept over events are invalid since then
         Plteen::IMatter* head_matter = nullptr;
         Plteen::IMatter* head_speech = nullptr;
         Plteen::IMatter* focused_matter = nullptr;
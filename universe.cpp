@@ -2,10 +2,12 @@
 #include "misc.hpp"
 
 #include "graphics/image.hpp"
+#include "virtualization/filesystem/imgdb.hpp"
 #include "physics/color/rgba.hpp"
 #include "physics/color/names.hpp"
 
 #include "datum/string.hpp"
+#include "datum/flonum.hpp"
 #include "datum/box.hpp"
 #include "datum/time.hpp"
 
@@ -71,6 +73,27 @@ static unsigned int trigger_timer_event(unsigned int interval, void* datum) {
     return interval;
 }
 
+/**
+ * 计算无事可做时的等待时长
+ * @param wakeup, 下次唤醒的在线时间，以 ms 为单位，以 SDL_GetTicks64() 为准，0 表示只等用户交互事件
+ * @return 返回 SDL_WaitEventTimeout 的等待时长，-1 表示一直等下去
+ **/
+static int quiescent_timeout(uint64_t wakeup) {
+    int timeout = -1;
+
+    if (wakeup > 0U) {
+        uint64_t now = SDL_GetTicks64();
+
+        if (wakeup <= now) {
+            timeout = 0;
+        } else if (wakeup - now < uint64_t(INT32_MAX)) {
+            timeout = int(wakeup - now);
+        }
+    }
+
+    return timeout;
+}
+
 /*************************************************************************************************/
 static void game_initialize(uint32_t flags) {
     Call_With_Safe_Exit(SDL_Init(flags), "SDL 初始化失败: ", SDL_Quit, SDL_GetError);
@@ -190,8 +213,11 @@ void Plteen::IUniverse::big_bang() {
     uint32_t quit_time = 0UL;           // 游戏退出时的在线时间
     timer_parcel_t parcel;              // 时间轴包裹
     SDL_Event e;                        // SDL 事件
+    bool fixed = (this->fixed_timestep && (this->_fps > 0));
+    bool idle = false;                  // 是否无事可做
+    uint64_t wakeup = 0U;               // 无事可做时，下次唤醒的在线时间
     
-    if (this->_fps > 0) {
+    if ((this->_fps > 0) && !fixed) {
         parcel.universe = this;
         parcel.interval = 1000 / this->_fps;
 
@@ -208,56 +234,239 @@ void Plteen::IUniverse::big_bang() {
     this->notify_updated();
     this->end_update_sequence();
 
+    if (fixed) {
+        this->prepare_fixed_timestep();
+    }
+
     /* 游戏主循环 */
     while ((quit_time == 0UL) && !this->can_exit()) {
-        if (SDL_WaitEvent(&e)) {        // 处理用户交互事件, SDL_PollEvent 多占用 4-7% CPU
+        if (idle) {
+            /* 无事可做，定时器已停止，等待用户交互事件或者下次唤醒 */
+            bool has_event = (SDL_WaitEventTimeout(&e, quiescent_timeout(wakeup)) == 1);
+
+            idle = false;
+
+            if (fixed) {
+                this->resume_fixed_timestep();
+            } else {
+                SDL_TimerID timer = 0;
+
+                Call_For_Variable(timer,
+                    SDL_AddTimer(parcel.interval, trigger_timer_event, reinterpret_cast<void*>(&parcel)),
+                    0, "定时器创建失败: ", SDL_GetError);
+                this->timer = timer;
+            }
+
+            if (has_event) {
+                this->begin_update_sequence();
+                this->dispatch_event(e, &quit_time);
+                this->end_update_sequence();
+            }
+        } else if (fixed) {
+            /* 等待用户交互事件，直到下一步到期为止 */
+            bool has_event = (SDL_WaitEventTimeout(&e, this->fixed_timestep_timeout()) == 1);
+            bool stepped = false;
+
             this->begin_update_sequence();
 
-            switch (e.type) {
-            case SDL_USEREVENT: {       // 定时器到期通知，更新游戏
-                auto parcel = reinterpret_cast<timer_parcel_t*>(e.user.data1);
-
-                if (parcel->universe == this) {
-                    /** TODO
-                     * Is SDL2 really pumping duplicate events?
-                     * Why the first `count` is much larger then 1?
-                     */
-                    if (parcel->last_timestamp != parcel->uptime) {
-                        this->on_elapse(parcel->count, parcel->interval, parcel->uptime);
-                        parcel->last_timestamp = parcel->uptime;
+            if (has_event) {
+                this->dispatch_event(e, &quit_time);
+            }
+
+            if (quit_time == 0UL) {
+                stepped = this->do_fixed_timesteps();
+
+                if (stepped && this->idle_pacing) {
+                    wakeup = 0U;
+                    idle = this->is_quiescent(this->fixed_timestep_uptime(), &wakeup) && (imgdb_pending_count() == 0U);
+
+                    if (idle && (wakeup > 0U)) {
+                        /* 唤醒时间以模拟的在线时间计，换算到 quiescent_timeout 所用的时钟上 */
+                        uint64_t uptime = this->fixed_timestep_uptime();
+                        uint64_t now = SDL_GetTicks64();
+
+                        wakeup = ((wakeup > uptime) ? (now + (wakeup - uptime)) : now);
                     }
                 }
-            }; break;
-            case SDL_MOUSEMOTION: this->on_mouse_event(e.motion); break;
-            case SDL_MOUSEWHEEL: this->on_mouse_event(e.wheel); break;
-            case SDL_MOUSEBUTTONUP: this->on_mouse_event(e.button, false); break;
-            case SDL_MOUSEBUTTONDOWN: this->on_mouse_event(e.button, true);  break;
-            case SDL_KEYUP: this->on_keyboard_event(e.key, false); break;
-            case SDL_KEYDOWN: this->on_keyboard_event(e.key, true); break;
-            case SDL_TEXTINPUT: this->on_user_input(e.text.text); break;
-            case SDL_TEXTEDITING: this->on_editing(e.edit.text, e.edit.start, e.edit.length); break;
-            case SDL_WINDOWEVENT: {
-                switch (e.window.event) {
-                    case SDL_WINDOWEVENT_RESIZED: this->on_resize(e.window.data1, e.window.data2); break;
+
+                if (this->timestep_interpolating) {
+                    this->do_interpolation(idle);
                 }
-            }; break;
-            case SDL_QUIT: {
-                if (this->timer > 0UL) {
-                    SDL_RemoveTimer(this->timer); // 停止定时器
+            }
+
+            this->end_update_sequence();
+        } else if (SDL_WaitEvent(&e)) { // 处理用户交互事件, SDL_PollEvent 多占用 4-7% CPU
+            this->begin_update_sequence();
+            this->dispatch_event(e, &quit_time);
+            this->end_update_sequence();
+
+            if (this->idle_pacing && (e.type == SDL_USEREVENT) && (this->timer > 0) && (quit_time == 0UL)) {
+                wakeup = 0U;
+                idle = this->is_quiescent(SDL_GetTicks64(), &wakeup) && (imgdb_pending_count() == 0U);
+
+                if (idle) {
+                    SDL_RemoveTimer(this->timer);
                     this->timer = 0;
                 }
-
-                quit_time = e.quit.timestamp;
-            }; break;
             }
-   
-            this->end_update_sequence();
         } else {
             this->log_message(Log::Error, make_nstring("failed to pop the event: %s", SDL_GetError()));
         }
     }
 }
 
+void Plteen::IUniverse::dispatch_event(SDL_Event& e, uint32_t* quit_time) {
+    switch (e.type) {
+    case SDL_USEREVENT: {       // 定时器到期通知，更新游戏
+        auto parcel = reinterpret_cast<timer_parcel_t*>(e.user.data1);
+
+        if (parcel->universe == this) {
+            /** TODO
+             * Is SDL2 really pumping duplicate events?
+             * Why the first `count` is much larger then 1?
+             */
+            if (parcel->last_timestamp != parcel->uptime) {
+                imgdb_upload(this->image_upload_budget);
+                this->on_elapse(parcel->count, parcel->interval, parcel->uptime);
+                parcel->last_timestamp = parcel->uptime;
+            }
+        }
+    }; break;
+    case SDL_MOUSEMOTION: this->on_mouse_event(e.motion); break;
+    case SDL_MOUSEWHEEL: this->on_mouse_event(e.wheel); break;
+    case SDL_MOUSEBUTTONUP: this->on_mouse_event(e.button, false); break;
+    case SDL_MOUSEBUTTONDOWN: this->on_mouse_event(e.button, true);  break;
+    case SDL_KEYUP: this->on_keyboard_event(e.key, false); break;
+    case SDL_KEYDOWN: this->on_keyboard_event(e.key, true); break;
+    case SDL_TEXTINPUT: this->on_user_input(e.text.text); break;
+    case SDL_TEXTEDITING: this->on_editing(e.edit.text, e.edit.start, e.edit.length); break;
+    case SDL_WINDOWEVENT: {
+        switch (e.window.event) {
+            case SDL_WINDOWEVENT_RESIZED: this->on_resize(e.window.data1, e.window.data2); break;
+        }
+    }; break;
+    case SDL_QUIT: {
+        if (this->timer > 0UL) {
+            SDL_RemoveTimer(this->timer); // 停止定时器
+            this->timer = 0;
+        }
+
+        (*quit_time) = e.quit.timestamp;
+    }; break;
+    }
+}
+
+/*************************************************************************************************/
+void Plteen::IUniverse::set_fixed_timestep(bool yes, uint32_t max_catchup, bool interpolating) {
+    this->fixed_timestep = yes;
+    this->max_catchup_steps = ((max_catchup > 0U) ? max_catchup : 1U);
+    this->timestep_interpolating = interpolating;
+}
+
+void Plteen::IUniverse::set_idle_pacing(bool yes) {
+    this->idle_pacing = yes;
+}
+
+void Plteen::IUniverse::set_image_upload_budget(size_t budget) {
+    this->image_upload_budget = ((budget > 0U) ? budget : 1U);
+}
+
+void Plteen::IUniverse::prepare_fixed_timestep() {
+    SDL_DisplayMode mode;
+
+    this->timestep_interval = 1000 / this->_fps;
+    this->interpolation_interval = this->timestep_interval;
+
+    if (this->timestep_interpolating) {
+        if ((SDL_GetWindowDisplayMode(this->window, &mode) == 0) && (mode.refresh_rate > 0) && (mode.refresh_rate <= 1000)) {
+            this->interpolation_interval = 1000U / uint32_t(mode.refresh_rate);
+        }
+    }
+
+    this->timestep_ticks = SDL_GetPerformanceFrequency() / this->_fps;
+    this->timestep_count = 0U;
+    this->timestep_epoch = SDL_GetTicks64();
+    this->next_timestep = SDL_GetPerformanceCounter() + this->timestep_ticks;
+}
+
+void Plteen::IUniverse::resume_fixed_timestep() {
+    uint64_t now = SDL_GetTicks64();
+    uint64_t elapsed = this->timestep_count * 1000U / this->_fps;
+
+    /* the idle time is skipped rather than caught up, but the simulated uptime still follows the clock */
+    this->timestep_epoch = ((now > elapsed) ? (now - elapsed) : 0U);
+    this->next_timestep = SDL_GetPerformanceCounter();
+}
+
+uint64_t Plteen::IUniverse::fixed_timestep_uptime() {
+    return this->timestep_epoch + this->timestep_count * 1000U / this->_fps;
+}
+
+int Plteen::IUniverse::fixed_timestep_timeout() {
+    uint64_t now = SDL_GetPerformanceCounter();
+    int timeout = 0;
+
+    if (now < this->next_timestep) {
+        uint64_t frequency = SDL_GetPerformanceFrequency();
+
+        /* 向上取整，免得醒得太早白跑一趟 */
+        timeout = int(((this->next_timestep - now) * 1000U + frequency - 1U) / frequency);
+
+        /* 有物体仍在两步之间移动时，按显示器刷新率插值绘制 */
+        if (this->timestep_moving && (timeout > int(this->interpolation_interval))) {
+            timeout = int(this->interpolation_interval);
+        }
+    }
+
+    return timeout;
+}
+
+/** NOTE
+ * The simulation always advances `timestep_interval` per step, no matter how late the steps are,
+ *   so that the gameplay speed does not depend on the timer.
+ * Too many overdue steps are dropped rather than caught up,
+ *   otherwise a slow frame makes the next one even slower.
+ */
+bool Plteen::IUniverse::do_fixed_timesteps() {
+    uint64_t now = SDL_GetPerformanceCounter();
+    uint32_t steps = 0U;
+
+    if (now >= this->next_timestep) {
+        imgdb_upload(this->image_upload_budget);
+    }
+
+    while ((now >= this->next_timestep) && (steps < this->max_catchup_steps)) {
+        this->timestep_count += 1U;
+        this->on_elapse(this->timestep_count, this->timestep_interval, this->fixed_timestep_uptime());
+        this->next_timestep += this->timestep_ticks;
+        steps += 1U;
+    }
+
+    if (now >= this->next_timestep) {
+        this->next_timestep = now + this->timestep_ticks;
+    }
+
+    return (steps > 0U);
+}
+
+/** NOTE
+ * The alpha is taken from the remainder of the current step at the time of drawing,
+ *   and only matters still moving between the last two steps are redrawn,
+ *   other damaged regions are tracked as usual.
+ * Before going idle, the latest states are drawn as is.
+ */
+void Plteen::IUniverse::do_interpolation(bool settled) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    double alpha = 1.0;
+
+    if (!settled && (now < this->next_timestep)) {
+        alpha = 1.0 - double(this->next_timestep - now) / double(this->timestep_ticks);
+    }
+
+    this->set_interpolation_alpha(float(flmax(alpha, 0.0)));
+    this->timestep_moving = this->notify_interpolated();
+}
+
 void Plteen::IUniverse::on_mouse_event(SDL_MouseButtonEvent &mouse, bool pressed) {
     if (!pressed) {
         if (mouse.clicks == 1) {
@@ -517,7 +726,28 @@ void Plteen::IUniverse::set_window_fullscreen(bool yes) {
 }
 
 void Plteen::IUniverse::refresh() {
-    this->do_redraw(this->device, 0, 0, this->window_width, this->window_height);
+    Box region;
+
+    if (this->feed_damaged_region(&region)) {
+        SDL_Rect clip;
+
+        clip.x = fl2fxi(flfloor(region.ltdot.x));
+        clip.y = fl2fxi(flfloor(region.ltdot.y));
+        clip.w = fl2fxi(flceiling(region.rbdot.x)) - clip.x;
+        clip.h = fl2fxi(flceiling(region.rbdot.y)) - clip.y;
+
+        /** NOTE
+         * The `texture` keeps the last frame,
+         *   so only the damaged region needs redrawing,
+         *   and the renderer will reject everything outside.
+         */
+        this->device->set_clipping_region(&clip);
+        this->do_redraw(this->device, 0, 0, this->window_width, this->window_height);
+        this->device->clear_clipping_region();
+    } else {
+        this->do_redraw(this->device, 0, 0, this->window_width, this->window_height);
+    }
+
     this->device->refresh(this->texture);
 }
 
@@ -22,6 +22,15 @@ namespace Plteen {
         /* 宇宙大爆炸，开始游戏主循环 */
         void big_bang();
 
+        /* 以固定步长更新游戏世界，落后时每次最多追赶 max_catchup 步，interpolating 表示在两步之间按显示器刷新率插值绘制移动中的物体，需在大爆炸之前设置 */
+        void set_fixed_timestep(bool yes, uint32_t max_catchup = 5U, bool interpolating = false);
+
+        /* 游戏世界无事可做时停止定时器，直到用户交互或者下次唤醒，需在大爆炸之前设置；Plane 默认只看其中的物体是否无事可做，在自己的 update 中做动画的 Plane 须改写 is_quiescent */
+        void set_idle_pacing(bool yes);
+
+        /* 每帧最多上传多少张后台解码好的图片，免得一次上传太多卡住画面 */
+        void set_image_upload_budget(size_t budget);
+
     public:
         /* 创建游戏世界，充当程序真正的 main 函数 */
         virtual void construct(int argc, char* argv[]) = 0;
@@ -38,6 +47,12 @@ namespace Plteen {
         /* 告诉游戏主循环，是否游戏已经结束可以退出了，默认永久运行 */
         virtual bool can_exit() { return false; }
 
+        /* 告诉游戏主循环，是否游戏世界暂时无事可做，wakeup 用以告知下次需要检查的在线时间，默认总是有事 */
+        virtual bool is_quiescent(uint64_t uptime, uint64_t* wakeup) { return false; }
+
+        /* 在两步之间绘制之前，告诉游戏世界标记需要插值绘制的区域，返回是否有物体仍在两步之间移动，默认没有 */
+        virtual bool notify_interpolated() { return false; }
+
     public: // 常规操作
         void set_snapshot_folder(const char* path);
         void set_snapshot_folder(const std::string& path);
@@ -117,6 +132,13 @@ namespace Plteen {
         virtual void save_file(bool is_save_as);
 
     private:
+        void dispatch_event(SDL_Event& e, uint32_t* quit_time);
+        void prepare_fixed_timestep();
+        void resume_fixed_timestep();
+        uint64_t fixed_timestep_uptime();
+        int fixed_timestep_timeout();
+        bool do_fixed_timesteps();
+        void do_interpolation(bool settled);
         void do_redraw(Plteen::dc_t* renderer, int x, int y, int width, int height);
         bool display_usr_input_and_caret(Plteen::dc_t* renderer, bool yes);
         bool display_usr_message(Plteen::dc_t* renderer);
@@ -134,8 +156,22 @@ namespace Plteen {
         SDL_Texture* texture = nullptr;      // 纹理对象
 
     private:
-        SDL_TimerID timer;                   // SDL 定时器
+        SDL_TimerID timer = 0;               // SDL 定时器
         uint32_t _fps;                       // 帧频
+        bool idle_pacing = false;            // 是否在无事可做时停止定时器
+        size_t image_upload_budget = 8U;     // 每帧最多上传的图片数
+
+    private:
+        bool fixed_timestep = false;         // 是否以固定步长更新
+        bool timestep_interpolating = false; // 是否在最近两步之间插值绘制
+        bool timestep_moving = false;        // 是否有物体仍在最近两步之间移动
+        uint32_t interpolation_interval = 0U;// 插值绘制的间隔，以 ms 为单位
+        uint32_t max_catchup_steps = 0U;     // 每次最多追赶的步数
+        uint32_t timestep_interval = 0U;     // 步长，以 ms 为单位
+        uint64_t timestep_ticks = 0U;        // 步长，以性能计数器为单位
+        uint64_t next_timestep = 0U;         // 下一步到期的时刻
+        uint64_t timestep_count = 0U;        // 已经走过的步数
+        uint64_t timestep_epoch = 0U;        // 第一步的在线时间
 
     private:
         const char* current_usrin = nullptr; // IME 原始输入
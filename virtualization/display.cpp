@@ -21,14 +21,41 @@ bool Plteen::IDisplay::save_snapshot(const char* pname) {
 
 /*************************************************************************************************/
 void Plteen::IDisplay::notify_updated() {
+    this->entirely_damaged = true;
+
+    if (this->is_in_update_sequence()) {
+        this->update_is_needed = true;
+    } else {
+        this->do_refresh();
+    }
+}
+
+void Plteen::IDisplay::notify_updated(const Box& region) {
+    this->damaged_region += region;
+
     if (this->is_in_update_sequence()) {
         this->update_is_needed = true;
     } else {
-        this->refresh();
-        this->update_is_needed = false;
+        this->do_refresh();
     }
 }
 
+/** NOTE
+ * Returns `false` if the whole display should be redrawn,
+ *   say, someone notified without a region, or someone invoked `refresh()` directly.
+ */
+bool Plteen::IDisplay::feed_damaged_region(Box* region) {
+    bool partial = !this->entirely_damaged
+                    && (this->damaged_region.ltdot.x <= this->damaged_region.rbdot.x)
+                    && (this->damaged_region.ltdot.y <= this->damaged_region.rbdot.y);
+
+    if (partial) {
+        (*region) = this->damaged_region;
+    }
+
+    return partial;
+}
+
 void Plteen::IDisplay::end_update_sequence() {
     this->update_sequence_depth -= 1;
 
@@ -36,8 +63,14 @@ void Plteen::IDisplay::end_update_sequence() {
         this->update_sequence_depth = 0;
 
         if (this->should_update()) {
-            this->refresh();
-            this->update_is_needed = false;
+            this->do_refresh();
         }
     }
 }
+
+void Plteen::IDisplay::do_refresh() {
+    this->refresh();
+    this->update_is_needed = false;
+    this->entirely_damaged = false;
+    this->damaged_region.invalidate();
+}
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "../graphics/dc.hpp"
+#include "../physics/geometry/aabox.hpp"
 #include "../forward.hpp"
 
 /**************************************************************************************************/
@@ -31,13 +32,31 @@ namespace Plteen {
         void end_update_sequence();
         bool should_update() { return this->update_is_needed; }
         void notify_updated();
+        void notify_updated(const Plteen::Box& region);
+        bool feed_damaged_region(Plteen::Box* region);
+
+    public:
+        /** NOTE
+         * How far the display is between the last two simulation steps,
+         *   `1.0` means drawing the latest states as is.
+         */
+        float get_interpolation_alpha() { return this->interpolation_alpha; }
 
     public:
         bool save_snapshot(const std::string& path);
         bool save_snapshot(const char* path);
 
+    protected:
+        void set_interpolation_alpha(float alpha) { this->interpolation_alpha = alpha; }
+
+    private:
+        void do_refresh();
+
     private:
         int update_sequence_depth = 0;
         bool update_is_needed = false;
+        bool entirely_damaged = false;
+        Plteen::Box damaged_region;
+        float interpolation_alpha = 1.0F;
     };
 }
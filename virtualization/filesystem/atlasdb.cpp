@@ -0,0 +1,428 @@
+#include "atlasdb.hpp"
+#include "imgdb.hpp"
+
+#include "../../graphics/image.hpp"
+#include "../../graphics/packer.hpp"
+
+#include "../../datum/string.hpp"
+#include "../../datum/path.hpp"
+#include "../../datum/fixnum.hpp"
+#include "../../datum/hash.hpp"
+
+#include <unordered_map>
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <atomic>
+#include <thread>
+
+using namespace Plteen;
+using namespace std::filesystem;
+
+/*************************************************************************************************/
+namespace Plteen {
+    struct AtlasEntry {
+        std::string name;
+        std::string pathname;
+        SDL_Surface* image = nullptr;
+        size_t page = 0U;
+        SDL_Rect region = {};
+    };
+}
+
+static const int ATLAS_MAX_SIZE = 2048;
+static const int ATLAS_PADDING = 1;
+static const char* ATLAS_MAGIC = "plteen-atlas";
+static const int ATLAS_VERSION = 2;
+
+static std::map<std::string, std::unordered_map<SDL_Renderer*, shared_texture_pack_t>> packs;
+static std::string atlasdb_cachedir;
+
+/*************************************************************************************************/
+static inline bool is_atlas_image(const std::string& pathname) {
+    return string_suffix(pathname, ".png") || string_suffix(pathname, ".svg");
+}
+
+static inline void stamp_entry(const directory_entry& entry, uint64_t& digest, size_t& count) {
+    std::error_code ec;
+    std::string pathname = entry.path().string();
+    file_time_type t = entry.last_write_time(ec);
+    int64_t mtime = (ec ? 0 : int64_t(t.time_since_epoch().count()));
+    uintmax_t size = (entry.is_regular_file(ec) ? entry.file_size(ec) : 0U);
+    uint64_t hash = fnv1a_hash(pathname);
+
+    hash = fnv1a_hash(&mtime, sizeof(mtime), hash);
+    hash = fnv1a_hash(&size, sizeof(size), hash);
+
+    // summed up, since directories are not listed in any particular order
+    digest += hash;
+    count ++;
+}
+
+/**
+ * Modifying a file does not touch the mtime of its folder,
+ *   so the stamp digests the path, mtime, and size of everything inside, along with the number of entries,
+ *   and the path of the folder itself, in case two folders share the same cache name.
+ */
+static std::string scan_folder(const std::string& abspath, std::vector<AtlasEntry>& entries) {
+    uint64_t digest = fnv1a_hash(abspath);
+    size_t count = 0U;
+
+    stamp_entry(directory_entry(abspath), digest, count);
+
+    for (auto entry : directory_iterator(abspath)) {
+        if (entry.is_regular_file()) {
+            std::string pathname = entry.path().string();
+            std::string name = file_basename_from_path(pathname);
+
+            stamp_entry(entry, digest, count);
+
+            if (!name.empty() && is_atlas_image(pathname)) { // ignore dot files
+                entries.push_back({ name, pathname });
+            }
+        } else if (entry.is_directory()) {
+            std::string d_name = file_basename_from_path(entry.path().string());
+
+            stamp_entry(entry, digest, count);
+
+            if (!d_name.empty()) {
+                for (auto subentry : directory_iterator(entry)) {
+                    if (subentry.is_regular_file()) {
+                        std::string pathname = subentry.path().string();
+                        std::string c_name = file_basename_from_path(pathname);
+
+                        stamp_entry(subentry, digest, count);
+
+                        if (!c_name.empty() && is_atlas_image(pathname)) {
+                            entries.push_back({ d_name + "/" + c_name, pathname });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return make_nstring("%016llx:%zu", (unsigned long long)(digest), count);
+}
+
+/**
+ * The cache lives in the per-user data directory by default rather than the shared temporary one,
+ *   and `""` means no cache available.
+ */
+static inline std::string cache_basepath(const std::string& abspath) {
+    std::string rootdir = atlasdb_cachedir;
+
+    if (rootdir.empty()) {
+        char* prefdir = SDL_GetPrefPath("plteen", "atlas");
+
+        if (prefdir != nullptr) {
+            rootdir = directory_path(prefdir);
+            SDL_free(prefdir);
+        }
+    }
+
+    return rootdir.empty() ? rootdir : (rootdir + make_nstring("%016llx", (unsigned long long)(fnv1a_hash(abspath))));
+}
+
+static inline std::string cache_page_path(const std::string& basepath, size_t idx) {
+    return basepath + make_nstring(".%zu.png", idx);
+}
+
+static inline int atlas_max_size(SDL_Renderer* renderer) {
+    SDL_RendererInfo info;
+    int size = ATLAS_MAX_SIZE;
+
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        if (info.max_texture_width > 0) {
+            size = fxmin(size, info.max_texture_width);
+        }
+
+        if (info.max_texture_height > 0) {
+            size = fxmin(size, info.max_texture_height);
+        }
+    }
+
+    return size;
+}
+
+static inline shared_texture_t atlas_texture(SDL_Texture* texture) {
+    if (texture != nullptr) {
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+
+    return std::make_shared<Texture>(texture);
+}
+
+/* decoding is independent of each other, hence all cores */
+static void decode_entries(std::vector<AtlasEntry>& entries) {
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0U);
+    size_t n = std::thread::hardware_concurrency();
+
+    n = ((n > 0U) ? n : 1U);
+    n = ((n < entries.size()) ? n : entries.size());
+
+    for (size_t idx = 0U; idx < n; idx ++) {
+        workers.push_back(std::thread([&]() {
+            for (size_t i = next ++; i < entries.size(); i = next ++) {
+                entries[i].image = IMG_Load(entries[i].pathname.c_str());
+            }
+        }));
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/*************************************************************************************************/
+static shared_texture_pack_t load_cached_pack(SDL_Renderer* renderer, const std::string& basepath, const std::string& stamp, bool async) {
+    std::ifstream index(basepath + ".atlas");
+    shared_texture_pack_t pack = nullptr;
+
+    if (index.is_open()) {
+        std::string magic, cached_stamp;
+        int version = 0;
+        size_t page_count = 0U;
+
+        index >> magic >> version >> cached_stamp >> page_count;
+
+        if (index && (magic == ATLAS_MAGIC) && (version == ATLAS_VERSION) && (cached_stamp == stamp)) {
+            pack = std::make_shared<TexturePack>();
+
+            for (size_t idx = 0; (pack != nullptr) && (idx < page_count); idx ++) {
+                shared_texture_t atlas = async
+                    ? imgdb_load_async(cache_page_path(basepath, idx), renderer)
+                    : atlas_texture(game_load_image(renderer, cache_page_path(basepath, idx)));
+
+                if (atlas->okay() || imgdb_pending(atlas)) {
+                    pack->atlases.push_back(atlas);
+                } else {
+                    pack = nullptr;
+                }
+            }
+
+            while ((pack != nullptr) && index) {
+                size_t page;
+                SDL_Rect region;
+                std::string name;
+
+                if ((index >> page >> region.x >> region.y >> region.w >> region.h) && std::getline(index >> std::ws, name)) {
+                    if (page < page_count) {
+                        pack->regions[name] = { pack->atlases[page], region };
+                    } else {
+                        pack = nullptr;
+                    }
+                }
+            }
+        }
+    }
+
+    return pack;
+}
+
+static void save_cached_pack(const std::string& basepath, const std::string& stamp,
+        const std::vector<SDL_Surface*>& pages, const std::vector<AtlasEntry>& entries) {
+    bool okay = true;
+
+    for (size_t idx = 0; okay && (idx < pages.size()); idx ++) {
+        okay = game_save_image(pages[idx], cache_page_path(basepath, idx));
+    }
+
+    if (okay) {
+        std::ofstream index(basepath + ".atlas");
+
+        if (index.is_open()) {
+            index << ATLAS_MAGIC << " " << ATLAS_VERSION << " " << stamp << std::endl;
+            index << pages.size() << std::endl;
+
+            for (auto& e : entries) {
+                if (e.image != nullptr) {
+                    index << e.page << " " << e.region.x << " " << e.region.y << " "
+                          << e.region.w << " " << e.region.h << " " << e.name << std::endl;
+                }
+            }
+        }
+    }
+}
+
+static shared_texture_pack_t pack_folder(SDL_Renderer* renderer, const std::string& basepath,
+        const std::string& stamp, std::vector<AtlasEntry>& entries) {
+    shared_texture_pack_t pack = std::make_shared<TexturePack>();
+    std::vector<SkylinePacker> packers;
+    std::vector<SDL_Surface*> pages;
+    int size = atlas_max_size(renderer);
+
+    decode_entries(entries);
+
+    /* higher ones first, which is the best order for the skyline packer */
+    std::sort(entries.begin(), entries.end(), [](const AtlasEntry& lhs, const AtlasEntry& rhs) {
+        int lh = (lhs.image == nullptr) ? 0 : lhs.image->h;
+        int rh = (rhs.image == nullptr) ? 0 : rhs.image->h;
+        int lw = (lhs.image == nullptr) ? 0 : lhs.image->w;
+        int rw = (rhs.image == nullptr) ? 0 : rhs.image->w;
+
+        return (lh > rh) || ((lh == rh) && ((lw > rw) || ((lw == rw) && (lhs.name < rhs.name))));
+    });
+
+    for (auto& e : entries) {
+        if (e.image != nullptr) {
+            int w = e.image->w + ATLAS_PADDING;
+            int h = e.image->h + ATLAS_PADDING;
+            bool packed = false;
+
+            for (size_t idx = 0; (!packed) && (idx < packers.size()); idx ++) {
+                if (packers[idx].pack(w, h, &e.region)) {
+                    e.page = idx;
+                    packed = true;
+                }
+            }
+
+            if (!packed) { // images larger than the atlas occupy pages of their own
+                packers.push_back(SkylinePacker(fxmax(w, size), fxmax(h, size)));
+                packers.back().pack(w, h, &e.region);
+                e.page = packers.size() - 1U;
+            }
+
+            e.region.w = e.image->w;
+            e.region.h = e.image->h;
+        }
+    }
+
+    for (auto& packer : packers) {
+        pages.push_back(game_formatted_surface(packer.used_width(), packer.used_height(), SDL_PIXELFORMAT_RGBA32));
+    }
+
+    for (auto& e : entries) {
+        if (e.image != nullptr) {
+            SDL_Surface* page = pages[e.page];
+
+            if (page != nullptr) {
+                SDL_SetSurfaceBlendMode(e.image, SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(e.image, nullptr, page, &e.region);
+            }
+        }
+    }
+
+    for (auto page : pages) {
+        pack->atlases.push_back(atlas_texture((page == nullptr) ? nullptr : SDL_CreateTextureFromSurface(renderer, page)));
+    }
+
+    for (auto& e : entries) {
+        if ((e.image != nullptr) && pack->atlases[e.page]->okay()) {
+            pack->regions[e.name] = { pack->atlases[e.page], e.region };
+        }
+    }
+
+    if (!basepath.empty() && (std::find(pages.begin(), pages.end(), nullptr) == pages.end())) {
+        save_cached_pack(basepath, stamp, pages, entries);
+    }
+
+    for (auto page : pages) {
+        if (page != nullptr) {
+            SDL_FreeSurface(page);
+        }
+    }
+
+    for (auto& e : entries) {
+        if (e.image != nullptr) {
+            SDL_FreeSurface(e.image);
+            e.image = nullptr;
+        }
+    }
+
+    return pack;
+}
+
+/** NOTE
+ * Only cached pages can be decoded asynchronously,
+ *   packing is done synchronously anyway, which happens only once after the folder is modified.
+ */
+static shared_texture_pack_t atlasdb_load(SDL_Renderer* renderer, const std::string& abspath, bool async) {
+    std::vector<AtlasEntry> entries;
+    std::string stamp = scan_folder(abspath, entries);
+    std::string basepath = cache_basepath(abspath);
+    shared_texture_pack_t pack = nullptr;
+
+    if (!basepath.empty()) {
+        pack = load_cached_pack(renderer, basepath, stamp, async);
+    }
+
+    if (pack == nullptr) {
+        pack = pack_folder(renderer, basepath, stamp, entries);
+    }
+
+    return pack;
+}
+
+static shared_texture_pack_t atlasdb_ref(const std::string& dirpath, SDL_Renderer* renderer, bool async) {
+    std::string abspath = imgdb_absolute_path(dirpath);
+    shared_texture_pack_t pack = nullptr;
+    auto shared_packs = packs.find(abspath);
+
+    if (shared_packs != packs.end()) {
+        auto it = shared_packs->second.find(renderer);
+
+        if (it != shared_packs->second.end()) {
+            pack = it->second;
+        }
+    }
+
+    if ((pack == nullptr) && is_directory(abspath)) {
+        pack = atlasdb_load(renderer, abspath, async);
+        packs[abspath][renderer] = pack;
+    }
+
+    return pack;
+}
+
+/*************************************************************************************************/
+void Plteen::atlasdb_setup(const char* cache_rootdir) {
+    if (cache_rootdir != nullptr) {
+        atlasdb_cachedir = directory_path(cache_rootdir);
+    }
+}
+
+void Plteen::atlasdb_setup(const std::string& cache_rootdir) {
+    atlasdb_setup(cache_rootdir.c_str());
+}
+
+void Plteen::atlasdb_teardown() {
+    packs.clear();
+}
+
+shared_texture_pack_t Plteen::atlasdb_ref(const char* dirpath, SDL_Renderer* renderer) {
+    return atlasdb_ref(std::string(dirpath), renderer);
+}
+
+shared_texture_pack_t Plteen::atlasdb_ref(const std::string& dirpath, SDL_Renderer* renderer) {
+    shared_texture_pack_t pack = atlasdb_ref(dirpath, renderer, false);
+
+    if (pack != nullptr) {
+        for (auto& atlas : pack->atlases) {
+            imgdb_load_pending(atlas);
+        }
+    }
+
+    return pack;
+}
+
+shared_texture_pack_t Plteen::atlasdb_ref_async(const char* dirpath, SDL_Renderer* renderer) {
+    return atlasdb_ref_async(std::string(dirpath), renderer);
+}
+
+shared_texture_pack_t Plteen::atlasdb_ref_async(const std::string& dirpath, SDL_Renderer* renderer) {
+    return atlasdb_ref(dirpath, renderer, true);
+}
+
+void Plteen::atlasdb_remove(const char* dirpath) {
+    atlasdb_remove(std::string(dirpath));
+}
+
+void Plteen::atlasdb_remove(const std::string& dirpath) {
+    auto pack = packs.find(imgdb_absolute_path(dirpath));
+
+    if (pack != packs.end()) {
+        packs.erase(pack);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../../graphics/texture.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+namespace Plteen {
+    struct __lambda__ TextureRegion {
+        shared_texture_t atlas;
+        SDL_Rect region;
+    };
+
+    /** NOTE
+     * Images of a folder packed into a few large textures,
+     *   regions are named by their paths relative to the folder, without extensions,
+     *   say, `walk_01` for `folder/walk_01.png`, and `hat/walk_01` for `folder/hat/walk_01.png`.
+     */
+    struct __lambda__ TexturePack {
+        std::vector<shared_texture_t> atlases;
+        std::map<std::string, TextureRegion> regions;
+    };
+
+    typedef std::shared_ptr<Plteen::TexturePack> shared_texture_pack_t;
+
+    /** NOTE
+     * Packing results are cached in `cache_rootdir` (or the per-user data directory by default),
+     *   and are reused until any file in the folder is modified, added, or removed.
+     */
+    __lambda__ void atlasdb_setup(const char* cache_rootdir);
+    __lambda__ void atlasdb_setup(const std::string& cache_rootdir);
+    __lambda__ void atlasdb_teardown();
+
+    __lambda__ shared_texture_pack_t atlasdb_ref(const char* dirpath, SDL_Renderer* renderer);
+    __lambda__ shared_texture_pack_t atlasdb_ref(const std::string& dirpath, SDL_Renderer* renderer);
+
+    /** NOTE
+     * The regions are available immediately, whereas the atlases are placeholders until uploaded,
+     *   see `imgdb_ref_async`.
+     */
+    __lambda__ shared_texture_pack_t atlasdb_ref_async(const char* dirpath, SDL_Renderer* renderer);
+    __lambda__ shared_texture_pack_t atlasdb_ref_async(const std::string& dirpath, SDL_Renderer* renderer);
+
+    __lambda__ void atlasdb_remove(const char* dirpath);
+    __lambda__ void atlasdb_remove(const std::string& dirpath);
+}
@@ -1,4 +1,5 @@
 #include "imgdb.hpp"
+#include "atlasdb.hpp"
 
 #include "../../graphics/image.hpp"
 
@@ -6,18 +7,72 @@
 #include "../../datum/path.hpp"
 #include "../../datum/box.hpp"
 
+#include <SDL2/SDL_image.h>
+
 #include <map>
+#include <list>
+#include <deque>
+#include <vector>
 #include <unordered_map>
 #include <filesystem>
+#include <condition_variable>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 using namespace Plteen;
 using namespace std::filesystem;
 
 /*************************************************************************************************/
+namespace Plteen {
+    typedef std::pair<const std::string*, SDL_Renderer*> ImageCacheKey;
+
+    struct ImageCacheEntry {
+        shared_texture_t texture;
+        size_t bytes = 0U;
+        bool pinned = false; // preloaded but not referenced yet
+        std::list<ImageCacheKey>::iterator lru;
+    };
+
+    struct ImageDecodingJob {
+        std::string abspath;
+        SDL_Renderer* renderer;
+        shared_texture_t texture;
+        SDL_Surface* image = nullptr;
+    };
+}
+
+static const size_t IMGDB_MAX_DECODERS = 4U;
+static const size_t IMGDB_DEFAULT_BUDGET = 256U * 1024U * 1024U;
+
 static shared_texture_t empty_costume = std::make_shared<Texture>(nullptr);
-static std::map<std::string, std::unordered_map<SDL_Renderer*, shared_texture_t>> costumes;
+static std::map<std::string, std::unordered_map<SDL_Renderer*, ImageCacheEntry>> costumes;
+static std::list<ImageCacheKey> costumes_lru; // least recently used first
 static std::string imgdb_rootdir;
 
+static size_t imgdb_budget = IMGDB_DEFAULT_BUDGET;
+static size_t resident_bytes = 0U;
+static uint64_t cache_hits = 0U;
+static uint64_t cache_misses = 0U;
+static uint64_t cache_preloads = 0U;
+static uint64_t cache_evictions = 0U;
+
+/* only accessed in the rendering thread */
+static std::unordered_map<Texture*, std::pair<std::string, SDL_Renderer*>> pending_textures;
+
+/* shared with decoders */
+static std::deque<ImageDecodingJob> decoding_jobs;
+static std::deque<ImageDecodingJob> decoded_jobs;
+static std::vector<std::thread> decoders;
+static std::condition_variable decoding_signal;
+static std::mutex decoding_mutex;
+static bool decoders_stopping = false;
+
+static inline bool is_image(const std::string& pathname) {
+    return string_suffix(pathname, ".png") || string_suffix(pathname, ".svg");
+}
+
 static inline std::string path_normalize(const std::string& str_path) {
     return path(str_path).is_absolute() ? str_path : imgdb_rootdir + str_path;
 }
@@ -26,6 +81,194 @@ static inline shared_texture_t imgdb_load(SDL_Renderer* renderer, const std::str
     return std::make_shared<Texture>(game_load_image(renderer, abspath));
 }
 
+/*************************************************************************************************/
+/** NOTE
+ * Textures are assumed to be 32-bit,
+ *   SDL does not tell the real memory usage, which depends on the driver anyway.
+ */
+static inline size_t texture_bytes(const shared_texture_t& texture) {
+    int width = 0;
+    int height = 0;
+
+    texture->feed_extent(&width, &height);
+
+    return size_t(width) * size_t(height) * 4U;
+}
+
+static ImageCacheEntry* imgdb_cache_find(const std::string& abspath, SDL_Renderer* renderer) {
+    ImageCacheEntry* entry = nullptr;
+    auto shared_costumes = costumes.find(abspath);
+
+    if (shared_costumes != costumes.end()) {
+        auto it = shared_costumes->second.find(renderer);
+
+        if (it != shared_costumes->second.end()) {
+            entry = &it->second;
+        }
+    }
+
+    return entry;
+}
+
+static void imgdb_cache_account(ImageCacheEntry* entry) {
+    size_t bytes = texture_bytes(entry->texture);
+
+    resident_bytes = resident_bytes - entry->bytes + bytes;
+    entry->bytes = bytes;
+}
+
+/** NOTE
+ * Only textures that are neither held by anyone else nor pinned by preloading are evicted,
+ *   the cache therefore might stay over budget if all of them are in use.
+ */
+static void imgdb_cache_evict() {
+    auto it = costumes_lru.begin();
+
+    while ((imgdb_budget > 0U) && (resident_bytes > imgdb_budget) && (it != costumes_lru.end())) {
+        auto shared_costumes = costumes.find(*it->first);
+        auto entry = shared_costumes->second.find(it->second);
+
+        if ((entry->second.texture.use_count() == 1) && !entry->second.pinned) {
+            resident_bytes -= entry->second.bytes;
+            cache_evictions ++;
+            it = costumes_lru.erase(it);
+            shared_costumes->second.erase(entry);
+
+            if (shared_costumes->second.empty()) {
+                costumes.erase(shared_costumes);
+            }
+        } else {
+            ++ it;
+        }
+    }
+}
+
+static void imgdb_cache_insert(const std::string& abspath, SDL_Renderer* renderer, const shared_texture_t& texture, bool preloaded = false) {
+    auto shared_costumes = costumes.find(abspath);
+
+    if (shared_costumes == costumes.end()) {
+        shared_costumes = costumes.insert({ abspath, {} }).first;
+    }
+
+    ImageCacheEntry* entry = &shared_costumes->second[renderer];
+
+    entry->texture = texture;
+    entry->pinned = preloaded;
+    entry->lru = costumes_lru.insert(costumes_lru.end(), { &shared_costumes->first, renderer });
+    imgdb_cache_account(entry);
+
+    if (preloaded) {
+        cache_preloads ++;
+    } else {
+        cache_misses ++;
+    }
+
+    imgdb_cache_evict();
+}
+
+static shared_texture_t imgdb_cache_ref(const std::string& abspath, SDL_Renderer* renderer, bool async) {
+    ImageCacheEntry* entry = imgdb_cache_find(abspath, renderer);
+    shared_texture_t texture = nullptr;
+
+    if (entry == nullptr) {
+        texture = async ? imgdb_load_async(abspath, renderer) : imgdb_load(renderer, abspath);
+        imgdb_cache_insert(abspath, renderer, texture);
+    } else {
+        texture = entry->texture;
+        entry->pinned = false;
+        costumes_lru.splice(costumes_lru.end(), costumes_lru, entry->lru);
+        cache_hits ++;
+
+        if (!async) {
+            imgdb_load_pending(texture); // no need to wait for the decoder
+        }
+    }
+
+    return texture;
+}
+
+static void imgdb_cache_update(const std::string& abspath, SDL_Renderer* renderer, const shared_texture_t& texture) {
+    ImageCacheEntry* entry = imgdb_cache_find(abspath, renderer);
+
+    if ((entry != nullptr) && (entry->texture == texture)) {
+        imgdb_cache_account(entry);
+        imgdb_cache_evict();
+    }
+}
+
+/*************************************************************************************************/
+static void imgdb_decode() {
+    std::unique_lock<std::mutex> lock(decoding_mutex);
+
+    while (!decoders_stopping) {
+        if (decoding_jobs.empty()) {
+            decoding_signal.wait(lock);
+        } else {
+            ImageDecodingJob job = decoding_jobs.front();
+
+            decoding_jobs.pop_front();
+            lock.unlock();
+            job.image = IMG_Load(job.abspath.c_str());
+            lock.lock();
+            decoded_jobs.push_back(job);
+        }
+    }
+}
+
+static void imgdb_free_jobs(std::deque<ImageDecodingJob>& jobs) {
+    for (auto& job : jobs) {
+        if (job.image != nullptr) {
+            SDL_FreeSurface(job.image);
+        }
+    }
+
+    jobs.clear();
+}
+
+static void imgdb_stop_decoders() {
+    {
+        std::unique_lock<std::mutex> lock(decoding_mutex);
+
+        decoders_stopping = true;
+    }
+
+    decoding_signal.notify_all();
+
+    for (auto& decoder : decoders) {
+        decoder.join();
+    }
+
+    decoders.clear();
+    decoders_stopping = false;
+    imgdb_free_jobs(decoding_jobs);
+    imgdb_free_jobs(decoded_jobs);
+}
+
+/** NOTE
+ * Decoders are started on demand, leaving one core for the rendering thread,
+ *   and are stopped before `IMG_Quit` is called at exit,
+ *   which works since `atexit` calls functions in the reverse order of their registration.
+ */
+static void imgdb_start_decoders() {
+    if (decoders.empty()) {
+        size_t n = std::thread::hardware_concurrency();
+
+        n = ((n > 1U) ? (n - 1U) : 1U);
+        n = ((n < IMGDB_MAX_DECODERS) ? n : IMGDB_MAX_DECODERS);
+
+        for (size_t idx = 0U; idx < n; idx ++) {
+            decoders.push_back(std::thread(imgdb_decode));
+        }
+
+        static bool registered = false;
+
+        if (!registered) {
+            atexit(imgdb_stop_decoders);
+            registered = true;
+        }
+    }
+}
+
 /*************************************************************************************************/
 void Plteen::imgdb_setup(const char* rootdir) {
     if (rootdir != nullptr) {
@@ -38,7 +281,15 @@ void Plteen::imgdb_setup(const std::string& rootdir) {
 }
 
 void Plteen::imgdb_teardown() {
+    imgdb_stop_decoders();
+    pending_textures.clear();
+    costumes_lru.clear();
     costumes.clear();
+    resident_bytes = 0U;
+    cache_hits = 0U;
+    cache_misses = 0U;
+    cache_preloads = 0U;
+    cache_evictions = 0U;
 }
 
 shared_texture_t Plteen::imgdb_ref(const char* pathname, SDL_Renderer* renderer) {
@@ -49,23 +300,209 @@ shared_texture_t Plteen::imgdb_ref(const std::string& pathname, SDL_Renderer* re
     std::string abspath = path_normalize(pathname);
     shared_texture_t texture = empty_costume;
 
-    if (string_suffix(abspath, ".png") || string_suffix(abspath, ".svg")) {
-        if (costumes.find(abspath) != costumes.end()) {
-            auto shared_costumes = costumes[abspath];
+    if (is_image(abspath)) {
+        texture = imgdb_cache_ref(abspath, renderer, false);
+    }
+
+    return texture;
+}
+
+shared_texture_t Plteen::imgdb_ref_async(const char* pathname, SDL_Renderer* renderer) {
+    return imgdb_ref_async(std::string(pathname), renderer);
+}
+
+shared_texture_t Plteen::imgdb_ref_async(const std::string& pathname, SDL_Renderer* renderer) {
+    std::string abspath = path_normalize(pathname);
+    shared_texture_t texture = empty_costume;
+
+    if (is_image(abspath)) {
+        texture = imgdb_cache_ref(abspath, renderer, true);
+    }
+
+    return texture;
+}
+
+shared_texture_t Plteen::imgdb_load_async(const std::string& abspath, SDL_Renderer* renderer) {
+    shared_texture_t texture = std::make_shared<Texture>(nullptr);
+
+    imgdb_start_decoders();
+    pending_textures[texture.get()] = { abspath, renderer };
+
+    {
+        std::unique_lock<std::mutex> lock(decoding_mutex);
+
+        decoding_jobs.push_back({ abspath, renderer, texture });
+    }
+
+    decoding_signal.notify_one();
+
+    return texture;
+}
+
+bool Plteen::imgdb_pending(const shared_texture_t& texture) {
+    return (texture != nullptr) && (pending_textures.find(texture.get()) != pending_textures.end());
+}
+
+void Plteen::imgdb_load_pending(const shared_texture_t& texture) {
+    if (texture != nullptr) {
+        auto pending = pending_textures.find(texture.get());
+
+        if (pending != pending_textures.end()) {
+            texture->reset(game_load_image(pending->second.second, pending->second.first));
+            imgdb_cache_update(pending->second.first, pending->second.second, texture);
+            pending_textures.erase(pending);
+        }
+    }
+}
+
+size_t Plteen::imgdb_pending_count() {
+    return pending_textures.size();
+}
+
+/** NOTE
+ * Images that fail to decode are left as empty textures,
+ *   and those that have been loaded synchronously in the meantime are simply dropped.
+ */
+size_t Plteen::imgdb_upload(size_t budget) {
+    std::deque<ImageDecodingJob> jobs;
+    size_t uploaded = 0U;
+
+    {
+        std::unique_lock<std::mutex> lock(decoding_mutex);
 
-            if (shared_costumes.find(renderer) == shared_costumes.end()) {
-                texture = imgdb_load(renderer, pathname);
-                shared_costumes[renderer] = texture;
-            } else {
-                texture = shared_costumes[renderer];
+        while (!decoded_jobs.empty() && (jobs.size() < budget)) {
+            jobs.push_back(decoded_jobs.front());
+            decoded_jobs.pop_front();
+        }
+    }
+
+    for (auto& job : jobs) {
+        if (pending_textures.erase(job.texture.get()) > 0U) {
+            if ((job.image != nullptr) && !job.texture->okay()) {
+                job.texture->reset(SDL_CreateTextureFromSurface(job.renderer, job.image));
+                imgdb_cache_update(job.abspath, job.renderer, job.texture);
+                uploaded ++;
             }
-        } else {
-            texture = imgdb_load(renderer, abspath);
-            costumes[abspath] = { { renderer, texture } };
         }
     }
 
-    return texture;
+    imgdb_free_jobs(jobs);
+
+    return uploaded;
+}
+
+/** NOTE
+ * Preloading blocks the calling thread until all images are uploaded,
+ *   images are decoded by all cores meanwhile, and are uploaded as soon as they are decoded.
+ *
+ * Directories are loaded by sprites as atlases, so they are handed to the atlasdb,
+ *   whose cached pages are decoded by the background decoders meanwhile,
+ *   and are uploaded at last, those not decoded yet are loaded synchronously.
+ */
+void Plteen::imgdb_preload(const std::vector<std::string>& pathnames, SDL_Renderer* renderer, const std::function<void(size_t, size_t)>& progress) {
+    std::vector<std::string> abspaths;
+    std::vector<SDL_Surface*> images;
+    std::vector<std::thread> workers;
+    std::vector<shared_texture_t> pages;
+    std::deque<size_t> decoded;
+    std::condition_variable signal;
+    std::mutex mutex;
+    std::atomic<size_t> next(0U);
+    size_t done = 0U;
+    size_t total = 0U;
+
+    for (auto& pathname : pathnames) {
+        std::string abspath = path_normalize(pathname);
+
+        if (is_directory(abspath)) {
+            shared_texture_pack_t pack = atlasdb_ref_async(abspath, renderer);
+
+            if (pack != nullptr) {
+                for (auto& atlas : pack->atlases) {
+                    if (imgdb_pending(atlas)) {
+                        pages.push_back(atlas);
+                    }
+                }
+            }
+        } else if (is_image(abspath)) {
+            abspaths.push_back(abspath);
+        }
+    }
+
+    std::sort(abspaths.begin(), abspaths.end());
+    abspaths.erase(std::unique(abspaths.begin(), abspaths.end()), abspaths.end());
+    abspaths.erase(std::remove_if(abspaths.begin(), abspaths.end(), [renderer](const std::string& abspath) {
+        return imgdb_cache_find(abspath, renderer) != nullptr; }), abspaths.end());
+    images.resize(abspaths.size(), nullptr);
+    total = abspaths.size() + pages.size();
+
+    if (!abspaths.empty()) {
+        size_t n = std::thread::hardware_concurrency();
+
+        n = ((n > 0U) ? n : 1U);
+        n = ((n < abspaths.size()) ? n : abspaths.size());
+
+        for (size_t idx = 0U; idx < n; idx ++) {
+            workers.push_back(std::thread([&]() {
+                for (size_t i = next ++; i < abspaths.size(); i = next ++) {
+                    images[i] = IMG_Load(abspaths[i].c_str());
+
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+
+                        decoded.push_back(i);
+                    }
+
+                    signal.notify_one();
+                }
+            }));
+        }
+    }
+
+    while (done < abspaths.size()) {
+        std::deque<size_t> batch;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            signal.wait(lock, [&decoded]() { return !decoded.empty(); });
+            batch.swap(decoded);
+        }
+
+        for (size_t idx : batch) {
+            SDL_Texture* texture = nullptr;
+
+            if (images[idx] != nullptr) {
+                texture = SDL_CreateTextureFromSurface(renderer, images[idx]);
+                SDL_FreeSurface(images[idx]);
+                images[idx] = nullptr;
+            }
+
+            imgdb_cache_insert(abspaths[idx], renderer, std::make_shared<Texture>(texture), true);
+        }
+
+        done += batch.size();
+
+        if (progress != nullptr) {
+            progress(done, total);
+        }
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (!pages.empty()) {
+        imgdb_upload(pending_textures.size());
+
+        for (auto& page : pages) {
+            imgdb_load_pending(page);
+        }
+
+        if (progress != nullptr) {
+            progress(total, total);
+        }
+    }
 }
 
 void Plteen::imgdb_remove(const char* pathname) {
@@ -77,10 +514,39 @@ void Plteen::imgdb_remove(const std::string& pathname) {
     auto costume = costumes.find(abspath);
 
     if (costume != costumes.end()) {
+        for (auto& entry : costume->second) {
+            resident_bytes -= entry.second.bytes;
+            costumes_lru.erase(entry.second.lru);
+        }
+
         costumes.erase(costume);
     }
 }
 
+void Plteen::imgdb_set_budget(size_t bytes) {
+    imgdb_budget = bytes;
+    imgdb_cache_evict();
+}
+
+ImageCacheStatistics Plteen::imgdb_get_statistics() {
+    ImageCacheStatistics stats;
+    size_t entries = 0U;
+
+    for (auto& shared_costumes : costumes) {
+        entries += shared_costumes.second.size();
+    }
+
+    stats.entries = entries;
+    stats.resident_bytes = resident_bytes;
+    stats.budget = imgdb_budget;
+    stats.hits = cache_hits;
+    stats.misses = cache_misses;
+    stats.preloads = cache_preloads;
+    stats.evictions = cache_evictions;
+
+    return stats;
+}
+
 std::string Plteen::imgdb_build_path(const std::string& subpath, const std::string& filename, const std::string& extension) {
     return directory_path(subpath) + filename + extension;
 }
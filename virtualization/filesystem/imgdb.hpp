@@ -3,8 +3,22 @@
 #include "../../graphics/texture.hpp"
 
 #include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
 
 namespace Plteen {
+    struct __lambda__ ImageCacheStatistics {
+        size_t entries;
+        size_t resident_bytes;
+        size_t budget;
+
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t preloads;
+        uint64_t evictions;
+    };
+
     __lambda__ void imgdb_setup(const char* rootdir);
     __lambda__ void imgdb_setup(const std::string& rootdir);
     __lambda__ void imgdb_teardown();
@@ -12,6 +26,41 @@ namespace Plteen {
     __lambda__ shared_texture_t imgdb_ref(const char* subpath, SDL_Renderer* rendener);
     __lambda__ shared_texture_t imgdb_ref(const std::string& subpath, SDL_Renderer* rendener);
 
+    /** NOTE
+     * Images are decoded into surfaces by background threads,
+     *   the returned textures are placeholders that are not `okay()` until they are uploaded by `imgdb_upload`,
+     *   which must be done in the rendering thread, say, once per frame with a small budget,
+     *   so that loading lots of images does not freeze the game.
+     *
+     * `imgdb_load_async` does not cache the texture, clients are supposed to manage it themselves;
+     * `imgdb_load_pending` loads a pending texture synchronously instead of waiting for the decoder.
+     */
+    __lambda__ shared_texture_t imgdb_ref_async(const char* subpath, SDL_Renderer* rendener);
+    __lambda__ shared_texture_t imgdb_ref_async(const std::string& subpath, SDL_Renderer* rendener);
+    __lambda__ shared_texture_t imgdb_load_async(const std::string& abspath, SDL_Renderer* rendener);
+    __lambda__ void imgdb_load_pending(const Plteen::shared_texture_t& texture);
+    __lambda__ bool imgdb_pending(const Plteen::shared_texture_t& texture);
+    __lambda__ size_t imgdb_pending_count();
+    __lambda__ size_t imgdb_upload(size_t budget = 8U);
+
+    /** NOTE
+     * Images are decoded in parallel, and are cached before returning,
+     *   directories are handed to the atlasdb instead, whose pages are uploaded before returning as well,
+     *   `progress` is told how many images and pages are done out of the total, after each batch of uploads.
+     *
+     * Preloaded images are pinned in the cache until they are referenced for the first time,
+     *   and preloads are not counted as misses.
+     */
+    __lambda__ void imgdb_preload(const std::vector<std::string>& subpaths, SDL_Renderer* renderer,
+                                  const std::function<void(size_t, size_t)>& progress = nullptr);
+
+    /** NOTE
+     * Cached textures are evicted in least-recently-used order once the resident bytes exceed the budget,
+     *   unless they are still held by clients, the budget `0` means unlimited.
+     */
+    __lambda__ void imgdb_set_budget(size_t bytes);
+    __lambda__ Plteen::ImageCacheStatistics imgdb_get_statistics();
+
     __lambda__ void imgdb_remove(const char* subpath);
     __lambda__ void imgdb_remove(const std::string& subpath);
 
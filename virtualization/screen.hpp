@@ -24,6 +24,7 @@ namespace Plteen {
         virtual void end_update_sequence() = 0;
         virtual bool should_update() = 0;
         virtual void notify_updated() = 0;
+        virtual void notify_updated(const Plteen::Box& region) = 0;
 
     public:
         virtual void log_message(Plteen::Log level, const std::string& message) = 0;
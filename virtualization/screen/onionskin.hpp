@@ -22,6 +22,7 @@ namespace Plteen {
         void end_update_sequence() override { this->_display->end_update_sequence(); }
         bool should_update() override { return this->_display->should_update(); }
         void notify_updated() override { this->_display->notify_updated(); }
+        void notify_updated(const Plteen::Box& region) override { this->_display->notify_updated(region); }
 
     public:
         void log_message(Plteen::Log level, const std::string& message) override { this->_display->log_message(level, message); }
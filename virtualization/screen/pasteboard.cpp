@@ -95,6 +95,18 @@ void Plteen::Pasteboard::notify_updated() {
 	}
 }
 
+void Plteen::Pasteboard::notify_updated(const Box& region) {
+	/** NOTE
+	 * The region is local to the embedded plane,
+	 *   damaging the whole host matter in its own plane is simple and always correct.
+	 */
+	IPlane* plane = this->matter->master();
+
+	if (plane != nullptr) {
+		plane->notify_updated(this->matter);
+	}
+}
+
 void Plteen::Pasteboard::log_message(Log level, const std::string& message) {
 	IDisplay* display = this->display();
 
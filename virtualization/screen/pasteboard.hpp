@@ -23,6 +23,7 @@ namespace Plteen {
         void end_update_sequence() override;
         bool should_update() override;
         void notify_updated() override;
+        void notify_updated(const Plteen::Box& region) override;
 
     public:
         void log_message(Plteen::Log level, const std::string& message) override;